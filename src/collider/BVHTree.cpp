@@ -3,11 +3,20 @@
 
 #include "BVHTree.h"
 #include "buildopts.h"
+#include "Serializer.h"
 #include <stdio.h>
 #include <float.h>
 
 const int MAX_SPLITPOS_RETRIES = 15;
 
+// nodes as they are saved, with pointers turned into array indices
+struct SavedNode {
+	double min[3], max[3], radius;
+	Sint32 numTris;
+	Sint32 objStart; // -1 if not leaf
+	Sint32 kids[2];
+};
+
 BVHTree::BVHTree(int numObjs, const objPtr_t *objPtrs, const Aabb *objAabbs)
 {
 	std::vector<int> activeObjIdxs(numObjs);
@@ -25,6 +34,86 @@ BVHTree::BVHTree(int numObjs, const objPtr_t *objPtrs, const Aabb *objAabbs)
 	BuildNode(m_root, objPtrs, objAabbs, activeObjIdxs);
 }
 
+BVHTree::BVHTree(Serializer::Reader &rd, objPtr_t maxObjPtr, objPtr_t stride)
+{
+	const Uint32 numNodes = rd.Int32();
+	ByteRange nodes = rd.Blob();
+	const Uint32 numObjs = rd.Int32();
+	ByteRange objs = rd.Blob();
+	if (numNodes == 0 || nodes.Size() != numNodes * sizeof(SavedNode) || objs.Size() != numObjs * sizeof(objPtr_t))
+		throw SavedGameCorruptException();
+
+	m_objPtrAlloc = new objPtr_t[numObjs];
+	m_objPtrAllocPos = m_objPtrAllocMax = numObjs;
+	memcpy(m_objPtrAlloc, objs.begin, objs.Size());
+
+	m_bvhNodes = new BVHNode[numNodes];
+	m_nodeAllocPos = m_nodeAllocMax = numNodes;
+	m_root = &m_bvhNodes[0];
+
+	bool valid = true;
+	// users read stride objects from each objPtr on
+	for (Uint32 i=0; i<numObjs; i++) {
+		const objPtr_t p = m_objPtrAlloc[i];
+		valid = valid && p >= 0 && p % stride == 0 && p < maxObjPtr - (stride - 1);
+	}
+
+	for (Uint32 i=0; i<numNodes && valid; i++) {
+		SavedNode sn;
+		memcpy(&sn, nodes.begin + i * sizeof(SavedNode), sizeof(SavedNode));
+		BVHNode &node = m_bvhNodes[i];
+		node.aabb.min = vector3d(sn.min[0], sn.min[1], sn.min[2]);
+		node.aabb.max = vector3d(sn.max[0], sn.max[1], sn.max[2]);
+		node.aabb.radius = sn.radius;
+		node.numTris = sn.numTris;
+		if (sn.objStart >= 0) {
+			valid = sn.numTris > 0 && Uint32(sn.objStart) < numObjs && Uint32(sn.numTris) <= numObjs - Uint32(sn.objStart);
+			node.triIndicesStart = &m_objPtrAlloc[sn.objStart];
+			node.kids[0] = node.kids[1] = 0;
+		} else {
+			// kids always come after their parent, so there are no cycles
+			valid = Uint32(sn.kids[0]) > i && Uint32(sn.kids[0]) < numNodes && Uint32(sn.kids[1]) > i && Uint32(sn.kids[1]) < numNodes;
+			node.triIndicesStart = 0;
+			node.kids[0] = &m_bvhNodes[sn.kids[0]];
+			node.kids[1] = &m_bvhNodes[sn.kids[1]];
+		}
+	}
+
+	if (!valid) {
+		delete [] m_objPtrAlloc;
+		delete [] m_bvhNodes;
+		throw SavedGameCorruptException();
+	}
+}
+
+void BVHTree::Save(Serializer::Writer &wr) const
+{
+	std::vector<SavedNode> nodes(m_nodeAllocPos);
+	for (size_t i=0; i<m_nodeAllocPos; i++) {
+		const BVHNode &node = m_bvhNodes[i];
+		SavedNode &sn = nodes[i];
+		for (int j=0; j<3; j++) {
+			sn.min[j] = node.aabb.min[j];
+			sn.max[j] = node.aabb.max[j];
+		}
+		sn.radius = node.aabb.radius;
+		sn.numTris = node.numTris;
+		if (node.IsLeaf()) {
+			sn.objStart = Sint32(node.triIndicesStart - m_objPtrAlloc);
+			sn.kids[0] = sn.kids[1] = -1;
+		} else {
+			sn.objStart = -1;
+			sn.kids[0] = Sint32(node.kids[0] - m_bvhNodes);
+			sn.kids[1] = Sint32(node.kids[1] - m_bvhNodes);
+		}
+	}
+
+	wr.Int32(nodes.size());
+	wr.Blob(&nodes[0], nodes.size() * sizeof(SavedNode));
+	wr.Int32(m_objPtrAllocPos);
+	wr.Blob(m_objPtrAlloc, m_objPtrAllocPos * sizeof(objPtr_t));
+}
+
 void BVHTree::MakeLeaf(BVHNode *node, const objPtr_t *objPtrs, std::vector<objPtr_t> &objs)
 {
 	const size_t numTris = objs.size();
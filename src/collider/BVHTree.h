@@ -10,6 +10,8 @@
 #include "Aabb.h"
 #include "utils.h"
 
+namespace Serializer { class Reader; class Writer; }
+
 struct BVHNode {
 	Aabb aabb;
 
@@ -33,11 +35,16 @@ class BVHTree {
 public:
 	typedef int objPtr_t;
 	BVHTree(int numObjs, const objPtr_t *objPtrs, const Aabb *objAabbs);
+	// a tree written by Save, used as it was built. Every objPtr must be a
+	// multiple of stride and the stride objects from it on must be below
+	// maxObjPtr, throws SavedGameCorruptException otherwise
+	BVHTree(Serializer::Reader &rd, objPtr_t maxObjPtr, objPtr_t stride);
 	~BVHTree() {
 		delete [] m_objPtrAlloc;
 		delete [] m_bvhNodes;
 	}
 	BVHNode *GetRoot() { return m_root; }
+	void Save(Serializer::Writer &wr) const;
 private:
 	void BuildNode(BVHNode *node,
 			const objPtr_t *objPtrs,
@@ -4,11 +4,68 @@
 #include "libs.h"
 #include "GeomTree.h"
 #include "BVHTree.h"
+#include "Serializer.h"
+#include <algorithm>
+#include <unordered_map>
 
 int GeomTree::stats_rayTriIntersections;
 
 const unsigned int IGNORE_FLAG = 0x8000;
 
+namespace {
+	// exact position bits. +0 and -0 compare equal, so both hash as +0
+	struct VertexKey {
+		Uint32 x, y, z;
+		bool operator==(const VertexKey &b) const { return x == b.x && y == b.y && z == b.z; }
+	};
+
+	struct VertexKeyHash {
+		size_t operator()(const VertexKey &k) const { return (k.x * 73856093u) ^ (k.y * 19349663u) ^ (k.z * 83492791u); }
+	};
+
+	struct EdgeRef {
+		EdgeRef(int vi1, int vi2, int flag) : key((Uint64(vi1) << 32) | Uint64(vi2)), triFlag(flag) {}
+		bool operator<(const EdgeRef &b) const { return key < b.key; }
+		Uint64 key; // vertex float offsets, lower one first
+		int triFlag;
+	};
+}
+
+static inline Uint32 FloatKey(float f)
+{
+	if (is_zero_exact(f)) f = 0.0f;
+	Uint32 bits;
+	memcpy(&bits, &f, sizeof(bits));
+	return bits;
+}
+
+// Points the indices of active tris at the first vertex with exactly the same
+// position. NaN positions equal nothing and are left alone
+static void WeldVertices(int numVerts, int numTris, const float *vertices, Uint16 *indices, const unsigned int *triflags)
+{
+	std::vector<Uint16> remap(numVerts);
+	std::unordered_map<VertexKey, Uint16, VertexKeyHash> firstAt;
+	firstAt.reserve(numVerts);
+	bool welded = false;
+	for (int i=0; i<numVerts; i++) {
+		const float *v = &vertices[3*i];
+		remap[i] = Uint16(i);
+		if (is_nan(v[0]) || is_nan(v[1]) || is_nan(v[2]))
+			continue;
+		const VertexKey key = { FloatKey(v[0]), FloatKey(v[1]), FloatKey(v[2]) };
+		std::pair<std::unordered_map<VertexKey, Uint16, VertexKeyHash>::iterator, bool> ins = firstAt.insert(std::make_pair(key, Uint16(i)));
+		if (!ins.second) {
+			remap[i] = ins.first->second;
+			welded = true;
+		}
+	}
+	if (!welded) return;
+
+	for (int k=0; k<numTris*3; k++) {
+		if (triflags[k/3] < IGNORE_FLAG) indices[k] = remap[indices[k]];
+	}
+}
+
 GeomTree::~GeomTree()
 {
 	delete[] m_vertices;
@@ -39,23 +96,15 @@ GeomTree::GeomTree(int numVerts, int numTris, float *vertices, Uint16 *indices,
 		activeTris.push_back(i*3);
 	}
 
-	std::map< std::pair<int,int>, int > edges;
-#define ADD_EDGE(_i1,_i2,_triflag) \
-	if ((_i1) < (_i2)) edges[std::pair<int,int>(_i1,_i2)] = _triflag; \
-	else if ((_i1) > (_i2)) edges[std::pair<int,int>(_i2,_i1)] = _triflag;
+	WeldVertices(numVerts, numTris, m_vertices, indices, triflags);
 
-	// eliminate duplicate vertices
-	for (int i=0; i<numVerts; i++) {
-		vector3d v = vector3d(&m_vertices[3*i]);
-		for (int j=i+1; j<numVerts; j++) {
-			vector3d v2 = vector3d(&m_vertices[3*j]);
-			if (v2.ExactlyEqual(v)) {
-				for (int k=0; k<numTris*3; k++) {
-					if ((indices[k] == j) && (triflags[k/3] < 0x8000)) indices[k] = i;
-				}
-			}
-		}
-	}
+	// every edge of every active tri, merged below. the flag of the last
+	// tri to add an edge is the one kept
+	std::vector<EdgeRef> edgeRefs;
+	edgeRefs.reserve(activeTris.size() * 3);
+#define ADD_EDGE(_i1,_i2,_triflag) \
+	if ((_i1) < (_i2)) edgeRefs.push_back(EdgeRef(_i1, _i2, _triflag)); \
+	else if ((_i1) > (_i2)) edgeRefs.push_back(EdgeRef(_i2, _i1, _triflag));
 
 	/* Get radius, m_aabb, and merge duplicate edges */
 	m_radius = 0;
@@ -100,26 +149,32 @@ GeomTree::GeomTree(int numVerts, int numTris, float *vertices, Uint16 *indices,
 	delete [] aabbs;
 	//Output("Tri tree of %d tris build in %dms\n", activeTris.size(), SDL_GetTicks() - t);
 
-	m_numEdges = edges.size();
+	// stable, so the last reference to an edge ends its run
+	std::stable_sort(edgeRefs.begin(), edgeRefs.end());
+	m_numEdges = 0;
+	for (size_t i = 0; i < edgeRefs.size(); i++) {
+		if (i + 1 == edgeRefs.size() || edgeRefs[i + 1].key != edgeRefs[i].key)
+			edgeRefs[m_numEdges++] = edgeRefs[i];
+	}
+
 	m_edges = new Edge[m_numEdges];
 	// to build Edge bvh tree with.
 	aabbs = new Aabb[m_numEdges];
 	int *edgeIdxs = new int[m_numEdges];
 
-	int pos = 0;
-	for (std::map< std::pair<int,int>, int >::iterator i = edges.begin();
-			i != edges.end(); ++i, pos++) {
+	for (int pos = 0; pos < m_numEdges; pos++) {
 		// precalc some jizz
-		const std::pair<int, int> &vtx = (*i).first;
-		const int triflag = (*i).second;
-		vector3d v1 = vector3d(&m_vertices[vtx.first]);
-		vector3d v2 = vector3d(&m_vertices[vtx.second]);
+		const int vi1 = int(edgeRefs[pos].key >> 32);
+		const int vi2 = int(edgeRefs[pos].key & 0xffffffff);
+		const int triflag = edgeRefs[pos].triFlag;
+		vector3d v1 = vector3d(&m_vertices[vi1]);
+		vector3d v2 = vector3d(&m_vertices[vi2]);
 		vector3d dir = (v2-v1);
 		double len = dir.Length();
 		dir *= 1.0/len;
 
-		m_edges[pos].v1i = vtx.first;
-		m_edges[pos].v2i = vtx.second;
+		m_edges[pos].v1i = vi1;
+		m_edges[pos].v2i = vi2;
 		m_edges[pos].triFlag = triflag;
 		m_edges[pos].len = float(len);
 		m_edges[pos].dir = vector3f(float(dir.x), float(dir.y), float(dir.z));
@@ -135,6 +190,90 @@ GeomTree::GeomTree(int numVerts, int numTris, float *vertices, Uint16 *indices,
 	//Output("Edge tree of %d edges build in %dms\n", m_numEdges, SDL_GetTicks() - t);
 }
 
+template <typename T>
+static void ReadArray(Serializer::Reader &rd, T *out, size_t count)
+{
+	const ByteRange data = rd.Blob();
+	if (data.Size() != count * sizeof(T))
+		throw SavedGameCorruptException();
+	if (count > 0)
+		memcpy(out, data.begin, data.Size());
+}
+
+GeomTree::GeomTree(Serializer::Reader &rd)
+: m_numVertices(rd.Int32())
+, m_triTree(0)
+, m_edgeTree(0)
+, m_edges(0)
+, m_indices(0)
+, m_triFlags(0)
+{
+	m_vertices = 0;
+	m_numTris = rd.Int32();
+	m_numEdges = rd.Int32();
+	if (m_numVertices <= 0 || m_numTris <= 0 || m_numEdges < 0)
+		throw SavedGameCorruptException();
+
+	// the destructor does not run if reading throws, so these are freed below
+	float *vertices = new float[m_numVertices*3];
+	Uint16 *indices = new Uint16[m_numTris*3];
+	unsigned int *triFlags = new unsigned int[m_numTris];
+	m_vertices = vertices;
+	m_indices = indices;
+	m_triFlags = triFlags;
+	m_edges = new Edge[m_numEdges];
+
+	try {
+		ReadArray(rd, vertices, m_numVertices*3);
+		ReadArray(rd, indices, m_numTris*3);
+		ReadArray(rd, triFlags, m_numTris);
+		ReadArray(rd, m_edges, m_numEdges);
+
+		for (int i=0; i<m_numTris*3; i++) {
+			if (indices[i] >= m_numVertices) throw SavedGameCorruptException();
+		}
+		for (int i=0; i<m_numEdges; i++) {
+			if (m_edges[i].v1i < 0 || m_edges[i].v2i < 0 || m_edges[i].v1i >= m_numVertices*3 || m_edges[i].v2i >= m_numVertices*3)
+				throw SavedGameCorruptException();
+		}
+
+		m_radius = rd.Double();
+		m_aabb.min = rd.Vector3d();
+		m_aabb.max = rd.Vector3d();
+		m_aabb.radius = rd.Double();
+
+		// tri objPtrs are offsets into m_indices, of the first of three
+		m_triTree = new BVHTree(rd, m_numTris*3, 3);
+		m_edgeTree = new BVHTree(rd, m_numEdges, 1);
+	} catch (...) {
+		delete[] m_vertices;
+		delete[] m_indices;
+		delete[] m_triFlags;
+		delete[] m_edges;
+		delete m_triTree;
+		throw;
+	}
+}
+
+void GeomTree::Save(Serializer::Writer &wr) const
+{
+	wr.Int32(m_numVertices);
+	wr.Int32(m_numTris);
+	wr.Int32(m_numEdges);
+	wr.Blob(m_vertices, m_numVertices*3 * sizeof(float));
+	wr.Blob(m_indices, m_numTris*3 * sizeof(Uint16));
+	wr.Blob(m_triFlags, m_numTris * sizeof(unsigned int));
+	wr.Blob(m_edges, m_numEdges * sizeof(Edge));
+
+	wr.Double(m_radius);
+	wr.Vector3d(m_aabb.min);
+	wr.Vector3d(m_aabb.max);
+	wr.Double(m_aabb.radius);
+
+	m_triTree->Save(wr);
+	m_edgeTree->Save(wr);
+}
+
 static bool SlabsRayAabbTest(const BVHNode *n, const vector3f &start, const vector3f &invDir, isect_t *isect)
 {
 	float
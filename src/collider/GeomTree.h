@@ -15,11 +15,16 @@ struct isect_t {
 
 class BVHTree;
 struct BVHNode;
+namespace Serializer { class Reader; class Writer; }
 
 class GeomTree {
 public:
 	GeomTree(int numVerts, int numTris, float *vertices, Uint16 *indices, unsigned int *triflags);
+	// a tree written by Save, with its edges and BVHs as they were built.
+	// Throws SavedGameCorruptException
+	GeomTree(Serializer::Reader &rd);
 	~GeomTree();
+	void Save(Serializer::Writer &wr) const;
 	const Aabb &GetAabb() const { return m_aabb; }
 	// dir should be unit length,
 	// isect.dist should be ray length
@@ -0,0 +1,345 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "RoutePlanner.h"
+#include <algorithm>
+#include <cfloat>
+
+// sector boundaries are found with float arithmetic, so look a little
+// further than the jump range to be sure no system is missed
+static const float SECTOR_MARGIN = 0.01f;
+
+// missing sectors Update() may generate itself rather than waiting a frame
+// for the background jobs to deliver them
+static const unsigned MAX_INLINE_SECTORS = 8;
+
+RoutePlanner::RoutePlanner(const SystemPath &from, const SystemPath &to, float jumpRange) :
+	m_from(from.SystemOnly()),
+	m_to(to.SystemOnly()),
+	m_jumpRange(jumpRange),
+	m_heuristicWeight(1.0f),
+	m_maxOpen(0),
+	m_maxSectors(0),
+	m_maxExpanded(0),
+	m_status(SEARCHING),
+	m_distance(0.0f),
+	m_numExpanded(0),
+	m_goal(0),
+	m_blocking(false),
+	m_inlineBudget(0),
+	m_corridorRequested(false)
+{
+	PROFILE_SCOPED()
+	m_sectorCache = Sector::cache.NewSlaveCache();
+
+	if (m_from.IsSameSystem(m_to)) {
+		m_route.push_back(m_from);
+		m_status = FOUND;
+		return;
+	}
+
+	RefCountedPtr<Sector> toSec = m_sectorCache->GetCached(m_to);
+	RefCountedPtr<Sector> fromSec = m_sectorCache->GetCached(m_from);
+	m_goal = AddNode(toSec.Get(), m_to.systemIndex);
+	Open(AddNode(fromSec.Get(), m_from.systemIndex), 0.0f, -1);
+}
+
+void RoutePlanner::SetMemoryBudget(size_t maxOpenSystems, size_t maxSectors)
+{
+	m_maxOpen = maxOpenSystems;
+	m_maxSectors = maxSectors;
+}
+
+RoutePlanner::Status RoutePlanner::Update(unsigned maxExpansions)
+{
+	m_blocking = false;
+	m_inlineBudget = MAX_INLINE_SECTORS;
+	if (!m_corridorRequested && m_status == SEARCHING) {
+		m_corridorRequested = true;
+		PrefetchCorridor();
+	}
+	return Search(maxExpansions);
+}
+
+RoutePlanner::Status RoutePlanner::Plan()
+{
+	m_blocking = true;
+	return Search(~0u);
+}
+
+Uint32 RoutePlanner::AddNode(const Sector *sec, Uint32 sysIdx)
+{
+	const Sector::System &sys = sec->m_systems[sysIdx];
+	Node n;
+	n.path = SystemPath(sys.sx, sys.sy, sys.sz, sysIdx);
+	n.p = sys.p;
+	n.g = FLT_MAX;
+	n.parent = -1;
+	n.state = NODE_NEW;
+	const Uint32 idx = m_nodes.size();
+	m_nodes.push_back(n);
+	m_nodeIndex.insert(std::make_pair(n.path, idx));
+	return idx;
+}
+
+void RoutePlanner::Open(Uint32 node, float g, Sint32 parent)
+{
+	Node &n = m_nodes[node];
+	n.g = g;
+	n.parent = parent;
+	n.state = NODE_OPEN;
+
+	OpenEntry e;
+	e.f = g + m_heuristicWeight * Heuristic(n);
+	e.g = g;
+	e.node = node;
+	m_open.push_back(e);
+	std::push_heap(m_open.begin(), m_open.end());
+
+	if (!m_blocking)
+		Prefetch(n);
+}
+
+float RoutePlanner::Heuristic(const Node &n) const
+{
+	const Node &goal = m_nodes[m_goal];
+	vector3f dv = n.p - goal.p;
+	dv += Sector::SIZE*vector3f(float(n.path.sectorX - goal.path.sectorX), float(n.path.sectorY - goal.path.sectorY), float(n.path.sectorZ - goal.path.sectorZ));
+	return dv.Length();
+}
+
+// same arithmetic as Sector::DistanceBetween, so that a jump the planner
+// considers in range is also in range for the hyperdrive
+float RoutePlanner::JumpDistance(const Node &a, const Sector::System &sys) const
+{
+	vector3f dv = a.p - sys.p;
+	dv += Sector::SIZE*vector3f(float(a.path.sectorX - sys.sx), float(a.path.sectorY - sys.sy), float(a.path.sectorZ - sys.sz));
+	return dv.Length();
+}
+
+// sectors with any point within range of the box lo..hi (absolute lightyears)
+void RoutePlanner::NearSectors(const vector3f &lo, const vector3f &hi, float range, std::vector<SystemPath> &out) const
+{
+	const float r = range + SECTOR_MARGIN;
+	const int x0 = int(floor((lo.x - r) / Sector::SIZE)), x1 = int(floor((hi.x + r) / Sector::SIZE));
+	const int y0 = int(floor((lo.y - r) / Sector::SIZE)), y1 = int(floor((hi.y + r) / Sector::SIZE));
+	const int z0 = int(floor((lo.z - r) / Sector::SIZE)), z1 = int(floor((hi.z + r) / Sector::SIZE));
+
+	out.clear();
+	for (int x = x0; x <= x1; x++) {
+		const float gx = std::max(0.0f, std::max(x*Sector::SIZE - hi.x, lo.x - (x+1)*Sector::SIZE));
+		for (int y = y0; y <= y1; y++) {
+			const float gy = std::max(0.0f, std::max(y*Sector::SIZE - hi.y, lo.y - (y+1)*Sector::SIZE));
+			for (int z = z0; z <= z1; z++) {
+				const float gz = std::max(0.0f, std::max(z*Sector::SIZE - hi.z, lo.z - (z+1)*Sector::SIZE));
+				// skip the corners of the box that are out of range
+				if (gx*gx + gy*gy + gz*gz > r*r)
+					continue;
+				out.push_back(SystemPath(x, y, z));
+			}
+		}
+	}
+}
+
+// Collects the sectors within jump range of n. Returns false if some of them
+// are still being generated (after asking for any not requested yet)
+bool RoutePlanner::GatherSectors(const Node &n, std::vector<RefCountedPtr<Sector> > &out)
+{
+	const vector3f pos = Sector::SIZE*vector3f(float(n.path.sectorX), float(n.path.sectorY), float(n.path.sectorZ)) + n.p;
+	NearSectors(pos, pos, m_jumpRange, m_nearScratch);
+
+	bool ready = true;
+	for (const SystemPath &secPath : m_nearScratch) {
+		RefCountedPtr<Sector> sec = m_sectorCache->GetIfCached(secPath);
+		if (!sec && (m_blocking || m_inlineBudget > 0)) {
+			sec = m_sectorCache->GetCached(secPath);
+			if (!m_blocking)
+				--m_inlineBudget;
+		}
+
+		std::pair<std::map<SystemPath, size_t>::iterator, bool> inserted = m_sectorLastUse.insert(std::make_pair(secPath, m_numExpanded));
+		inserted.first->second = m_numExpanded;
+		if (!sec) {
+			if (inserted.second)
+				m_wanted.push_back(secPath);
+			ready = false;
+			continue;
+		}
+		out.push_back(sec);
+	}
+	return ready;
+}
+
+// Asks for the sectors around a newly opened system's sector, so they are
+// likely to be ready by the time the system is expanded
+void RoutePlanner::Prefetch(const Node &n)
+{
+	const SystemPath secPath = n.path.SectorOnly();
+	if (!m_prefetched.insert(secPath).second)
+		return;
+
+	const vector3f lo = Sector::SIZE*vector3f(float(secPath.sectorX), float(secPath.sectorY), float(secPath.sectorZ));
+	NearSectors(lo, lo + vector3f(Sector::SIZE), m_jumpRange, m_nearScratch);
+	for (const SystemPath &p : m_nearScratch) {
+		if (m_sectorLastUse.insert(std::make_pair(p, m_numExpanded)).second)
+			m_wanted.push_back(p);
+	}
+}
+
+// Asks for the sectors along the straight line to the destination up front,
+// most routes stay close to it
+void RoutePlanner::PrefetchCorridor()
+{
+	PROFILE_SCOPED()
+	const Node &from = m_nodes[m_nodeIndex[m_from]];
+	const Node &to = m_nodes[m_goal];
+	const vector3f a = Sector::SIZE*vector3f(float(from.path.sectorX), float(from.path.sectorY), float(from.path.sectorZ)) + from.p;
+	const vector3f b = Sector::SIZE*vector3f(float(to.path.sectorX), float(to.path.sectorY), float(to.path.sectorZ)) + to.p;
+	const float length = (b - a).Length();
+	const int steps = std::max(1, int(ceil(length / Sector::SIZE)));
+	for (int i = 0; i <= steps; i++) {
+		const vector3f pos = a + (float(i) / float(steps)) * (b - a);
+		NearSectors(pos, pos, 2.0f*m_jumpRange, m_nearScratch);
+		for (const SystemPath &p : m_nearScratch) {
+			if (m_sectorLastUse.insert(std::make_pair(p, m_numExpanded)).second)
+				m_wanted.push_back(p);
+		}
+		// the far end would only be released again before it is reached
+		if (m_maxSectors && m_sectorLastUse.size() >= m_maxSectors / 2)
+			break;
+	}
+}
+
+void RoutePlanner::Expand(Uint32 node, const std::vector<RefCountedPtr<Sector> > &sectors)
+{
+	const Node cur = m_nodes[node]; // copied, m_nodes grows below
+
+	for (const RefCountedPtr<Sector> &sec : sectors) {
+		for (Uint32 i = 0; i < sec->m_systems.size(); i++) {
+			const Sector::System &sys = sec->m_systems[i];
+			if (sys.IsSameSystem(cur.path))
+				continue;
+			const float d = JumpDistance(cur, sys);
+			if (d > m_jumpRange)
+				continue;
+
+			std::map<SystemPath, Uint32>::const_iterator it = m_nodeIndex.find(SystemPath(sys.sx, sys.sy, sys.sz, i));
+			const Uint32 next = (it != m_nodeIndex.end()) ? it->second : AddNode(sec.Get(), i);
+			const Node &n = m_nodes[next];
+			const float g = cur.g + d;
+			if (n.state == NODE_CLOSED || g >= n.g)
+				continue;
+			Open(next, g, node);
+		}
+	}
+}
+
+RoutePlanner::Status RoutePlanner::Search(unsigned maxExpansions)
+{
+	PROFILE_SCOPED()
+	std::vector<RefCountedPtr<Sector> > sectors;
+	unsigned expanded = 0;
+	while (m_status == SEARCHING && expanded < maxExpansions) {
+		if (m_open.empty() || (m_maxExpanded && m_numExpanded >= m_maxExpanded)) {
+			m_status = NO_ROUTE;
+			break;
+		}
+
+		const OpenEntry top = m_open.front();
+		if (m_nodes[top.node].state != NODE_OPEN || top.g > m_nodes[top.node].g) {
+			// superseded by a shorter route to the same system
+			std::pop_heap(m_open.begin(), m_open.end());
+			m_open.pop_back();
+			continue;
+		}
+
+		if (top.node == m_goal) {
+			Finish(m_goal);
+			break;
+		}
+
+		// expanding in order keeps the route optimal, so when the best
+		// system's surroundings aren't there yet wait for them
+		sectors.clear();
+		if (!GatherSectors(m_nodes[top.node], sectors))
+			break;
+
+		std::pop_heap(m_open.begin(), m_open.end());
+		m_open.pop_back();
+		m_nodes[top.node].state = NODE_CLOSED;
+		Expand(top.node, sectors);
+		++m_numExpanded;
+		++expanded;
+	}
+
+	if (m_status == SEARCHING) {
+		if (!m_wanted.empty()) {
+			m_sectorCache->FillCache(m_wanted);
+			m_wanted.clear();
+		}
+		PruneOpen();
+		PruneSectors();
+	} else {
+		Release();
+	}
+
+	return m_status;
+}
+
+void RoutePlanner::Finish(Uint32 goal)
+{
+	m_distance = m_nodes[goal].g;
+	for (Sint32 n = goal; n >= 0; n = m_nodes[n].parent)
+		m_route.push_back(m_nodes[n].path);
+	std::reverse(m_route.begin(), m_route.end());
+	m_status = FOUND;
+}
+
+void RoutePlanner::PruneOpen()
+{
+	if (!m_maxOpen || m_open.size() <= m_maxOpen)
+		return;
+
+	PROFILE_SCOPED()
+	std::vector<OpenEntry>::iterator keep = m_open.begin() + m_maxOpen;
+	std::nth_element(m_open.begin(), keep, m_open.end(), [](const OpenEntry &a, const OpenEntry &b) { return a.f < b.f; });
+	for (std::vector<OpenEntry>::iterator it = keep; it != m_open.end(); ++it) {
+		Node &n = m_nodes[it->node];
+		// only the entry for the node's current route drops it
+		if (n.state == NODE_OPEN && it->g == n.g && it->node != m_goal)
+			n.state = NODE_DROPPED;
+	}
+	m_open.erase(keep, m_open.end());
+	std::make_heap(m_open.begin(), m_open.end());
+}
+
+void RoutePlanner::PruneSectors()
+{
+	if (!m_maxSectors || m_sectorLastUse.size() <= m_maxSectors)
+		return;
+
+	PROFILE_SCOPED()
+	std::vector<std::pair<size_t, SystemPath> > byAge;
+	byAge.reserve(m_sectorLastUse.size());
+	for (auto it = m_sectorLastUse.begin(); it != m_sectorLastUse.end(); ++it)
+		byAge.push_back(std::make_pair(it->second, it->first));
+	std::sort(byAge.begin(), byAge.end());
+
+	// release down to three quarters of the budget so this doesn't run every update
+	const size_t toRelease = m_sectorLastUse.size() - m_maxSectors * 3 / 4;
+	for (size_t i = 0; i < toRelease && byAge[i].first < m_numExpanded; i++) {
+		m_sectorCache->Erase(byAge[i].second);
+		m_sectorLastUse.erase(byAge[i].second);
+	}
+}
+
+void RoutePlanner::Release()
+{
+	m_nodes.clear();
+	m_nodeIndex.clear();
+	m_open.clear();
+	m_sectorLastUse.clear();
+	m_prefetched.clear();
+	m_wanted.clear();
+	m_sectorCache->ClearCache();
+}
@@ -0,0 +1,135 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _ROUTEPLANNER_H
+#define _ROUTEPLANNER_H
+
+#include "libs.h"
+#include "galaxy/Sector.h"
+#include "galaxy/SystemPath.h"
+#include <map>
+#include <set>
+#include <vector>
+
+// Finds the shortest chain of hyperspace jumps of at most jumpRange between
+// two systems. Only sector data (system positions) is used, no StarSystem is
+// ever generated.
+//
+// The search is A* over systems with the straight line distance to the
+// destination as heuristic. Sectors are pulled into a private slave cache as
+// the frontier reaches them: Update() requests missing sectors through
+// FillCache and returns while they are generated in the background, so it can
+// be called once per frame without stalling. The sectors along the straight
+// line to the destination are asked for on the first call, and a few missing
+// ones are generated inline per call. Plan() runs the search to the end,
+// generating every missing sector synchronously instead.
+//
+// For long routes SetMemoryBudget() bounds the open set and the number of
+// sectors held. Open systems with the worst estimates are dropped and sectors
+// that have not been used for a while are released, so the route found may
+// then be longer than the shortest one.
+class RoutePlanner {
+public:
+	enum Status {
+		SEARCHING,
+		FOUND,
+		NO_ROUTE
+	};
+
+	RoutePlanner(const SystemPath &from, const SystemPath &to, float jumpRange);
+
+	// 0 means unbounded
+	void SetMemoryBudget(size_t maxOpenSystems, size_t maxSectors);
+	// gives up with NO_ROUTE after expanding this many systems, 0 means never
+	void SetSearchLimit(size_t maxExpanded) { m_maxExpanded = maxExpanded; }
+	// weights above 1 trade route length for fewer systems searched
+	void SetHeuristicWeight(float weight) { m_heuristicWeight = weight; }
+
+	// Searches at most maxExpansions systems, or until a sector that is
+	// still being generated is needed
+	Status Update(unsigned maxExpansions = 2000);
+	Status Plan();
+
+	Status GetStatus() const { return m_status; }
+	const SystemPath &GetFrom() const { return m_from; }
+	const SystemPath &GetTo() const { return m_to; }
+	float GetJumpRange() const { return m_jumpRange; }
+
+	// systems from start to destination, both included
+	const std::vector<SystemPath> &GetRoute() const { return m_route; }
+	unsigned GetNumJumps() const { return m_route.empty() ? 0 : m_route.size() - 1; }
+	float GetDistance() const { return m_distance; }
+	size_t GetNumExpanded() const { return m_numExpanded; }
+
+private:
+	enum NodeState {
+		NODE_NEW,
+		NODE_OPEN,
+		NODE_CLOSED,
+		NODE_DROPPED
+	};
+
+	struct Node {
+		SystemPath path;
+		vector3f p;     // position within the sector
+		float g;        // route length from the start
+		Sint32 parent;
+		NodeState state;
+	};
+
+	struct OpenEntry {
+		float f;
+		float g;        // stale when it no longer matches the node
+		Uint32 node;
+		bool operator<(const OpenEntry &b) const { return f > b.f; } // heap top is the lowest f
+	};
+
+	Uint32 AddNode(const Sector *sec, Uint32 sysIdx);
+	void Open(Uint32 node, float g, Sint32 parent);
+	float Heuristic(const Node &n) const;
+	float JumpDistance(const Node &a, const Sector::System &sys) const;
+
+	void NearSectors(const vector3f &lo, const vector3f &hi, float range, std::vector<SystemPath> &out) const;
+	bool GatherSectors(const Node &n, std::vector<RefCountedPtr<Sector> > &out);
+	void Prefetch(const Node &n);
+	void PrefetchCorridor();
+	void Expand(Uint32 node, const std::vector<RefCountedPtr<Sector> > &sectors);
+	void Finish(Uint32 goal);
+
+	void PruneOpen();
+	void PruneSectors();
+	void Release();
+
+	Status Search(unsigned maxExpansions);
+
+	SystemPath m_from;
+	SystemPath m_to;
+	float m_jumpRange;
+	float m_heuristicWeight;
+	size_t m_maxOpen;
+	size_t m_maxSectors;
+	size_t m_maxExpanded;
+
+	Status m_status;
+	std::vector<SystemPath> m_route;
+	float m_distance;
+	size_t m_numExpanded;
+
+	std::vector<Node> m_nodes;
+	std::map<SystemPath, Uint32> m_nodeIndex;
+	std::vector<OpenEntry> m_open;
+	Uint32 m_goal;
+
+	RefCountedPtr<SectorCache::Slave> m_sectorCache;
+	bool m_blocking;
+	unsigned m_inlineBudget;
+	bool m_corridorRequested;
+	// every sector held or still being generated, with the expansion count
+	// it was last needed at so the oldest can be released
+	std::map<SystemPath, size_t> m_sectorLastUse;
+	std::set<SystemPath> m_prefetched;            // sectors whose surroundings were asked for
+	SectorCache::PathVector m_wanted;             // batched up for the next FillCache
+	std::vector<SystemPath> m_nearScratch;
+};
+
+#endif
@@ -346,10 +346,11 @@ void Sector::AssignFactions()
 
 	assert(!m_factionsAssigned);
 
-	Uint32 index = 0;
-	for (std::vector<Sector::System>::iterator system = m_systems.begin(); system != m_systems.end(); ++system, ++index ) {
-		(*system).faction = Faction::GetNearestFaction(RefCountedPtr<const Sector>(this), index);
-	}
+	std::vector<Faction*> factions;
+	Faction::GetNearestFactions(RefCountedPtr<const Sector>(this), factions);
+	assert(factions.size() == m_systems.size());
+	for (Uint32 index = 0; index < m_systems.size(); ++index)
+		m_systems[index].faction = factions[index];
 	m_factionsAssigned = true;
 }
 
@@ -1,6 +1,7 @@
 // Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 
+#include <algorithm>
 #include <utility>
 #include "libs.h"
 #include "Factions.h"
@@ -14,11 +15,18 @@
 
 void SectorCache::AddToCache(std::vector<RefCountedPtr<Sector> >& sec)
 {
+	PROFILE_SCOPED()
+	// batches arrive sorted by path, so each insert goes right after the last
+	SectorAtticMap::iterator hint = m_sectorAttic.end();
 	for (auto it = sec.begin(), itEnd = sec.end(); it != itEnd; ++it) {
-		auto inserted = m_sectorAttic.insert( std::make_pair(it->Get()->GetSystemPath(), it->Get()) );
-		if (!inserted.second) {
-			it->Reset(inserted.first->second);
+		const size_t size = m_sectorAttic.size();
+		hint = m_sectorAttic.insert(hint, std::make_pair(it->Get()->GetSystemPath(), it->Get()));
+		if (m_sectorAttic.size() == size) {
+			it->Reset(hint->second);
+		} else {
+			m_nameIndex.AddSector(it->Get());
 		}
+		++hint;
 	}
 }
 
@@ -45,6 +53,7 @@ RefCountedPtr<Sector> SectorCache::GetCached(const SystemPath& loc)
 	if (!s) {
 		s.Reset(new Sector(secPath));
 		m_sectorAttic.insert( std::make_pair(secPath, s.Get()));
+		m_nameIndex.AddSector(s.Get());
 		if (Faction::MayAssignFactions())
 			s->AssignFactions();
 		else
@@ -91,7 +100,7 @@ RefCountedPtr<SectorCache::Slave> SectorCache::NewSlaveCache()
 	return RefCountedPtr<Slave>(new Slave);
 }
 
-SectorCache::Slave::Slave() : m_jobs(Pi::Jobs())
+SectorCache::Slave::Slave() : m_jobs(Pi::Jobs()), m_nextBatch(0), m_nextMerge(0)
 {
 	Sector::cache.m_slaves.insert(this);
 }
@@ -143,24 +152,49 @@ SectorCache::Slave::~Slave()
 
 void SectorCache::Slave::AddToCache(const std::vector<RefCountedPtr<Sector> >& secIn)
 {
+	SectorCacheMap::iterator hint = m_sectorCache.end();
 	for (auto it = secIn.begin(), itEnd = secIn.end(); it != itEnd; ++it) {
-		m_sectorCache.insert( std::make_pair(it->Get()->GetSystemPath(), *it) );
+		hint = m_sectorCache.insert(hint, std::make_pair(it->Get()->GetSystemPath(), *it));
+		++hint;
 	}
 }
 
+// Collects the results of a job, and merges every batch that is next in line
+// in one go. Jobs are only cancelled when the slave goes away, so a missing
+// batch always turns up eventually
+void SectorCache::Slave::FinishBatch(Uint32 batch, std::vector<RefCountedPtr<Sector> >& secIn)
+{
+	PROFILE_SCOPED()
+	m_finishedBatches[batch].swap(secIn);
+
+	std::vector<RefCountedPtr<Sector> > merged;
+	auto it = m_finishedBatches.begin();
+	while (it != m_finishedBatches.end() && it->first == m_nextMerge) {
+		if (merged.empty())
+			merged.swap(it->second);
+		else
+			merged.insert(merged.end(), it->second.begin(), it->second.end());
+		it = m_finishedBatches.erase(it);
+		++m_nextMerge;
+	}
+
+	if (merged.empty())
+		return;
+
+	Sector::cache.AddToCache(merged); // This modifies the vector to the sectors already in the master cache
+	AddToCache(merged);
+}
+
 void SectorCache::Slave::FillCache(const SectorCache::PathVector& paths)
 {
-	// allocate some space for what we're about to chunk up
-	std::vector<std::unique_ptr<PathVector> > vec_paths;
-	vec_paths.reserve(paths.size()/CACHE_JOB_SIZE + 1);
-	std::unique_ptr<PathVector> current_paths;
+	PROFILE_SCOPED()
+	PathVector toCreate;
+	toCreate.reserve(paths.size());
 #	ifdef DEBUG_SECTOR_CACHE
 		size_t alreadyCached = m_sectorCache.size();
 		unsigned masterCached = 0;
-		unsigned toBeCreated = 0;
 #	endif
 
-	// chop the paths into groups of CACHE_JOB_SIZE
 	for (auto it = paths.begin(), itEnd = paths.end(); it != itEnd; ++it) {
 		RefCountedPtr<Sector> s = Sector::cache.GetIfCached(*it);
 		if (s) {
@@ -169,37 +203,35 @@ void SectorCache::Slave::FillCache(const SectorCache::PathVector& paths)
 				++masterCached;
 #			endif
 		} else {
-			if (!current_paths) {
-				current_paths.reset(new PathVector);
-				current_paths->reserve(CACHE_JOB_SIZE);
-			}
-			current_paths->push_back(*it);
-			if( current_paths->size() >= CACHE_JOB_SIZE ) {
-				vec_paths.push_back( std::move(current_paths) );
-			}
-#			ifdef DEBUG_SECTOR_CACHE
-				++toBeCreated;
-#			endif
+			toCreate.push_back(*it);
 		}
 	}
 
-	// catch the last loop in case it's got some entries (could be less than the spread width)
-	if (current_paths) {
-		vec_paths.push_back( std::move(current_paths) );
-	}
+	// sorted, so which sectors go into which job, and the order they are
+	// merged in, only depends on the paths asked for
+	std::sort(toCreate.begin(), toCreate.end());
+	toCreate.erase(std::unique(toCreate.begin(), toCreate.end()), toCreate.end());
+
+	// enough jobs to keep every worker busy, but not so small that the job
+	// overhead dominates
+	const size_t numJobs = std::max(Pi::Jobs()->GetNumRunners(), 1U) * CACHE_JOBS_PER_RUNNER;
+	const size_t jobSize = Clamp<size_t>((toCreate.size() + numJobs - 1) / numJobs, CACHE_JOB_SIZE_MIN, CACHE_JOB_SIZE_MAX);
 
 #	ifdef DEBUG_SECTOR_CACHE
-		Output("SectorCache: FillCache: %zu cached, %u in master cache, %u to be created, will use %zu jobs\n",  alreadyCached, masterCached, toBeCreated, vec_paths.size());
+		Output("SectorCache: FillCache: %zu cached, %u in master cache, %zu to be created, will use %zu jobs\n",
+			alreadyCached, masterCached, toCreate.size(), (toCreate.size() + jobSize - 1) / jobSize);
 #	endif
 
-	// now add the batched jobs
-	for (auto it = vec_paths.begin(), itEnd = vec_paths.end(); it != itEnd; ++it)
-		m_jobs.Order(new SectorCacheJob(std::move(*it), this));
+	for (size_t i = 0; i < toCreate.size(); i += jobSize) {
+		const size_t end = std::min(i + jobSize, toCreate.size());
+		std::unique_ptr<PathVector> jobPaths(new PathVector(toCreate.begin() + i, toCreate.begin() + end));
+		m_jobs.Order(new SectorCacheJob(std::move(jobPaths), this, m_nextBatch++));
+	}
 }
 
 
-SectorCache::SectorCacheJob::SectorCacheJob(std::unique_ptr<std::vector<SystemPath> > path, SectorCache::Slave* slaveCache)
-	: Job(), m_paths(std::move(path)), m_slaveCache(slaveCache)
+SectorCache::SectorCacheJob::SectorCacheJob(std::unique_ptr<std::vector<SystemPath> > path, SectorCache::Slave* slaveCache, Uint32 batch)
+	: Job(), m_paths(std::move(path)), m_slaveCache(slaveCache), m_batch(batch)
 {
 	m_sectors.reserve(m_paths->size());
 	assert(Faction::MayAssignFactions());
@@ -218,6 +250,5 @@ void SectorCache::SectorCacheJob::OnRun()    // RUNS IN ANOTHER THREAD!! MUST BE
 //virtual
 void SectorCache::SectorCacheJob::OnFinish()  // runs in primary thread of the context
 {
-	Sector::cache.AddToCache(m_sectors); // This modifies the vector to the sectors already in the master cache
-	m_slaveCache->AddToCache(m_sectors);
+	m_slaveCache->FinishBatch(m_batch, m_sectors);
 }
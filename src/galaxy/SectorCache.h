@@ -10,6 +10,7 @@
 #include <vector>
 #include "libs.h"
 #include "galaxy/SystemPath.h"
+#include "galaxy/SystemNameIndex.h"
 #include "graphics/Drawables.h"
 #include "JobQueue.h"
 #include "RefCounted.h"
@@ -25,6 +26,8 @@ public:
 	void ClearCache(); 	// Completely clear slave caches
 	void AssignFactions(); // Assign factions to the cached sectors that do not have one, yet
 	bool IsEmpty() { return m_sectorAttic.empty(); }
+	// names of the systems in every sector generated so far
+	const SystemNameIndex &GetNameIndex() const { return m_nameIndex; }
 
 	typedef std::vector<SystemPath> PathVector;
 	typedef std::map<SystemPath,RefCountedPtr<Sector> > SectorCacheMap;
@@ -49,14 +52,25 @@ public:
 		SectorCacheMap m_sectorCache;
 		JobSet m_jobs;
 
+		// FillCache jobs are numbered as they are made, and their results
+		// merged in that order, so the caches don't depend on thread timing
+		Uint32 m_nextBatch;
+		Uint32 m_nextMerge;
+		std::map<Uint32, std::vector<RefCountedPtr<Sector> > > m_finishedBatches;
+
 		Slave();
 		void AddToCache(const std::vector<RefCountedPtr<Sector> >& secIn);
+		void FinishBatch(Uint32 batch, std::vector<RefCountedPtr<Sector> >& secIn);
 	};
 
 	RefCountedPtr<Slave> NewSlaveCache();
 
 private:
-	static const unsigned CACHE_JOB_SIZE = 100;
+	// FillCache splits the sectors to generate into CACHE_JOBS_PER_RUNNER jobs
+	// per worker, so a slow job doesn't leave the other workers idle
+	static const unsigned CACHE_JOBS_PER_RUNNER = 2;
+	static const unsigned CACHE_JOB_SIZE_MIN = 25;   // below this the job overhead dominates
+	static const unsigned CACHE_JOB_SIZE_MAX = 1000; // keeps a single merge on the main thread short
 
 	void AddToCache(std::vector<RefCountedPtr<Sector> >& sec);
 	bool HasCached(const SystemPath& loc) const;
@@ -68,7 +82,7 @@ private:
 	class SectorCacheJob : public Job
 	{
 	public:
-		SectorCacheJob(std::unique_ptr<std::vector<SystemPath> > path, Slave* slaveCache);
+		SectorCacheJob(std::unique_ptr<std::vector<SystemPath> > path, Slave* slaveCache, Uint32 batch);
 
 		virtual void OnRun();    // RUNS IN ANOTHER THREAD!! MUST BE THREAD SAFE!
 		virtual void OnFinish();  // runs in primary thread of the context
@@ -78,6 +92,7 @@ private:
 		std::unique_ptr<std::vector<SystemPath> > m_paths;
 		std::vector<RefCountedPtr<Sector> > m_sectors;
 		Slave* m_slaveCache;
+		Uint32 m_batch;
 	};
 
 	std::set<Slave*> m_slaves;
@@ -85,6 +100,7 @@ private:
 									// or elsewhere. The Sector destructor ensures that it is removed from here.
 									// This ensures, that there is only ever one object for each Sector.
 	std::set<Sector*> m_unassignedFactionsSet;
+	SystemNameIndex m_nameIndex;
 };
 
 #endif
@@ -521,10 +521,9 @@ SystemBody::BodySuperType SystemBody::GetSuperType() const
 	}
 }
 
-std::string SystemBody::GetAstroDescription() const
+const char *SystemBody::GetStarDescription(BodyType type)
 {
-	PROFILE_SCOPED()
-	switch (m_type) {
+	switch (type) {
 	case TYPE_BROWN_DWARF: return Lang::BROWN_DWARF;
 	case TYPE_WHITE_DWARF: return Lang::WHITE_DWARF;
 	case TYPE_STAR_M: return Lang::STAR_M;
@@ -561,6 +560,19 @@ std::string SystemBody::GetAstroDescription() const
 	case TYPE_STAR_S_BH: return Lang::STAR_S_BH;
 	case TYPE_STAR_IM_BH: return Lang::STAR_IM_BH;
 	case TYPE_STAR_SM_BH: return Lang::STAR_SM_BH;
+	default:
+		Output("Warning: Invalid Astro Body Description found.\n");
+		return Lang::UNKNOWN;
+	}
+}
+
+std::string SystemBody::GetAstroDescription() const
+{
+	PROFILE_SCOPED()
+	if (GetSuperType() == SUPERTYPE_STAR)
+		return GetStarDescription(m_type);
+
+	switch (m_type) {
 	case TYPE_PLANET_GAS_GIANT:
 		if (m_mass > 800) return Lang::VERY_LARGE_GAS_GIANT;
 		if (m_mass > 300) return Lang::LARGE_GAS_GIANT;
@@ -891,6 +903,7 @@ SystemBody *StarSystem::GetBodyByPath(const SystemPath &path) const
 	PROFILE_SCOPED()
 	assert(m_path.IsSameSystem(path));
 	assert(path.IsBodyPath());
+	GenerateBodies();
 	assert(path.bodyIndex < m_bodies.size());
 
 	return m_bodies[path.bodyIndex].Get();
@@ -1403,36 +1416,65 @@ SystemBody::AtmosphereParameters SystemBody::CalcAtmosphereParams() const
  *
  * We must be sneaky and avoid floating point in these places.
  */
-StarSystem::StarSystem(const SystemPath &path) : m_path(path)
+StarSystem::StarSystem(const SystemPath &path) : m_path(path), m_bodiesGenerated(false)
 {
 	PROFILE_SCOPED()
 	assert(path.IsSystemPath());
 	memset(m_tradeLevel, 0, sizeof(m_tradeLevel));
 
+	// Only the summary is filled in here, all of which the sector already
+	// knows. The bodies are generated by MakeBodies() on first use.
 	RefCountedPtr<const Sector> s = Sector::cache.GetCached(m_path);
 	assert(m_path.systemIndex >= 0 && m_path.systemIndex < s->m_systems.size());
+	const Sector::System &secSys = s->m_systems[m_path.systemIndex];
 
-	m_seed    = s->m_systems[m_path.systemIndex].seed;
-	m_name    = s->m_systems[m_path.systemIndex].name;
+	m_seed    = secSys.seed;
+	m_name    = secSys.name;
 	m_faction = Faction::GetNearestFaction(s, m_path.systemIndex);
 
-	Uint32 _init[6] = { m_path.systemIndex, Uint32(m_path.sectorX), Uint32(m_path.sectorY), Uint32(m_path.sectorZ), UNIVERSE_SEED, Uint32(m_seed) };
-	Random rand(_init, 6);
+	m_unexplored = !secSys.explored;
 
-	m_unexplored = !s->m_systems[m_path.systemIndex].explored;
+	m_numStars = secSys.numStars;
+	for (int i=0; i<4; i++)
+		m_starTypes[i] = (i < m_numStars) ? secSys.starType[i] : SystemBody::TYPE_GRAVPOINT;
 
 	m_isCustom = m_hasCustomBodies = false;
-	if (s->m_systems[m_path.systemIndex].customSys) {
+	if (secSys.customSys) {
 		m_isCustom = true;
-		const CustomSystem *custom = s->m_systems[m_path.systemIndex].customSys;
+		const CustomSystem *custom = secSys.customSys;
 		m_numStars = custom->numStars;
 		if (custom->shortDesc.length() > 0) m_shortDesc = custom->shortDesc;
 		if (custom->longDesc.length() > 0) m_longDesc = custom->longDesc;
-		if (!custom->IsRandom()) {
-			m_hasCustomBodies = true;
-			GenerateFromCustom(s->m_systems[m_path.systemIndex].customSys, rand);
-			return;
-		}
+		m_hasCustomBodies = !custom->IsRandom();
+	}
+}
+
+std::string StarSystem::GetStarDescription() const
+{
+	if (m_numStars == 4) return Lang::QUADRUPLE_SYSTEM;
+	if (m_numStars == 3) return Lang::TRIPLE_SYSTEM;
+	if (m_numStars == 2) return Lang::BINARY_SYSTEM;
+	return SystemBody::GetStarDescription(m_starTypes[0]);
+}
+
+void StarSystem::MakeBodies()
+{
+	PROFILE_SCOPED()
+	assert(!m_bodiesGenerated);
+	// set before generating, Populate() and friends call back into our accessors
+	m_bodiesGenerated = true;
+
+	RefCountedPtr<const Sector> s = Sector::cache.GetCached(m_path);
+
+	Uint32 _init[6] = { m_path.systemIndex, Uint32(m_path.sectorX), Uint32(m_path.sectorY), Uint32(m_path.sectorZ), UNIVERSE_SEED, Uint32(m_seed) };
+	Random rand(_init, 6);
+
+	if (m_hasCustomBodies) {
+		GenerateFromCustom(s->m_systems[m_path.systemIndex].customSys, rand);
+#ifdef DEBUG_DUMP
+		Dump();
+#endif /* DEBUG_DUMP */
+		return;
 	}
 
 	SystemBody *star[4];
@@ -2230,8 +2272,8 @@ void SystemBody::PopulateStage1(StarSystem *system, fixed &outTotalPop)
 static bool check_unique_station_name(const std::string & name, const StarSystem * system) {
 	PROFILE_SCOPED()
 	bool ret = true;
-	for (unsigned int i = 0 ; i < system->m_spaceStations.size() ; ++i)
-		if (system->m_spaceStations[i]->GetName() == name) {
+	for (const SystemBody *station : system->GetSpaceStations())
+		if (station->GetName() == name) {
 			ret = false;
 			break;
 		}
@@ -2358,7 +2400,8 @@ StarSystem::~StarSystem()
 	PROFILE_SCOPED()
 	// clear parent and children pointers. someone (Lua) might still have a
 	// reference to things that are about to be deleted
-	m_rootBody->ClearParentAndChildPointers();
+	if (m_rootBody)
+		m_rootBody->ClearParentAndChildPointers();
 }
 
 void StarSystem::Serialize(Serializer::Writer &wr, StarSystem *s)
@@ -2514,6 +2557,8 @@ void StarSystem::ExportToLua(const char *filename) {
 	if(f == 0)
 		return;
 
+	GenerateBodies();
+
 	fprintf(f,"-- Copyright © 2008-2012 Pioneer Developers. See AUTHORS.txt for details\n");
 	fprintf(f,"-- Licensed under the terms of the GPL v3. See licenses/GPL-3.txt\n\n");
 
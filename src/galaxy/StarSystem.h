@@ -115,6 +115,7 @@ public:
 
 	std::string GetName() const { return m_name; }
 	std::string GetAstroDescription() const;
+	static const char *GetStarDescription(BodyType type);
 	const char *GetIcon() const;
 	BodyType GetType() const { return m_type; }
 	BodySuperType GetSuperType() const;
@@ -277,10 +278,30 @@ public:
 	static RefCountedPtr<StarSystem> Unserialize(Serializer::Reader &rd);
 	void Dump();
 	const SystemPath &GetPath() const { return m_path; }
-	const char *GetShortDescription() const { return m_shortDesc.c_str(); }
-	const char *GetLongDescription() const { return m_longDesc.c_str(); }
+	const char *GetShortDescription() const { GenerateBodies(); return m_shortDesc.c_str(); }
+	const char *GetLongDescription() const { GenerateBodies(); return m_longDesc.c_str(); }
+	const SysPolit &GetSysPolit() const { GenerateBodies(); return m_polit; }
+
+	// Summary data. Comes straight from the sector, so none of these
+	// require the body hierarchy to be generated.
 	int GetNumStars() const { return m_numStars; }
-	const SysPolit &GetSysPolit() const { return m_polit; }
+	SystemBody::BodyType GetStarType(int i) const { assert(i >= 0 && i < m_numStars); return m_starTypes[i]; }
+	std::string GetStarDescription() const; // "binary system", or the astro description of the single star
+	Faction* GetFaction() const  { return m_faction; }
+	bool GetUnexplored() const { return m_unexplored; }
+	int GetSeed() const { return m_seed; }
+	bool IsCustom() const { return m_isCustom; }
+
+	// The bodies are generated the first time any of these are called
+	bool HasGeneratedBodies() const { return m_bodiesGenerated; }
+	SystemBody *GetRootBody() const { GenerateBodies(); return m_rootBody.Get(); }
+	bool HasSpaceStations() const { GenerateBodies(); return !m_spaceStations.empty(); }
+	unsigned GetNumSpaceStations() const { GenerateBodies(); return m_spaceStations.size(); }
+	const IterationProxy<const std::vector<SystemBody*> > GetSpaceStations() const { GenerateBodies(); return MakeIterationProxy(m_spaceStations); }
+	const IterationProxy<const std::vector<SystemBody*> > GetStars() const { GenerateBodies(); return MakeIterationProxy(m_stars); }
+	unsigned GetNumBodies() const { GenerateBodies(); return m_bodies.size(); }
+	// index into this will be the SystemBody ID used by SystemPath
+	const IterationProxy<const std::vector< RefCountedPtr<SystemBody> > > GetBodies() const { GenerateBodies(); return MakeIterationProxy(m_bodies); }
 
 	static Uint8 starColors[][3];
 	static Uint8 starRealColors[][3];
@@ -288,31 +309,30 @@ public:
 	static float starScale[];
 	static fixed starMetallicities[];
 
-	RefCountedPtr<SystemBody> m_rootBody;
-	std::vector<SystemBody*> m_spaceStations;
-	std::vector<SystemBody*> m_stars;
-	// index into this will be the SystemBody ID used by SystemPath
-	std::vector< RefCountedPtr<SystemBody> > m_bodies;
-
 	int GetCommodityBasePriceModPercent(int t) {
+		GenerateBodies();
 		return m_tradeLevel[t];
 	}
 
-	Faction* GetFaction() const  { return m_faction; }
-	bool GetUnexplored() const { return m_unexplored; }
-	fixed GetMetallicity() const { return m_metallicity; }
-	fixed GetIndustrial() const { return m_industrial; }
-	int GetEconType() const { return m_econType; }
-	int GetSeed() const { return m_seed; }
-	const int* GetTradeLevel() const { return m_tradeLevel; }
-	fixed GetAgricultural() const { return m_agricultural; }
-	fixed GetHumanProx() const { return m_humanProx; }
-	fixed GetTotalPop() const { return m_totalPop; }
+	fixed GetMetallicity() const { GenerateBodies(); return m_metallicity; }
+	fixed GetIndustrial() const { GenerateBodies(); return m_industrial; }
+	int GetEconType() const { GenerateBodies(); return m_econType; }
+	const int* GetTradeLevel() const { GenerateBodies(); return m_tradeLevel; }
+	fixed GetAgricultural() const { GenerateBodies(); return m_agricultural; }
+	fixed GetHumanProx() const { GenerateBodies(); return m_humanProx; }
+	fixed GetTotalPop() const { GenerateBodies(); return m_totalPop; }
 
 private:
 	StarSystem(const SystemPath &path);
 	~StarSystem();
 
+	// second generation phase. everything that hangs off the body
+	// hierarchy (population, starports, economy, descriptions) is done here
+	void GenerateBodies() const {
+		if (!m_bodiesGenerated) const_cast<StarSystem*>(this)->MakeBodies();
+	}
+	void MakeBodies();
+
 	SystemBody *NewBody() {
 		SystemBody *body = new SystemBody(SystemPath(m_path.sectorX, m_path.sectorY, m_path.sectorZ, m_path.systemIndex, m_bodies.size()));
 		m_bodies.push_back(RefCountedPtr<SystemBody>(body));
@@ -332,12 +352,19 @@ private:
 
 	SystemPath m_path;
 	int m_numStars;
+	SystemBody::BodyType m_starTypes[4];
 	std::string m_name;
 	std::string m_shortDesc, m_longDesc;
 	SysPolit m_polit;
 
 	bool m_isCustom;
 	bool m_hasCustomBodies;
+	bool m_bodiesGenerated;
+
+	RefCountedPtr<SystemBody> m_rootBody;
+	std::vector<SystemBody*> m_spaceStations;
+	std::vector<SystemBody*> m_stars;
+	std::vector< RefCountedPtr<SystemBody> > m_bodies;
 
 	Faction* m_faction;
 	bool m_unexplored;
@@ -0,0 +1,151 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "SystemNameIndex.h"
+#include "Sector.h"
+#include <cctype>
+
+void SystemNameIndex::AddSector(const Sector *sec)
+{
+	PROFILE_SCOPED()
+	if (!m_sectors.insert(sec->GetSystemPath()).second)
+		return;
+
+	for (const Sector::System &sys : sec->m_systems)
+		AddName(sys.name, SystemPath(sys.sx, sys.sy, sys.sz, sys.idx));
+}
+
+void SystemNameIndex::AddName(const std::string &name, const SystemPath &path)
+{
+	const Uint32 nameIdx = m_names.size();
+	m_names.push_back(Name());
+	m_names.back().name = name;
+	m_names.back().lower = ToLower(name);
+	m_names.back().path = path;
+
+	const std::string &lower = m_names.back().lower;
+	for (size_t i = 0; i < lower.size(); i++) {
+		if (i > 0 && !isspace(lower[i-1]))
+			continue;
+		if (isspace(lower[i]))
+			continue;
+		Key k;
+		k.key = lower.substr(i);
+		k.nameIdx = nameIdx;
+		k.offset = i;
+		m_keys.push_back(k);
+	}
+}
+
+void SystemNameIndex::Sort() const
+{
+	if (m_numSorted == m_keys.size())
+		return;
+
+	PROFILE_SCOPED()
+	std::vector<Key>::iterator mid = m_keys.begin() + m_numSorted;
+	std::sort(mid, m_keys.end());
+	std::inplace_merge(m_keys.begin(), mid, m_keys.end());
+	m_numSorted = m_keys.size();
+}
+
+std::string SystemNameIndex::ToLower(const std::string &s)
+{
+	std::string out(s);
+	for (size_t i = 0; i < out.size(); i++)
+		out[i] = tolower(out[i]);
+	return out;
+}
+
+// edit distance between search and the closest prefix of name, or maxDist+1
+// if every prefix is further away than maxDist. both must be lower case
+unsigned SystemNameIndex::PrefixDistance(const std::string &search, const std::string &name, unsigned maxDist, std::vector<unsigned> &rows)
+{
+	const size_t n = std::min(name.size(), search.size() + maxDist);
+	rows.resize(2*(n+1));
+	unsigned *prev = &rows[0];
+	unsigned *cur = &rows[n+1];
+	for (size_t j = 0; j <= n; j++)
+		prev[j] = j;
+
+	for (size_t i = 1; i <= search.size(); i++) {
+		cur[0] = i;
+		unsigned rowMin = cur[0];
+		for (size_t j = 1; j <= n; j++) {
+			const unsigned subst = prev[j-1] + (name[j-1] == search[i-1] ? 0 : 1);
+			cur[j] = std::min(subst, std::min(prev[j], cur[j-1]) + 1);
+			rowMin = std::min(rowMin, cur[j]);
+		}
+		if (rowMin > maxDist)
+			return maxDist + 1;
+		std::swap(prev, cur);
+	}
+
+	return *std::min_element(prev, prev + n + 1);
+}
+
+SystemNameIndex::MatchType SystemNameIndex::FindBest(const std::string &search, SystemPath &outPath) const
+{
+	PROFILE_SCOPED()
+	if (search.empty())
+		return MATCH_NONE;
+
+	Sort();
+
+	const std::string lower = ToLower(search);
+
+	// prefix and word start matches are a contiguous range of the keys
+	MatchType best = MATCH_NONE;
+	size_t bestLength = 0;
+
+	Key k;
+	k.key = lower;
+	for (std::vector<Key>::const_iterator it = std::lower_bound(m_keys.begin(), m_keys.end(), k); it != m_keys.end(); ++it) {
+		if (it->key.compare(0, lower.size(), lower) != 0)
+			break;
+
+		const Name &n = m_names[it->nameIdx];
+		if (it->offset == 0 && it->key.size() == lower.size()) {
+			outPath = n.path;
+			return MATCH_EXACT;
+		}
+
+		const MatchType type = (it->offset == 0) ? MATCH_PREFIX : MATCH_WORD;
+		if (type > best || (type == best && n.name.size() < bestLength)) {
+			best = type;
+			bestLength = n.name.size();
+			outPath = n.path;
+		}
+	}
+
+	if (best != MATCH_NONE)
+		return best;
+
+	// nothing starts with the search text, fall back to scanning the names
+	const unsigned maxDist = lower.size() >= 6 ? 2 : (lower.size() >= 3 ? 1 : 0);
+	unsigned bestDist = maxDist + 1;
+	std::vector<unsigned> rows;
+	for (const Name &n : m_names) {
+		if (n.lower.find(lower) != std::string::npos) {
+			if (best != MATCH_CONTAINS || n.name.size() < bestLength) {
+				best = MATCH_CONTAINS;
+				bestLength = n.name.size();
+				outPath = n.path;
+			}
+			continue;
+		}
+
+		if (best == MATCH_CONTAINS || !maxDist)
+			continue;
+
+		const unsigned dist = PrefixDistance(lower, n.lower, maxDist, rows);
+		if (dist < bestDist || (dist == bestDist && dist <= maxDist && n.name.size() < bestLength)) {
+			best = MATCH_FUZZY;
+			bestDist = dist;
+			bestLength = n.name.size();
+			outPath = n.path;
+		}
+	}
+
+	return best;
+}
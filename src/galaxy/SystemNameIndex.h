@@ -0,0 +1,69 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _SYSTEMNAMEINDEX_H
+#define _SYSTEMNAMEINDEX_H
+
+#include "libs.h"
+#include "galaxy/SystemPath.h"
+#include <set>
+#include <string>
+#include <vector>
+
+class Sector;
+
+// Name lookup for every system of every sector that has been generated so
+// far. Sectors are added as they enter the master sector cache and are never
+// removed, so systems stay searchable after their sector has been evicted.
+//
+// Each name is stored once, plus one sorted lower case key for every word
+// start in it ("Barnard's Star" gives "barnard's star" and "star"), so both
+// prefix and word-start lookups are binary searches.
+class SystemNameIndex {
+public:
+	SystemNameIndex() : m_numSorted(0) {}
+
+	void AddSector(const Sector *sec);
+
+	enum MatchType {
+		MATCH_NONE,
+		MATCH_FUZZY,     // within a small edit distance of the start of the name
+		MATCH_CONTAINS,  // search text occurs somewhere in the name
+		MATCH_WORD,      // a word in the name starts with the search text
+		MATCH_PREFIX,    // the name starts with the search text
+		MATCH_EXACT
+	};
+
+	// Finds the best match for a (case insensitive) search string: an exact
+	// match, or the shortest name of the best match type found
+	MatchType FindBest(const std::string &search, SystemPath &outPath) const;
+
+private:
+	struct Name {
+		std::string name;
+		std::string lower;
+		SystemPath path;
+	};
+
+	struct Key {
+		std::string key; // lower case, from a word start to the end of the name
+		Uint32 nameIdx;
+		Uint32 offset;   // position of the key in the name, 0 for the whole name
+		bool operator<(const Key &b) const { return key < b.key; }
+	};
+
+	void AddName(const std::string &name, const SystemPath &path);
+	void Sort() const;
+	static std::string ToLower(const std::string &s);
+	static unsigned PrefixDistance(const std::string &search, const std::string &name, unsigned maxDist, std::vector<unsigned> &rows);
+
+	std::vector<Name> m_names;
+	std::set<SystemPath> m_sectors;
+
+	// keys are appended unsorted and merged into the sorted range on the
+	// next lookup, so adding a batch of sectors does not resort everything
+	mutable std::vector<Key> m_keys;
+	mutable size_t m_numSorted;
+};
+
+#endif
@@ -5,11 +5,13 @@
 #include "FileSystem.h"
 #include "Material.h"
 #include "RendererGL2.h"
+#include "dummy/RendererDummy.h"
 #include "OS.h"
 
 namespace Graphics {
 
 static bool initted = false;
+static RendererType rendererType = RENDERER_OPENGL;
 Material *vtxColorMaterial;
 static int width, height;
 static float g_fov = 85.f;
@@ -59,12 +61,20 @@ Renderer* Init(Settings vs)
 	width = window->GetWidth();
 	height = window->GetHeight();
 
-	if (ogl_LoadFunctions() == ogl_LOAD_FAILED)
-		Error("Could not load OpenGL functions. Minimum supported version is 2.1.");
-
 	Renderer *renderer = 0;
 
-	renderer = new RendererGL2(window, vs);
+	rendererType = vs.rendererType;
+	switch (rendererType) {
+		case RENDERER_DUMMY:
+			renderer = new RendererDummy(window, vs);
+			break;
+		case RENDERER_OPENGL:
+		default:
+			if (ogl_LoadFunctions() == ogl_LOAD_FAILED)
+				Error("Could not load OpenGL functions. Minimum supported version is 2.1.");
+			renderer = new RendererGL2(window, vs);
+			break;
+	}
 
 	Output("Initialized %s\n", renderer->GetName());
 
@@ -117,6 +127,12 @@ std::vector<VideoMode> GetAvailableVideoModes()
 
 void Screendump(Uint8 *pixelData)
 {
+	// nothing was drawn, give a black image (rows padded like GL's)
+	if (rendererType == RENDERER_DUMMY) {
+		memset(pixelData, 0, ((3*width + 3) & ~3) * height);
+		return;
+	}
+
 	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
 	glPixelStorei(GL_PACK_ALIGNMENT, 4); // never trust defaults
 	glReadBuffer(GL_FRONT);
@@ -16,8 +16,14 @@ namespace Graphics {
 	class Renderer;
 	class Material;
 
+	enum RendererType {
+		RENDERER_OPENGL,
+		RENDERER_DUMMY   // draws nothing, counts calls; needs no GPU or GL context
+	};
+
 	// requested video settings
 	struct Settings {
+		RendererType rendererType;
 		bool fullscreen;
 		bool useTextureCompression;
 		bool enableDebugMessages;
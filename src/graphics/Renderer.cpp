@@ -3,12 +3,13 @@
 
 #include "Renderer.h"
 #include "Texture.h"
+#include "VertexArray.h"
 
 namespace Graphics {
 
 Renderer::Renderer(WindowSDL *window, int w, int h)
-	: m_width(w), m_height(h), m_ambient(Color::BLACK), m_window(window)
-	, m_viewMatrix(1.0)
+	: m_width(w), m_height(h), m_ambient(Color::BLACK), m_viewMatrix(1.0)
+	, m_textureLoader(nullptr), m_window(window)
 {
 }
 
@@ -17,6 +18,50 @@ Renderer::~Renderer()
 	RemoveAllCachedTextures();
 }
 
+bool Renderer::DrawTrianglesInstanced(const VertexArray *v, Uint32 instanceCount, const matrix4x4f *transforms, const Color *colors, RenderState *state, Material *material, PrimitiveType type)
+{
+	PROFILE_SCOPED()
+	assert(type == TRIANGLES || type == POINTS);
+	if (instanceCount == 0) return true;
+
+	const AttributeSet attribs = v->GetAttributeSet() | (colors ? ATTRIB_DIFFUSE : 0);
+	if (!m_instanceVertices || m_instanceVertices->GetAttributeSet() != attribs)
+		m_instanceVertices.reset(new VertexArray(attribs));
+
+	VertexArray &out = *m_instanceVertices;
+	const Uint32 numVerts = v->GetNumVerts();
+	const Uint32 total = numVerts * instanceCount;
+	out.position.resize(total);
+	if (v->HasAttrib(ATTRIB_NORMAL)) out.normal.resize(total);
+	if (attribs & ATTRIB_DIFFUSE) out.diffuse.resize(total);
+	if (v->HasAttrib(ATTRIB_UV0)) out.uv0.resize(total);
+
+	Uint32 dst = 0;
+	for (Uint32 i = 0; i < instanceCount; i++) {
+		const matrix4x4f &m = transforms[i];
+		for (Uint32 j = 0; j < numVerts; j++, dst++) {
+			out.position[dst] = m * v->position[j];
+			if (!out.normal.empty())
+				out.normal[dst] = m.ApplyRotationOnly(v->normal[j]);
+			if (!out.uv0.empty())
+				out.uv0[dst] = v->uv0[j];
+			if (!out.diffuse.empty()) {
+				if (!colors)
+					out.diffuse[dst] = v->diffuse[j];
+				else if (!v->HasAttrib(ATTRIB_DIFFUSE))
+					out.diffuse[dst] = colors[i];
+				else {
+					const Color &a = v->diffuse[j];
+					const Color &b = colors[i];
+					out.diffuse[dst] = Color(a.r*b.r/255, a.g*b.g/255, a.b*b.b/255, a.a*b.a/255);
+				}
+			}
+		}
+	}
+
+	return DrawTriangles(&out, state, material, type);
+}
+
 Texture *Renderer::GetCachedTexture(const std::string &type, const std::string &name)
 {
 	TextureCacheMap::iterator i = m_textures.find(TextureCacheKey(type,name));
@@ -6,6 +6,7 @@
 
 #include "WindowSDL.h"
 #include "libs.h"
+#include "graphics/Stats.h"
 #include "graphics/Types.h"
 #include <map>
 #include <memory>
@@ -24,6 +25,7 @@ class RenderState;
 class RenderTarget;
 class Texture;
 class TextureDescriptor;
+class TextureLoader;
 class VertexArray;
 class VertexBuffer;
 class IndexBuffer;
@@ -97,6 +99,10 @@ public:
 	virtual bool DrawPoints(int count, const vector3f *points, const Color *colors, RenderState*, float pointSize=1.f) { return false; }
 	//unindexed triangle draw
 	virtual bool DrawTriangles(const VertexArray *vertices, RenderState *state, Material *material, PrimitiveType type=TRIANGLES)  { return false; }
+	//draws the vertices once per transform (applied after the current model view),
+	//optionally tinted per instance. The default expands the instances into one
+	//draw, TRIANGLES and POINTS only
+	virtual bool DrawTrianglesInstanced(const VertexArray *vertices, Uint32 instanceCount, const matrix4x4f *transforms, const Color *colors, RenderState *state, Material *material, PrimitiveType type=TRIANGLES);
 	//high amount of textured quads for particles etc
 	virtual bool DrawPointSprites(int count, const vector3f *positions, RenderState *rs, Material *material, float size) { return false; }
 	//complex unchanging geometry that is worthwhile to store in VBOs etc.
@@ -109,17 +115,28 @@ public:
 	virtual RenderState *CreateRenderState(const RenderStateDesc &) = 0;
 	//returns 0 if unsupported
 	virtual RenderTarget *CreateRenderTarget(const RenderTargetDesc &) { return 0; }
-	virtual VertexBuffer *CreateVertexBuffer(const VertexBufferDesc&) = 0;
-	virtual IndexBuffer *CreateIndexBuffer(Uint32 size, BufferUsage) = 0;
+	//data, if given, is the initial contents: numVertices * stride bytes laid
+	//out as the desc says, or size indices. Nothing has to be mapped then
+	virtual VertexBuffer *CreateVertexBuffer(const VertexBufferDesc&, const void *data = nullptr) = 0;
+	virtual IndexBuffer *CreateIndexBuffer(Uint32 size, BufferUsage, const Uint16 *data = nullptr) = 0;
 
 	Texture *GetCachedTexture(const std::string &type, const std::string &name);
 	void AddCachedTexture(const std::string &type, const std::string &name, Texture *texture);
 	void RemoveCachedTexture(const std::string &type, const std::string &name);
 	void RemoveAllCachedTextures();
 
+	// background texture loading, used by TextureBuilder::GetOrCreateTextureAsync.
+	// not owned, none means textures are loaded synchronously
+	void SetTextureLoader(TextureLoader *loader) { m_textureLoader = loader; }
+	TextureLoader *GetTextureLoader() const { return m_textureLoader; }
+
 	// output human-readable debug info to the given stream
 	virtual bool PrintDebugInfo(std::ostream &out) { return false; }
 
+	// work submitted so far, for renderers that count it
+	Stats &GetStats() { return m_stats; }
+	const Stats &GetStats() const { return m_stats; }
+
 	virtual bool ReloadShaders() { return false; }
 
 	// our own matrix stack
@@ -173,10 +190,15 @@ protected:
 
 	matrix4x4d m_viewMatrix;
 
+	Stats m_stats;
+
 private:
+	std::unique_ptr<VertexArray> m_instanceVertices;
+
 	typedef std::pair<std::string,std::string> TextureCacheKey;
 	typedef std::map<TextureCacheKey,RefCountedPtr<Texture>*> TextureCacheMap;
 	TextureCacheMap m_textures;
+	TextureLoader *m_textureLoader;
 
 	std::unique_ptr<WindowSDL> m_window;
 };
@@ -8,12 +8,14 @@
 #include "OS.h"
 #include "StringF.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "TextureGL.h"
 #include "VertexArray.h"
 #include "GLDebug.h"
 #include "gl2/GL2Material.h"
 #include "gl2/GL2RenderState.h"
 #include "gl2/GL2RenderTarget.h"
+#include "gl2/GL2StreamBuffer.h"
 #include "gl2/GL2VertexBuffer.h"
 #include "gl2/MultiMaterial.h"
 #include "gl2/Program.h"
@@ -25,6 +27,9 @@
 
 namespace Graphics {
 
+//initial size, grows when a single draw needs more
+static const Uint32 STREAM_BUFFER_SIZE = 4 * 1024 * 1024;
+
 typedef std::vector<std::pair<MaterialDescriptor, GL2::Program*> >::const_iterator ProgramIterator;
 
 // for material-less line and point drawing
@@ -34,6 +39,7 @@ GL2::MultiProgram *flatColorProg;
 RendererGL2::RendererGL2(WindowSDL *window, const Graphics::Settings &vs)
 : Renderer(window, window->GetWidth(), window->GetHeight())
 , m_numDirLights(0)
+, m_clientStates(0)
 //the range is very large due to a "logarithmic z-buffer" trick used
 //http://outerra.blogspot.com/2009/08/logarithmic-z-buffer.html
 //http://www.gamedev.net/blog/73/entry-2006307-tip-of-the-day-logarithmic-zbuffer-artifacts-fix/
@@ -49,6 +55,8 @@ RendererGL2::RendererGL2(WindowSDL *window, const Graphics::Settings &vs)
 
 	const bool useDXTnTextures = vs.useTextureCompression && IsGLExtensionSupported("GL_EXT_texture_compression_s3tc");
 	m_useCompressedTextures = useDXTnTextures;
+	// compressed textures are encoded once and kept, not by the driver at every load
+	TextureCache::SetEnabled(useDXTnTextures);
 
 
 	glMatrixMode(GL_MODELVIEW);
@@ -67,6 +75,8 @@ RendererGL2::RendererGL2(WindowSDL *window, const Graphics::Settings &vs)
 	desc.vertexColors = true;
 	vtxColorProg = new GL2::MultiProgram(desc);
 	m_programs.push_back(std::make_pair(desc, vtxColorProg));
+
+	m_streamBuffer.reset(new GL2::StreamBuffer(STREAM_BUFFER_SIZE));
 }
 
 RendererGL2::~RendererGL2()
@@ -138,14 +148,21 @@ bool RendererGL2::SwapBuffers()
 #endif
 
 	GetWindow()->SwapBuffers();
+
+	m_stats.Add(Stats::STAT_STREAM_ORPHANS, m_streamBuffer->TakeNumOrphans());
+	m_stats.Add(Stats::STAT_PROGRAM_CHANGES, GL2::Program::TakeNumChanges());
+	m_stats.Add(Stats::STAT_TEXTURE_BINDS, TextureGL::TakeNumBinds());
+	m_stats.Add(Stats::STAT_BUFFER_BINDS, GL2::GLBufferBase::TakeNumBinds());
+	m_stats.NextFrame();
 	return true;
 }
 
 bool RendererGL2::SetRenderState(RenderState *rs)
 {
 	if (m_activeRenderState != rs) {
-		static_cast<GL2::RenderState*>(rs)->Apply();
+		static_cast<GL2::RenderState*>(rs)->Apply(static_cast<GL2::RenderState*>(m_activeRenderState));
 		m_activeRenderState = rs;
+		m_stats.Add(Stats::STAT_RENDERSTATE_CHANGES);
 	}
 	return true;
 }
@@ -159,28 +176,38 @@ bool RendererGL2::SetRenderTarget(RenderTarget *rt)
 		m_activeRenderTarget->Unbind();
 
 	m_activeRenderTarget = static_cast<GL2::RenderTarget*>(rt);
+	m_stats.Add(Stats::STAT_RENDERTARGET_CHANGES);
 
 	return true;
 }
 
 bool RendererGL2::ClearScreen()
 {
-	m_activeRenderState = nullptr;
-	glDepthMask(GL_TRUE);
+	ResetDepthMask();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	m_stats.Add(Stats::STAT_CLEARS);
 
 	return true;
 }
 
 bool RendererGL2::ClearDepthBuffer()
 {
-	m_activeRenderState = nullptr;
-	glDepthMask(GL_TRUE);
+	ResetDepthMask();
 	glClear(GL_DEPTH_BUFFER_BIT);
+	m_stats.Add(Stats::STAT_CLEARS);
 
 	return true;
 }
 
+void RendererGL2::ResetDepthMask()
+{
+	// clears need depth writes, the state that had them off must be set again
+	if (!m_activeRenderState || !m_activeRenderState->GetDesc().depthWrite) {
+		glDepthMask(GL_TRUE);
+		m_activeRenderState = nullptr;
+	}
+}
+
 bool RendererGL2::SetClearColor(const Color &c)
 {
 	glClearColor(c.r/255.f, c.g/255.f, c.b/255.f, c.a/255.f);
@@ -324,13 +351,14 @@ bool RendererGL2::DrawLines(int count, const vector3f *v, const Color *c, Render
 	vtxColorProg->Use();
 	vtxColorProg->invLogZfarPlus1.Set(m_invLogZfarPlus1);
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(3, GL_FLOAT, sizeof(vector3f), v);
-	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Color), c);
+	const Uint32 posSize = count * sizeof(vector3f);
+	const Uint32 colSize = count * sizeof(Color);
+	m_streamBuffer->Begin(posSize + colSize);
+	SetClientStates(CLIENT_VERTEX | CLIENT_COLOR);
+	glVertexPointer(3, GL_FLOAT, sizeof(vector3f), m_streamBuffer->Append(v, posSize));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Color), m_streamBuffer->Append(c, colSize));
 	glDrawArrays(t, 0, count);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	CountDraw(count, posSize + colSize);
 
 	return true;
 }
@@ -346,10 +374,12 @@ bool RendererGL2::DrawLines(int count, const vector3f *v, const Color &c, Render
 	flatColorProg->diffuse.Set(c);
 	flatColorProg->invLogZfarPlus1.Set(m_invLogZfarPlus1);
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, sizeof(vector3f), v);
+	const Uint32 posSize = count * sizeof(vector3f);
+	m_streamBuffer->Begin(posSize);
+	SetClientStates(CLIENT_VERTEX);
+	glVertexPointer(3, GL_FLOAT, sizeof(vector3f), m_streamBuffer->Append(v, posSize));
 	glDrawArrays(t, 0, count);
-	glDisableClientState(GL_VERTEX_ARRAY);
+	CountDraw(count, posSize);
 
 	return true;
 }
@@ -364,10 +394,12 @@ bool RendererGL2::DrawLines2D(int count, const vector2f *v, const Color &c, Grap
 	flatColorProg->diffuse.Set(c);
 	flatColorProg->invLogZfarPlus1.Set(m_invLogZfarPlus1);
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, sizeof(vector2f), v);
+	const Uint32 posSize = count * sizeof(vector2f);
+	m_streamBuffer->Begin(posSize);
+	SetClientStates(CLIENT_VERTEX);
+	glVertexPointer(2, GL_FLOAT, sizeof(vector2f), m_streamBuffer->Append(v, posSize));
 	glDrawArrays(t, 0, count);
-	glDisableClientState(GL_VERTEX_ARRAY);
+	CountDraw(count, posSize);
 
 	return true;
 }
@@ -381,15 +413,16 @@ bool RendererGL2::DrawPoints(int count, const vector3f *points, const Color *col
 
 	SetRenderState(state);
 
+	const Uint32 posSize = count * sizeof(vector3f);
+	const Uint32 colSize = count * sizeof(Color);
+	m_streamBuffer->Begin(posSize + colSize);
 	glPointSize(size);
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(3, GL_FLOAT, 0, points);
-	glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
+	SetClientStates(CLIENT_VERTEX | CLIENT_COLOR);
+	glVertexPointer(3, GL_FLOAT, 0, m_streamBuffer->Append(points, posSize));
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_streamBuffer->Append(colors, colSize));
 	glDrawArrays(GL_POINTS, 0, count);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
 	glPointSize(1.f); // XXX wont't be necessary
+	CountDraw(count, posSize + colSize);
 
 	return true;
 }
@@ -400,13 +433,13 @@ bool RendererGL2::DrawTriangles(const VertexArray *v, RenderState *rs, Material
 
 	SetRenderState(rs);
 
-	m->Apply();
+	ApplyMaterial(m);
 	EnableClientStates(v);
 
 	glDrawArrays(t, 0, v->GetNumVerts());
+	CountDraw(v->GetNumVerts(), 0);
 
 	m->Unapply();
-	DisableClientStates();
 
 	return true;
 }
@@ -450,21 +483,19 @@ bool RendererGL2::DrawPointSprites(int count, const vector3f *positions, RenderS
 bool RendererGL2::DrawBuffer(VertexBuffer* vb, RenderState* state, Material* mat, PrimitiveType pt)
 {
 	SetRenderState(state);
-	mat->Apply();
+	ApplyMaterial(mat);
 
 	auto gvb = static_cast<GL2::VertexBuffer*>(vb);
 
-	glBindBuffer(GL_ARRAY_BUFFER, gvb->GetBuffer());
+	GL2::GLBufferBase::BindArrayBuffer(gvb->GetBuffer());
 
 	gvb->SetAttribPointers();
 	EnableClientStates(gvb);
 
 	glDrawArrays(pt, 0, gvb->GetVertexCount());
+	CountDraw(gvb->GetVertexCount(), 0);
 
 	gvb->UnsetAttribPointers();
-	DisableClientStates();
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	return true;
 }
@@ -472,29 +503,25 @@ bool RendererGL2::DrawBuffer(VertexBuffer* vb, RenderState* state, Material* mat
 bool RendererGL2::DrawBufferIndexed(VertexBuffer *vb, IndexBuffer *ib, RenderState *state, Material *mat, PrimitiveType pt)
 {
 	SetRenderState(state);
-	mat->Apply();
+	ApplyMaterial(mat);
 
 	auto gvb = static_cast<GL2::VertexBuffer*>(vb);
 	auto gib = static_cast<GL2::IndexBuffer*>(ib);
 
-	glBindBuffer(GL_ARRAY_BUFFER, gvb->GetBuffer());
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gib->GetBuffer());
+	GL2::GLBufferBase::BindArrayBuffer(gvb->GetBuffer());
+	GL2::GLBufferBase::BindElementBuffer(gib->GetBuffer());
 
 	gvb->SetAttribPointers();
 	EnableClientStates(gvb);
 
 	glDrawElements(pt, ib->GetIndexCount(), GL_UNSIGNED_SHORT, 0);
+	CountDraw(ib->GetIndexCount(), 0);
 
 	gvb->UnsetAttribPointers();
-	DisableClientStates();
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 	return true;
 }
 
-
 void RendererGL2::EnableClientStates(const VertexArray *v)
 {
 	PROFILE_SCOPED();
@@ -502,29 +529,38 @@ void RendererGL2::EnableClientStates(const VertexArray *v)
 	if (!v) return;
 	assert(v->position.size() > 0); //would be strange
 
+	const Uint32 numVerts = v->GetNumVerts();
+	const bool diffuse = v->HasAttrib(ATTRIB_DIFFUSE);
+	const bool normal = v->HasAttrib(ATTRIB_NORMAL);
+	const bool uv0 = v->HasAttrib(ATTRIB_UV0);
+	Uint32 size = numVerts * sizeof(vector3f);
+	if (diffuse) size += numVerts * sizeof(Color);
+	if (normal) size += numVerts * sizeof(vector3f);
+	if (uv0) size += numVerts * sizeof(vector2f);
+	m_streamBuffer->Begin(size);
+	m_stats.Add(Stats::STAT_IMMEDIATE_BYTES, size);
+
 	// XXX could be 3D or 2D
-	m_clientStates.push_back(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, 0, reinterpret_cast<const GLvoid *>(&v->position[0]));
-
-	if (v->HasAttrib(ATTRIB_DIFFUSE)) {
-		assert(! v->diffuse.empty());
-		m_clientStates.push_back(GL_COLOR_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, reinterpret_cast<const GLvoid *>(&v->diffuse[0]));
+	Uint32 states = CLIENT_VERTEX;
+	glVertexPointer(3, GL_FLOAT, 0, m_streamBuffer->Append(&v->position[0], numVerts * sizeof(vector3f)));
+
+	if (diffuse) {
+		assert(v->diffuse.size() >= numVerts);
+		states |= CLIENT_COLOR;
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_streamBuffer->Append(&v->diffuse[0], numVerts * sizeof(Color)));
 	}
-	if (v->HasAttrib(ATTRIB_NORMAL)) {
-		assert(! v->normal.empty());
-		m_clientStates.push_back(GL_NORMAL_ARRAY);
-		glEnableClientState(GL_NORMAL_ARRAY);
-		glNormalPointer(GL_FLOAT, 0, reinterpret_cast<const GLvoid *>(&v->normal[0]));
+	if (normal) {
+		assert(v->normal.size() >= numVerts);
+		states |= CLIENT_NORMAL;
+		glNormalPointer(GL_FLOAT, 0, m_streamBuffer->Append(&v->normal[0], numVerts * sizeof(vector3f)));
 	}
-	if (v->HasAttrib(ATTRIB_UV0)) {
-		assert(! v->uv0.empty());
-		m_clientStates.push_back(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(2, GL_FLOAT, 0, reinterpret_cast<const GLvoid *>(&v->uv0[0]));
+	if (uv0) {
+		assert(v->uv0.size() >= numVerts);
+		states |= CLIENT_TEXCOORD;
+		glTexCoordPointer(2, GL_FLOAT, 0, m_streamBuffer->Append(&v->uv0[0], numVerts * sizeof(vector2f)));
 	}
+
+	SetClientStates(states);
 }
 
 void RendererGL2::EnableClientStates(const VertexBuffer *vb)
@@ -532,36 +568,57 @@ void RendererGL2::EnableClientStates(const VertexBuffer *vb)
 	if (!vb) return;
 	const auto& vbd = vb->GetDesc();
 
+	Uint32 states = 0;
 	for (Uint32 i = 0; i < MAX_ATTRIBS; i++) {
 		switch (vbd.attrib[i].semantic) {
 		case ATTRIB_POSITION:
-			m_clientStates.push_back(GL_VERTEX_ARRAY);
+			states |= CLIENT_VERTEX;
 			break;
 		case ATTRIB_DIFFUSE:
-			m_clientStates.push_back(GL_COLOR_ARRAY);
+			states |= CLIENT_COLOR;
 			break;
 		case ATTRIB_NORMAL:
-			m_clientStates.push_back(GL_NORMAL_ARRAY);
+			states |= CLIENT_NORMAL;
 			break;
 		case ATTRIB_UV0:
-			m_clientStates.push_back(GL_TEXTURE_COORD_ARRAY);
+			states |= CLIENT_TEXCOORD;
 			break;
 		default:
 			break;
 		}
 	}
 
-	for (auto it : m_clientStates)
-		glEnableClientState(it);
+	SetClientStates(states);
 }
 
-void RendererGL2::DisableClientStates()
+void RendererGL2::SetClientStates(Uint32 states)
 {
-	PROFILE_SCOPED();
+	static const GLenum arrays[] = { GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_NORMAL_ARRAY, GL_TEXTURE_COORD_ARRAY };
+
+	// arrays stay enabled between draws, only the differences are applied
+	const Uint32 changed = states ^ m_clientStates;
+	for (Uint32 i = 0; i < COUNTOF(arrays); i++) {
+		if (!(changed & (1 << i))) continue;
+		if (states & (1 << i))
+			glEnableClientState(arrays[i]);
+		else
+			glDisableClientState(arrays[i]);
+	}
+	m_clientStates = states;
+}
 
-	for (std::vector<GLenum>::const_iterator i = m_clientStates.begin(); i != m_clientStates.end(); ++i)
-		glDisableClientState(*i);
-	m_clientStates.clear();
+void RendererGL2::ApplyMaterial(Material *m)
+{
+	m->Apply();
+	m_stats.Add(Stats::STAT_MATERIAL_APPLIES);
+}
+
+void RendererGL2::CountDraw(Uint32 numVerts, Uint32 immediateBytes)
+{
+	m_stats.Add(Stats::STAT_DRAWCALLS);
+	m_stats.Add(Stats::STAT_VERTICES, numVerts);
+	if (immediateBytes)
+		m_stats.Add(Stats::STAT_IMMEDIATE_BYTES, immediateBytes);
 }
 
 Material *RendererGL2::CreateMaterial(const MaterialDescriptor &d)
@@ -595,6 +652,7 @@ Material *RendererGL2::CreateMaterial(const MaterialDescriptor &d)
 	p = GetOrCreateProgram(mat); // XXX throws ShaderException on compile/link failure
 
 	mat->SetProgram(p);
+	m_stats.Add(Stats::STAT_CREATED_MATERIALS);
 	return mat;
 }
 
@@ -633,6 +691,7 @@ GL2::Program* RendererGL2::GetOrCreateProgram(GL2::Material *mat)
 
 Texture *RendererGL2::CreateTexture(const TextureDescriptor &descriptor)
 {
+	m_stats.Add(Stats::STAT_CREATED_TEXTURES);
 	return new TextureGL(descriptor, m_useCompressedTextures);
 }
 
@@ -684,19 +743,23 @@ RenderTarget *RendererGL2::CreateRenderTarget(const RenderTargetDesc &desc)
 	return rt;
 }
 
-VertexBuffer *RendererGL2::CreateVertexBuffer(const VertexBufferDesc &desc)
+VertexBuffer *RendererGL2::CreateVertexBuffer(const VertexBufferDesc &desc, const void *data)
 {
-	return new GL2::VertexBuffer(desc);
+	GL2::VertexBuffer *vb = new GL2::VertexBuffer(desc, data);
+	m_stats.Add(Stats::STAT_CREATED_VERTEXBUFFERS);
+	m_stats.Add(Stats::STAT_VERTEXBUFFER_BYTES, vb->GetDesc().numVertices * vb->GetDesc().stride);
+	return vb;
 }
 
-IndexBuffer *RendererGL2::CreateIndexBuffer(Uint32 size, BufferUsage usage)
+IndexBuffer *RendererGL2::CreateIndexBuffer(Uint32 size, BufferUsage usage, const Uint16 *data)
 {
-	return new GL2::IndexBuffer(size, usage);
+	m_stats.Add(Stats::STAT_CREATED_INDEXBUFFERS);
+	m_stats.Add(Stats::STAT_INDEXBUFFER_BYTES, size * sizeof(Uint16));
+	return new GL2::IndexBuffer(size, usage, data);
 }
 
-// XXX very heavy. in the future when all GL calls are made through the
-// renderer, we can probably do better by trackingn current state and
-// only restoring the things that have changed
+// XXX very heavy. render state, programs, textures and buffers are tracked
+// now, the attribute stack could be replaced by restoring those
 void RendererGL2::PushState()
 {
 	SetMatrixMode(MatrixMode::PROJECTION);
@@ -710,6 +773,9 @@ void RendererGL2::PushState()
 void RendererGL2::PopState()
 {
 	glPopAttrib();
+	// the attribute stack restored render state and texture bindings
+	m_activeRenderState = nullptr;
+	TextureGL::InvalidateBindings();
 	m_viewportStack.pop();
 	assert(!m_viewportStack.empty());
 	SetMatrixMode(MatrixMode::PROJECTION);
@@ -748,6 +814,9 @@ bool RendererGL2::PrintDebugInfo(std::ostream &out)
 	out << " " << glGetString(GL_RENDERER) << "\n";
 	out << "Shading language version: " <<  glGetString(GL_SHADING_LANGUAGE_VERSION) << "\n";
 
+	out << "\nRenderer statistics, " << m_stats.GetNumFrames() << " frames:\n";
+	m_stats.Print(out);
+
 	//TODO: dump extension list
 	return true;
 }
@@ -28,6 +28,7 @@ namespace GL2 {
 	class Program;
 	class RenderState;
 	class RenderTarget;
+	class StreamBuffer;
 }
 
 class RendererGL2 : public Renderer
@@ -80,8 +81,8 @@ public:
 	virtual Texture *CreateTexture(const TextureDescriptor &descriptor) override;
 	virtual RenderState *CreateRenderState(const RenderStateDesc &) override;
 	virtual RenderTarget *CreateRenderTarget(const RenderTargetDesc &) override;
-	virtual VertexBuffer *CreateVertexBuffer(const VertexBufferDesc&) override;
-	virtual IndexBuffer *CreateIndexBuffer(Uint32 size, BufferUsage) override;
+	virtual VertexBuffer *CreateVertexBuffer(const VertexBufferDesc&, const void *data = nullptr) override;
+	virtual IndexBuffer *CreateIndexBuffer(Uint32 size, BufferUsage, const Uint16 *data = nullptr) override;
 
 	virtual bool ReloadShaders();
 
@@ -107,17 +108,31 @@ protected:
 	virtual void PopState();
 
 	//figure out states from a vertex array and enable them
-	//also sets vertex pointers
+	//also copies the vertices to the stream buffer and sets
+	//vertex pointers, leaving the stream buffer bound
 	void EnableClientStates(const VertexArray*);
 	void EnableClientStates(const VertexBuffer*);
-	//disable previously enabled
-	virtual void DisableClientStates();
+	//enable exactly these client arrays
+	enum ClientState {
+		CLIENT_VERTEX   = 1 << 0,
+		CLIENT_COLOR    = 1 << 1,
+		CLIENT_NORMAL   = 1 << 2,
+		CLIENT_TEXCOORD = 1 << 3
+	};
+	void SetClientStates(Uint32 states);
+
+	void ApplyMaterial(Material*);
+	void CountDraw(Uint32 numVerts, Uint32 immediateBytes);
+	//depth writes on for clearing
+	void ResetDepthMask();
 
 	bool IsGLExtensionSupported(const std::string& name);
 
 	int m_numLights;
 	int m_numDirLights;
-	std::vector<GLenum> m_clientStates;
+	Uint32 m_clientStates; //enabled ClientState bits
+	//vertices of the immediate draw functions
+	std::unique_ptr<GL2::StreamBuffer> m_streamBuffer;
 	float m_minZNear;
 	float m_maxZFar;
 	bool m_useCompressedTextures;
@@ -0,0 +1,77 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "Stats.h"
+#include <iomanip>
+
+namespace Graphics {
+
+static const char *s_statNames[Stats::MAX_STAT] = {
+	"draw calls",
+	"vertices",
+	"render state changes",
+	"program changes",
+	"texture binds",
+	"buffer binds",
+	"material applies",
+	"render target changes",
+	"transform changes",
+	"clears",
+	"immediate bytes",
+	"stream buffer orphans",
+	"vertex buffer bytes",
+	"index buffer bytes",
+	"texture bytes",
+	"vertex buffers created",
+	"index buffers created",
+	"textures created",
+	"materials created",
+	"render targets created",
+};
+
+Stats::Stats()
+{
+	Reset();
+}
+
+void Stats::Clear(FrameData &data)
+{
+	for (int i = 0; i < MAX_STAT; i++)
+		data.counts[i] = 0;
+}
+
+void Stats::NextFrame()
+{
+	for (int i = 0; i < MAX_STAT; i++)
+		m_totals.counts[i] += m_current.counts[i];
+	m_last = m_current;
+	Clear(m_current);
+	++m_numFrames;
+}
+
+void Stats::Reset()
+{
+	Clear(m_current);
+	Clear(m_last);
+	Clear(m_totals);
+	m_numFrames = 0;
+}
+
+//static
+const char *Stats::GetName(StatType type)
+{
+	assert(type >= 0 && type < MAX_STAT);
+	return s_statNames[type];
+}
+
+void Stats::Print(std::ostream &out) const
+{
+	out << "Renderer stats over " << m_numFrames << " frames (last frame, total, average):\n";
+	for (int i = 0; i < MAX_STAT; i++) {
+		const double average = m_numFrames ? double(m_totals.counts[i]) / m_numFrames : 0.0;
+		out << std::setw(24) << s_statNames[i] << ": " << m_last.counts[i] << ", " << m_totals.counts[i]
+			<< ", " << std::fixed << std::setprecision(1) << average << "\n";
+	}
+}
+
+}
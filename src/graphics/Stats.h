@@ -0,0 +1,75 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _GRAPHICS_STATS_H
+#define _GRAPHICS_STATS_H
+
+#include "libs.h"
+#include <ostream>
+
+namespace Graphics {
+
+// Counts of the work handed to a renderer: draw calls, state changes and the
+// bytes sent to buffers and textures. Counted per frame, the last finished
+// frame is kept along with the totals since the last Reset.
+class Stats {
+public:
+	enum StatType {
+		STAT_DRAWCALLS,
+		STAT_VERTICES,          // vertices (or indices) drawn
+		STAT_RENDERSTATE_CHANGES,
+		STAT_PROGRAM_CHANGES,   // shader programs actually switched
+		STAT_TEXTURE_BINDS,     // textures actually bound, and texture unit switches
+		STAT_BUFFER_BINDS,      // buffer objects actually bound
+		STAT_MATERIAL_APPLIES,
+		STAT_RENDERTARGET_CHANGES,
+		STAT_TRANSFORM_CHANGES, // modelview or projection
+		STAT_CLEARS,
+		STAT_IMMEDIATE_BYTES,   // vertex data passed to the immediate draw functions
+		STAT_STREAM_ORPHANS,    // times the immediate data stream buffer was full
+		STAT_VERTEXBUFFER_BYTES,
+		STAT_INDEXBUFFER_BYTES,
+		STAT_TEXTURE_BYTES,
+		STAT_CREATED_VERTEXBUFFERS,
+		STAT_CREATED_INDEXBUFFERS,
+		STAT_CREATED_TEXTURES,
+		STAT_CREATED_MATERIALS,
+		STAT_CREATED_RENDERTARGETS,
+
+		MAX_STAT
+	};
+
+	struct FrameData {
+		Uint64 counts[MAX_STAT];
+	};
+
+	Stats();
+
+	void Add(StatType type, Uint64 count = 1) { m_current.counts[type] += count; }
+
+	// ends the current frame
+	void NextFrame();
+	void Reset();
+
+	const FrameData &GetCurrentFrame() const { return m_current; }
+	const FrameData &GetLastFrame() const { return m_last; }
+	const FrameData &GetTotals() const { return m_totals; }
+	Uint32 GetNumFrames() const { return m_numFrames; }
+
+	static const char *GetName(StatType type);
+
+	// last frame, totals and per frame average, one line per stat
+	void Print(std::ostream &out) const;
+
+private:
+	static void Clear(FrameData &data);
+
+	FrameData m_current;
+	FrameData m_last;
+	FrameData m_totals;
+	Uint32 m_numFrames;
+};
+
+}
+
+#endif
@@ -24,6 +24,8 @@ enum TextureFormat {
 
 	TEXTURE_DXT1, // data is expected to be pre-compressed
 	TEXTURE_DXT5,
+	TEXTURE_SRGB_DXT1,
+	TEXTURE_SRGB_DXT5,
 
 	TEXTURE_DEPTH //precision chosen by renderer
 };
@@ -40,6 +42,26 @@ enum TextureType {
 	TEXTURE_CUBE_MAP
 };
 
+// bytes per pixel of the uncompressed formats, 0 for the block compressed ones
+inline unsigned int GetBytesPerPixel(TextureFormat format) {
+	switch (format) {
+		case TEXTURE_RGBA_8888:
+		case TEXTURE_SRGBA_8888:
+		case TEXTURE_DEPTH: return 4;
+		case TEXTURE_RGB_888:
+		case TEXTURE_SRGB_888: return 3;
+		case TEXTURE_LUMINANCE_ALPHA_88: return 2;
+		case TEXTURE_INTENSITY_8: return 1;
+		default: return 0;
+	}
+}
+
+// rows of uncompressed images are padded to 4 bytes, the default GL unpack
+// alignment and the row alignment of SDL surfaces
+inline size_t GetUncompressedLevelSize(unsigned int width, unsigned int height, TextureFormat format) {
+	return ((width * GetBytesPerPixel(format) + 3) & ~3) * height;
+}
+
 struct TextureCubeData {
 	void* posX;
 	void* negX;
@@ -95,6 +117,10 @@ public:
 	virtual void Update(const TextureCubeData &data, const vector2f &dataSize, TextureFormat format, const unsigned int numMips = 0) = 0;
 	virtual void SetSampleMode(TextureSampleMode) = 0;
 
+	// replaces the image with empty storage for the new descriptor. the
+	// texture object stays the same, so materials using it need no update
+	virtual void Reallocate(const TextureDescriptor &descriptor) { m_descriptor = descriptor; }
+
 	virtual ~Texture() {}
 
 protected:
@@ -2,6 +2,8 @@
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 
 #include "TextureBuilder.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
 #include "FileSystem.h"
 #include "utils.h"
 #include <SDL_image.h>
@@ -15,7 +17,7 @@ namespace Graphics
 
 TextureBuilder::TextureBuilder(const SDLSurfacePtr& surface, TextureSampleMode sampleMode, bool generateMipmaps, bool potExtend, bool forceRGBA, bool compressTextures) :
 	m_surface(surface), m_sampleMode(sampleMode), m_generateMipmaps(generateMipmaps), m_potExtend(potExtend), m_forceRGBA(forceRGBA),
-	m_compressTextures(compressTextures), m_textureType(TEXTURE_2D), m_srgb(false), m_prepared(false)
+	m_compressTextures(compressTextures), m_textureType(TEXTURE_2D), m_srgb(false), m_prepared(false), m_buildMipmaps(false), m_storeCompressed(false)
 {
 }
 
@@ -24,7 +26,7 @@ TextureBuilder::TextureBuilder(const std::string& filename, TextureSampleMode sa
                                bool srgb, TextureType textureType) :
 	m_filename(filename), m_sampleMode(sampleMode), m_generateMipmaps(generateMipmaps),
 	m_potExtend(potExtend), m_forceRGBA(forceRGBA), m_compressTextures(compressTextures),
-	m_textureType(textureType), m_srgb(srgb), m_prepared(false)
+	m_textureType(textureType), m_srgb(srgb), m_prepared(false), m_buildMipmaps(false), m_storeCompressed(false)
 {
 }
 
@@ -94,10 +96,13 @@ void TextureBuilder::PrepareSurface()
 {
 	if (m_prepared) return;
 
-	if (!m_surface && !m_filename.empty()) {
+	// on a worker the file was read and the cache looked up already
+	const bool loadFile = !m_surface && !m_filename.empty();
+	if (loadFile) {
 		std::string filename = m_filename;
 		std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
 		LoadSurface();
+		if (m_prepared) return; // found in the compressed texture cache
 	}
 
 	TextureFormat targetTextureFormat;
@@ -159,6 +164,19 @@ void TextureBuilder::PrepareSurface()
 			if (width != virtualWidth || height != virtualHeight)
 				Output("WARNING: texture '%s' is not power-of-two and may not display correctly\n", m_filename.c_str());
 		}
+
+		if (m_buildMipmaps)
+			numberOfMipMaps = BuildMipmaps(targetTextureFormat);
+
+		// a cache miss, encode and store it. extended images are left out,
+		// a cached image always covers the whole texture
+		if (!m_cacheKey.empty() && numberOfMipMaps > 0 && actualWidth == virtualWidth && actualHeight == virtualHeight &&
+				TextureCache::Encode(&m_mipmaps[0], actualWidth, actualHeight, numberOfMipMaps, targetTextureFormat, m_compressed)) {
+			m_storeCompressed = true;
+			std::vector<Uint8>().swap(m_mipmaps);
+			targetTextureFormat = CompressedFormat(m_compressed.format);
+			numberOfMipMaps = m_compressed.numMips;
+		}
 	}
 
 	m_descriptor = TextureDescriptor(
@@ -168,6 +186,9 @@ void TextureBuilder::PrepareSurface()
 		m_sampleMode, m_generateMipmaps, m_compressTextures, numberOfMipMaps, m_textureType);
 
 	m_prepared = true;
+
+	if (loadFile)
+		StoreCompressed();
 }
 
 void TextureBuilder::LoadSurface()
@@ -176,8 +197,22 @@ void TextureBuilder::LoadSurface()
 
 	SDLSurfacePtr s;
 	if(m_textureType == TEXTURE_2D) {
-		s = LoadSurfaceFromFile(m_filename);
+		RefCountedPtr<FileSystem::FileData> filedata = FileSystem::gameDataFiles.ReadFile(m_filename);
+		if (filedata) {
+			const std::string key = GetCacheKey(*filedata);
+			if (!key.empty()) {
+				RefCountedPtr<FileSystem::FileData> entry = TextureCache::ReadEntry(key);
+				if (entry && LoadCompressed(*entry))
+					return;
+				// a miss, PrepareSurface encodes and stores the image
+				m_cacheKey = key;
+				m_buildMipmaps = true;
+			}
+			s = LoadSurfaceFromData(*filedata, m_filename);
+		} else
+			Output("LoadSurfaceFromFile: %s: could not read file\n", m_filename.c_str());
 		if (! s) {
+			m_cacheKey.clear(); // must not store the fallback under this file's key
 			s = LoadSurfaceFromFile("textures/unknown.png");
 		}
 	} else if(m_textureType == TEXTURE_CUBE_MAP) {
@@ -191,9 +226,15 @@ void TextureBuilder::LoadSurface()
 
 void TextureBuilder::UpdateTexture(Texture *texture)
 {
-	if( m_surface ) {
+	if (!m_compressed.data.empty()) {
+		assert(texture->GetDescriptor().type == TEXTURE_2D && m_textureType == TEXTURE_2D);
+		texture->Update(&m_compressed.data[0], vector2f(m_compressed.width, m_compressed.height), m_descriptor.format, m_compressed.numMips);
+	} else if( m_surface ) {
 		if(texture->GetDescriptor().type == TEXTURE_2D && m_textureType == TEXTURE_2D) {
-			texture->Update(m_surface->pixels, vector2f(m_surface->w,m_surface->h), m_descriptor.format, 0);
+			if (!m_mipmaps.empty())
+				texture->Update(&m_mipmaps[0], vector2f(m_surface->w,m_surface->h), m_descriptor.format, m_descriptor.numberOfMipMaps);
+			else
+				texture->Update(m_surface->pixels, vector2f(m_surface->w,m_surface->h), m_descriptor.format, 0);
 		} else if(texture->GetDescriptor().type == TEXTURE_CUBE_MAP && m_textureType == TEXTURE_CUBE_MAP) {
 			assert(m_cubemap.size() == 6);
 			TextureCubeData tcd;
@@ -212,6 +253,135 @@ void TextureBuilder::UpdateTexture(Texture *texture)
 	}
 }
 
+bool TextureBuilder::PrepareFromData(const FileSystem::FileData &data, const std::string &cacheKey, const FileSystem::FileData *cacheEntry)
+{
+	assert(!m_prepared && !m_surface && m_textureType == TEXTURE_2D);
+	if (cacheEntry && LoadCompressed(*cacheEntry))
+		return true;
+
+	m_surface = LoadSurfaceFromData(data, m_filename);
+	if (!m_surface)
+		return false;
+
+	// on a miss the key is kept, so PrepareSurface encodes the image
+	m_cacheKey = cacheKey;
+	m_buildMipmaps = true;
+	PrepareSurface();
+	return true;
+}
+
+void TextureBuilder::StoreCompressed()
+{
+	if (!m_storeCompressed)
+		return;
+	TextureCache::Store(m_cacheKey, m_compressed);
+	m_storeCompressed = false;
+}
+
+std::string TextureBuilder::GetCacheKey(const FileSystem::FileData &data) const
+{
+	if (!TextureCache::IsEnabled() || !m_compressTextures || !m_generateMipmaps || m_textureType != TEXTURE_2D)
+		return std::string();
+	return TextureCache::MakeKey(data, m_forceRGBA);
+}
+
+// uses an entry of the compressed texture cache, false if it is not valid
+bool TextureBuilder::LoadCompressed(const FileSystem::FileData &entry)
+{
+	if (!TextureCache::ParseEntry(entry, m_compressed))
+		return false;
+
+	m_descriptor = TextureDescriptor(
+		CompressedFormat(m_compressed.format),
+		vector2f(m_compressed.width, m_compressed.height),
+		vector2f(1.0f, 1.0f),
+		m_sampleMode, m_generateMipmaps, m_compressTextures, m_compressed.numMips, m_textureType);
+	m_prepared = true;
+	return true;
+}
+
+TextureFormat TextureBuilder::CompressedFormat(TextureFormat format) const
+{
+	if (!m_srgb)
+		return format;
+	return (format == TEXTURE_DXT5) ? TEXTURE_SRGB_DXT5 : TEXTURE_SRGB_DXT1;
+}
+
+// box filtered levels down to 1x1, rows padded as GetUncompressedLevelSize says.
+// returns the number of levels, 0 if the format is left to the renderer
+unsigned int TextureBuilder::BuildMipmaps(TextureFormat format)
+{
+	const unsigned int bpp = GetBytesPerPixel(format);
+	if (!m_generateMipmaps || m_textureType != TEXTURE_2D || (bpp != 3 && bpp != 4) || m_surface->format->BytesPerPixel != bpp)
+		return 0;
+
+	unsigned int width = m_surface->w, height = m_surface->h;
+	unsigned int numLevels = 1;
+	size_t total = GetUncompressedLevelSize(width, height, format);
+	while (width > 1 || height > 1) {
+		width = std::max(width / 2, 1U);
+		height = std::max(height / 2, 1U);
+		total += GetUncompressedLevelSize(width, height, format);
+		numLevels++;
+	}
+	m_mipmaps.resize(total);
+
+	// level 0 is the surface itself
+	width = m_surface->w;
+	height = m_surface->h;
+	Uint8 *dst = &m_mipmaps[0];
+	const size_t pitch = GetUncompressedLevelSize(width, 1, format);
+	for (unsigned int y = 0; y < height; y++)
+		memcpy(dst + y * pitch, static_cast<const Uint8*>(m_surface->pixels) + y * m_surface->pitch, width * bpp);
+
+	for (unsigned int level = 1; level < numLevels; level++) {
+		const Uint8 *src = dst;
+		const size_t srcPitch = GetUncompressedLevelSize(width, 1, format);
+		dst += GetUncompressedLevelSize(width, height, format);
+
+		const unsigned int w = std::max(width / 2, 1U);
+		const unsigned int h = std::max(height / 2, 1U);
+		const size_t dstPitch = GetUncompressedLevelSize(w, 1, format);
+		for (unsigned int y = 0; y < h; y++) {
+			const Uint8 *row0 = src + std::min(y * 2, height - 1) * srcPitch;
+			const Uint8 *row1 = src + std::min(y * 2 + 1, height - 1) * srcPitch;
+			Uint8 *out = dst + y * dstPitch;
+			for (unsigned int x = 0; x < w; x++) {
+				const unsigned int x0 = std::min(x * 2, width - 1) * bpp;
+				const unsigned int x1 = std::min(x * 2 + 1, width - 1) * bpp;
+				for (unsigned int c = 0; c < bpp; c++)
+					*out++ = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4;
+			}
+		}
+
+		width = w;
+		height = h;
+	}
+
+	return numLevels;
+}
+
+size_t TextureBuilder::GetUploadSize() const
+{
+	if (!m_compressed.data.empty())
+		return m_compressed.data.size();
+	if (!m_mipmaps.empty())
+		return m_mipmaps.size();
+	if (!m_surface)
+		return 0;
+	const size_t faceSize = size_t(m_surface->pitch) * m_surface->h;
+	return m_textureType == TEXTURE_CUBE_MAP ? 6 * faceSize : faceSize;
+}
+
+Texture *TextureBuilder::GetOrCreateTextureAsync(Renderer *r, const std::string &type, const Color &placeholder)
+{
+	// images from memory are converted right away, cube maps are not loaded from files
+	TextureLoader *loader = r->GetTextureLoader();
+	if (!loader || m_surface || m_filename.empty() || m_textureType != TEXTURE_2D)
+		return GetOrCreateTexture(r, type);
+	return loader->Load(*this, type, placeholder);
+}
+
 Texture *TextureBuilder::GetWhiteTexture(Renderer *r)
 {
 	return Model("textures/white.png").GetOrCreateTexture(r, "model");
@@ -9,6 +9,9 @@
 #include "Texture.h"
 #include "Renderer.h"
 #include "SDLWrappers.h"
+#include "TextureCache.h"
+
+namespace FileSystem { class FileData; }
 
 namespace Graphics {
 
@@ -57,6 +60,30 @@ public:
 		return t;
 	}
 
+	// like GetOrCreateTexture, but when the renderer has a TextureLoader the
+	// image is decoded in the background and a 1x1 texture of the placeholder
+	// colour is shown until it has been uploaded
+	Texture *GetOrCreateTextureAsync(Renderer *r, const std::string &type, const Color &placeholder = Color::WHITE);
+
+	// the compressed texture cache key for the file contents, empty if the
+	// builder does not use the cache
+	std::string GetCacheKey(const FileSystem::FileData &data) const;
+
+	// decodes the file contents, read earlier, converts the image and builds
+	// its mipmap chain. cacheEntry is the cache's entry for cacheKey, if there
+	// is one, and is used instead when it is valid. no GL or file system
+	// access, so it can run on a worker. false if the data could not be decoded
+	bool PrepareFromData(const FileSystem::FileData &data, const std::string &cacheKey, const FileSystem::FileData *cacheEntry);
+	// writes an image PrepareFromData encoded to the cache. main thread only
+	void StoreCompressed();
+
+	const std::string &GetFilename() const { return m_filename; }
+	TextureSampleMode GetSampleMode() const { return m_sampleMode; }
+	TextureType GetTextureType() const { return m_textureType; }
+	bool IsPrepared() const { return m_prepared; }
+	// bytes UpdateTexture passes to the texture
+	size_t GetUploadSize() const;
+
 	//commonly used dummy textures
 	static Texture *GetWhiteTexture(Renderer *);
 	static Texture *GetTransparentTexture(Renderer *);
@@ -79,6 +106,17 @@ private:
 	void PrepareSurface();
 	bool m_prepared;
 
+	// mipmap levels built on the CPU, level 0 included
+	unsigned int BuildMipmaps(TextureFormat format);
+	bool m_buildMipmaps;
+	std::vector<Uint8> m_mipmaps;
+
+	bool LoadCompressed(const FileSystem::FileData &entry);
+	TextureFormat CompressedFormat(TextureFormat format) const;
+	std::string m_cacheKey;
+	TextureCache::Image m_compressed;
+	bool m_storeCompressed; // m_compressed was encoded here, not loaded
+
 	void LoadSurface();
 };
 
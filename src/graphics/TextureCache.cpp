@@ -0,0 +1,324 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "TextureCache.h"
+#include "TextureBuilder.h"
+#include "FileSystem.h"
+#include "utils.h"
+#include "jenkins/lookup3.h"
+#include <climits>
+
+// Version history:
+// 1: DXT1/DXT5 with the mipmap levels TextureGL uploads
+static const Uint32 CACHE_VERSION = 1;
+static const char CACHE_MAGIC[4] = { 'P', 'T', 'C', 'H' };
+static const std::string CACHE_DIR = "texturecache";
+static const std::string CACHE_EXTENSION = ".dxt";
+
+namespace Graphics {
+
+namespace TextureCache {
+
+struct FileHeader {
+	char magic[4];
+	Uint32 version;
+	Uint32 format;
+	Uint32 width;
+	Uint32 height;
+	Uint32 numMips;
+	Uint32 dataSize;
+};
+
+static bool s_enabled = false;
+
+static inline Uint16 To565(const Uint8 *c)
+{
+	return ((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3);
+}
+
+static inline void From565(Uint16 v, int *c)
+{
+	const int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+	c[0] = (r << 3) | (r >> 2);
+	c[1] = (g << 2) | (g >> 4);
+	c[2] = (b << 3) | (b >> 2);
+}
+
+// block is 4x4 RGBA pixels. The end points are the corners of the colour
+// bounding box, moved in by 1/16 of its size to lower the average error
+static void EncodeColorBlock(const Uint8 *block, Uint8 *out)
+{
+	Uint8 minColor[3] = { 255, 255, 255 };
+	Uint8 maxColor[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < 3; c++) {
+			minColor[c] = std::min(minColor[c], block[i*4 + c]);
+			maxColor[c] = std::max(maxColor[c], block[i*4 + c]);
+		}
+	}
+	for (int c = 0; c < 3; c++) {
+		const Uint8 inset = (maxColor[c] - minColor[c]) >> 4;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	Uint16 c0 = To565(maxColor);
+	Uint16 c1 = To565(minColor);
+	// c0 > c1 selects the four colour mode
+	if (c0 < c1)
+		std::swap(c0, c1);
+
+	Uint32 indices = 0;
+	if (c0 != c1) {
+		int palette[4][3];
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; i++) {
+			int best = 0, bestDist = INT_MAX;
+			for (int p = 0; p < 4; p++) {
+				int dist = 0;
+				for (int c = 0; c < 3; c++) {
+					const int d = block[i*4 + c] - palette[p][c];
+					dist += d * d;
+				}
+				if (dist < bestDist) {
+					bestDist = dist;
+					best = p;
+				}
+			}
+			indices |= Uint32(best) << (2 * i);
+		}
+	}
+
+	out[0] = c0 & 0xff;
+	out[1] = c0 >> 8;
+	out[2] = c1 & 0xff;
+	out[3] = c1 >> 8;
+	out[4] = indices & 0xff;
+	out[5] = (indices >> 8) & 0xff;
+	out[6] = (indices >> 16) & 0xff;
+	out[7] = indices >> 24;
+}
+
+// DXT5 alpha, eight values interpolated between the extremes
+static void EncodeAlphaBlock(const Uint8 *block, Uint8 *out)
+{
+	Uint8 minAlpha = 255, maxAlpha = 0;
+	for (int i = 0; i < 16; i++) {
+		minAlpha = std::min(minAlpha, block[i*4 + 3]);
+		maxAlpha = std::max(maxAlpha, block[i*4 + 3]);
+	}
+
+	Uint64 indices = 0;
+	if (maxAlpha != minAlpha) {
+		int palette[8];
+		palette[0] = maxAlpha;
+		palette[1] = minAlpha;
+		for (int k = 1; k < 7; k++)
+			palette[k + 1] = ((7 - k) * maxAlpha + k * minAlpha) / 7;
+
+		for (int i = 0; i < 16; i++) {
+			int best = 0, bestDist = INT_MAX;
+			for (int p = 0; p < 8; p++) {
+				const int dist = abs(block[i*4 + 3] - palette[p]);
+				if (dist < bestDist) {
+					bestDist = dist;
+					best = p;
+				}
+			}
+			indices |= Uint64(best) << (3 * i);
+		}
+	}
+
+	out[0] = maxAlpha;
+	out[1] = minAlpha;
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (indices >> (8 * i)) & 0xff;
+}
+
+void SetEnabled(bool enabled)
+{
+	if (enabled && !FileSystem::userFiles.MakeDirectory(CACHE_DIR)) {
+		Output("TextureCache: could not create %s, compressed textures will not be cached\n", CACHE_DIR.c_str());
+		enabled = false;
+	}
+	s_enabled = enabled;
+}
+
+bool IsEnabled()
+{
+	return s_enabled;
+}
+
+std::string MakeKey(const FileSystem::FileData &source, bool forceRGBA)
+{
+	uint32_t hashA = 0, hashB = 0;
+	lookup3_hashlittle2(source.GetData(), source.GetSize(), &hashA, &hashB);
+	char key[32];
+	snprintf(key, sizeof(key), "%08x%08x%s", hashA, hashB, forceRGBA ? "a" : "");
+	return key;
+}
+
+static std::string EntryPath(const std::string &key)
+{
+	return FileSystem::JoinPath(CACHE_DIR, key + CACHE_EXTENSION);
+}
+
+// the size of a chain Encode could have written, 0 if there is no such chain
+static Uint64 ChainSize(const FileHeader &header)
+{
+	if (header.width < 4 || header.height < 4 || (header.width & (header.width - 1)) != 0 || (header.height & (header.height - 1)) != 0)
+		return 0;
+
+	const Uint64 blockSize = (header.format == TEXTURE_DXT5) ? 16 : 8;
+	Uint64 size = 0;
+	Uint32 w = header.width, h = header.height;
+	for (Uint32 level = 0; level < header.numMips; level++) {
+		if (w < 4 || h < 4)
+			return 0;
+		size += Uint64(w / 4) * Uint64(h / 4) * blockSize;
+		w /= 2;
+		h /= 2;
+	}
+	return size;
+}
+
+RefCountedPtr<FileSystem::FileData> ReadEntry(const std::string &key)
+{
+	return FileSystem::userFiles.ReadFile(EntryPath(key));
+}
+
+bool ParseEntry(const FileSystem::FileData &entry, Image &out)
+{
+	if (entry.GetSize() < sizeof(FileHeader))
+		return false;
+
+	FileHeader header;
+	memcpy(&header, entry.GetData(), sizeof(header));
+	if (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION)
+		return false;
+	if ((header.format != TEXTURE_DXT1 && header.format != TEXTURE_DXT5) ||
+			entry.GetSize() != sizeof(header) + header.dataSize || ChainSize(header) != header.dataSize) {
+		Output("TextureCache: %s is damaged, encoding again\n", entry.GetInfo().GetName().c_str());
+		return false;
+	}
+
+	out.format = TextureFormat(header.format);
+	out.width = header.width;
+	out.height = header.height;
+	out.numMips = header.numMips;
+	const Uint8 *data = reinterpret_cast<const Uint8*>(entry.GetData()) + sizeof(header);
+	out.data.assign(data, data + header.dataSize);
+	return true;
+}
+
+// written under a temporary name first, so an interrupted write never
+// leaves a partial entry behind
+void Store(const std::string &key, const Image &image)
+{
+	const std::string path = EntryPath(key);
+	const std::string tmpPath = path + ".tmp";
+	FILE *f = FileSystem::userFiles.OpenWriteStream(tmpPath);
+	if (!f) {
+		Output("TextureCache: could not write %s\n", key.c_str());
+		return;
+	}
+
+	FileHeader header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.format = image.format;
+	header.width = image.width;
+	header.height = image.height;
+	header.numMips = image.numMips;
+	header.dataSize = image.data.size();
+
+	const bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(&image.data[0], image.data.size(), 1, f) == 1;
+	if (fclose(f) != 0 || !ok || !FileSystem::userFiles.RenameFile(tmpPath, path))
+		Output("TextureCache: could not write %s\n", key.c_str());
+}
+
+bool Encode(const Uint8 *levels, Uint32 width, Uint32 height, Uint32 numLevels, TextureFormat format, Image &out)
+{
+	const Uint32 bpp = GetBytesPerPixel(format);
+	if ((bpp != 3 && bpp != 4) || numLevels == 0)
+		return false;
+	if (width < 4 || height < 4 || (width & (width - 1)) != 0 || (height & (height - 1)) != 0)
+		return false;
+
+	const Uint32 blockSize = (bpp == 4) ? 16 : 8;
+	out.format = (bpp == 4) ? TEXTURE_DXT5 : TEXTURE_DXT1;
+	out.width = width;
+	out.height = height;
+	out.numMips = 0;
+	out.data.clear();
+
+	Uint32 w = width, h = height;
+	for (Uint32 level = 0; level < numLevels; level++) {
+		const size_t pitch = GetUncompressedLevelSize(w, 1, format);
+		const size_t offset = out.data.size();
+		out.data.resize(offset + (w / 4) * (h / 4) * blockSize);
+		Uint8 *dst = &out.data[offset];
+
+		Uint8 block[16 * 4];
+		for (Uint32 by = 0; by < h; by += 4) {
+			for (Uint32 bx = 0; bx < w; bx += 4) {
+				for (Uint32 y = 0; y < 4; y++) {
+					for (Uint32 x = 0; x < 4; x++) {
+						const Uint8 *src = levels + (by + y) * pitch + (bx + x) * bpp;
+						Uint8 *b = block + (y * 4 + x) * 4;
+						b[0] = src[0];
+						b[1] = src[1];
+						b[2] = src[2];
+						b[3] = (bpp == 4) ? src[3] : 255;
+					}
+				}
+				if (bpp == 4) {
+					EncodeAlphaBlock(block, dst);
+					dst += 8;
+				}
+				EncodeColorBlock(block, dst);
+				dst += 8;
+			}
+		}
+		out.numMips++;
+
+		// same cut off as TextureGL, which keeps later levels from
+		// getting smaller than a block
+		if (w <= 16 || h <= 16)
+			break;
+		levels += GetUncompressedLevelSize(w, h, format);
+		w /= 2;
+		h /= 2;
+	}
+
+	return true;
+}
+
+Uint32 BuildAll(const std::string &path)
+{
+	PROFILE_SCOPED()
+	assert(s_enabled);
+	Uint32 numCached = 0;
+	for (FileSystem::FileEnumerator files(FileSystem::gameDataFiles, path, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
+		const std::string &fpath = files.Current().GetPath();
+		if (!ends_with_ci(fpath, ".png") && !ends_with_ci(fpath, ".jpg"))
+			continue;
+
+		// sRGB does not change the encoding, so this also covers ModelSRGB
+		TextureBuilder builder = TextureBuilder::Model(fpath);
+		const TextureFormat format = builder.GetDescriptor().format;
+		if (format == TEXTURE_DXT1 || format == TEXTURE_DXT5)
+			numCached++;
+	}
+	return numCached;
+}
+
+}
+
+}
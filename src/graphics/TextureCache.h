@@ -0,0 +1,63 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _TEXTURECACHE_H
+#define _TEXTURECACHE_H
+
+#include "libs.h"
+#include "Texture.h"
+#include <string>
+#include <vector>
+
+namespace FileSystem { class FileData; }
+
+namespace Graphics {
+
+// DXT1/DXT5 encoded images with their mipmap chains, kept in the user
+// directory under a hash of the source file. The driver no longer has to
+// compress every texture on every start: an image is encoded the first time
+// it is loaded, or ahead of time with the -texturecache mode.
+//
+// ReadEntry and Store go through the user FileSourceFS and must be called on
+// the main thread (the file sources are not thread safe). The others can run
+// on job workers.
+namespace TextureCache {
+
+	struct Image {
+		Image() : format(TEXTURE_NONE), width(0), height(0), numMips(0) {}
+
+		TextureFormat format; // TEXTURE_DXT1 or TEXTURE_DXT5, sRGB is up to the user
+		Uint32 width;
+		Uint32 height;
+		Uint32 numMips;
+		std::vector<Uint8> data; // the levels one after another
+	};
+
+	// on when the renderer uses compressed textures
+	void SetEnabled(bool enabled);
+	bool IsEnabled();
+
+	// the source contents and whether alpha is forced decide the encoding
+	std::string MakeKey(const FileSystem::FileData &source, bool forceRGBA);
+
+	// the raw entry, null if there is none
+	RefCountedPtr<FileSystem::FileData> ReadEntry(const std::string &key);
+	// false if the entry is from another version or damaged
+	bool ParseEntry(const FileSystem::FileData &entry, Image &out);
+
+	void Store(const std::string &key, const Image &image);
+
+	// encodes an RGB or RGBA mipmap chain laid out as GetUncompressedLevelSize
+	// says. Levels after the first one with a side of 16 or less are left out,
+	// TextureGL does not upload them. False if the image is not a power of two
+	// or smaller than a block
+	bool Encode(const Uint8 *levels, Uint32 width, Uint32 height, Uint32 numLevels, TextureFormat format, Image &out);
+
+	// makes sure every image below path in the game data is cached, with the
+	// settings model textures are loaded with. Returns the number of images cached
+	Uint32 BuildAll(const std::string &path);
+}
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "TextureGL.h"
 #include <cassert>
+#include <algorithm>
 #include "utils.h"
 
 static const unsigned int MIN_COMPRESSED_TEXTURE_DIMENSION = 16;
@@ -19,6 +20,8 @@ inline GLint GLInternalFormat(TextureFormat format) {
 		case TEXTURE_INTENSITY_8:  return GL_INTENSITY;
 		case TEXTURE_DXT5: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
 		case TEXTURE_DXT1:  return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case TEXTURE_SRGB_DXT5: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case TEXTURE_SRGB_DXT1: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
 		case TEXTURE_DEPTH: return GL_DEPTH_COMPONENT;
 		default: assert(0); return 0;
 	}
@@ -36,6 +39,8 @@ inline GLint GLCompressedInternalFormat(TextureFormat format) {
 		case TEXTURE_INTENSITY_8:  return GL_INTENSITY;
 		case TEXTURE_DXT5: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
 		case TEXTURE_DXT1:  return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case TEXTURE_SRGB_DXT5: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case TEXTURE_SRGB_DXT1: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
 		default: assert(0); return 0;
 	}
 }
@@ -52,6 +57,8 @@ inline GLint GLImageFormat(TextureFormat format) {
 		case TEXTURE_INTENSITY_8:  return GL_LUMINANCE;
 		case TEXTURE_DXT5: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
 		case TEXTURE_DXT1:  return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case TEXTURE_SRGB_DXT5: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case TEXTURE_SRGB_DXT1: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
 		case TEXTURE_DEPTH: return GL_DEPTH_COMPONENT;
 		default: assert(0); return 0;
 	}
@@ -71,36 +78,67 @@ inline GLint GLImageType(TextureFormat format) {
 
 inline int GetMinSize(TextureFormat flag) {
 	switch(flag) {
-	case TEXTURE_DXT1: return 8;
-	case TEXTURE_DXT5: return 16;
+	case TEXTURE_DXT1:
+	case TEXTURE_SRGB_DXT1: return 8;
+	case TEXTURE_DXT5:
+	case TEXTURE_SRGB_DXT5: return 16;
 	default: return 1;
 	}
 }
 
 inline bool IsCompressed(TextureFormat format) {
-	return (format == TEXTURE_DXT1 || format == TEXTURE_DXT5);
+	return (format == TEXTURE_DXT1 || format == TEXTURE_DXT5 || format == TEXTURE_SRGB_DXT1 || format == TEXTURE_SRGB_DXT5);
 }
 
 TextureGL::TextureGL(const TextureDescriptor &descriptor, const bool useCompressed) :
-	Texture(descriptor)
+	Texture(descriptor), m_useCompressed(useCompressed)
 {
 	m_target = GLTextureType(descriptor.type);
 
 	glGenTextures(1, &m_texture);
-	glBindTexture(m_target, m_texture);
+	Allocate(descriptor);
+}
+
+void TextureGL::Reallocate(const TextureDescriptor &descriptor)
+{
+	assert(GLTextureType(descriptor.type) == m_target);
+	Texture::Reallocate(descriptor);
+	Allocate(descriptor);
+}
 
+void TextureGL::Allocate(const TextureDescriptor &descriptor)
+{
+	Bind();
 
 	// useCompressed is the global scope flag whereas descriptor.allowCompression is the local texture mode flag
 	// either both or neither might be true however only compress the texture when both are true.
-	const bool compressTexture = useCompressed && descriptor.allowCompression;
+	const bool compressTexture = m_useCompressed && descriptor.allowCompression;
 
 	switch (m_target) {
 		case GL_TEXTURE_2D:
-			if (!IsCompressed(descriptor.format)) {
-				if (descriptor.generateMipmaps)
+			if (!IsCompressed(descriptor.format) && descriptor.generateMipmaps && descriptor.numberOfMipMaps > 0) {
+				// the mipmap chain was built beforehand and comes with Update
+				glTexParameteri(m_target, GL_GENERATE_MIPMAP, GL_FALSE);
+				size_t Width = descriptor.dataSize.x;
+				size_t Height = descriptor.dataSize.y;
+				for (unsigned int i = 0; i < descriptor.numberOfMipMaps; ++i) {
+					glTexImage2D(
+						m_target, i, compressTexture ? GLCompressedInternalFormat(descriptor.format) : GLInternalFormat(descriptor.format),
+						Width, Height, 0,
+						GLImageFormat(descriptor.format),
+						GLImageType(descriptor.format), 0);
+					Width = std::max<size_t>(Width / 2, 1);
+					Height = std::max<size_t>(Height / 2, 1);
+				}
+				glTexParameteri(m_target, GL_TEXTURE_MAX_LEVEL, descriptor.numberOfMipMaps - 1);
+			} else if (!IsCompressed(descriptor.format)) {
+				if (descriptor.generateMipmaps) {
 					glTexParameteri(m_target, GL_GENERATE_MIPMAP, GL_TRUE);
-				else
+					glTexParameteri(m_target, GL_TEXTURE_MAX_LEVEL, 1000); // GL default, Reallocate may come from a single level
+				} else {
+					glTexParameteri(m_target, GL_GENERATE_MIPMAP, GL_FALSE);
 					glTexParameteri(m_target, GL_TEXTURE_MAX_LEVEL, 0);
+				}
 
 				glTexImage2D(
 					m_target, 0, compressTexture ? GLCompressedInternalFormat(descriptor.format) : GLInternalFormat(descriptor.format),
@@ -233,17 +271,34 @@ TextureGL::TextureGL(const TextureDescriptor &descriptor, const bool useCompress
 
 TextureGL::~TextureGL()
 {
+	// GL unbinds deleted textures and may reuse the name
+	for (Uint32 i = 0; i < MAX_TEXTURE_UNITS; i++) {
+		if (s_bound[i][0] == m_texture) s_bound[i][0] = 0;
+		if (s_bound[i][1] == m_texture) s_bound[i][1] = 0;
+	}
 	glDeleteTextures(1, &m_texture);
 }
 
 void TextureGL::Update(const void *data, const vector2f &pos, const vector2f &dataSize, TextureFormat format, const unsigned int numMips)
 {
 	assert(m_target == GL_TEXTURE_2D);
-	glBindTexture(m_target, m_texture);
+	Bind();
 
 	switch (m_target) {
 		case GL_TEXTURE_2D:
-			if (!IsCompressed(format)) {
+			if (!IsCompressed(format) && numMips > 1) {
+				// levels follow each other, see GetUncompressedLevelSize
+				assert(pos.x == 0 && pos.y == 0);
+				size_t Width = dataSize.x;
+				size_t Height = dataSize.y;
+				const unsigned char *pData = static_cast<const unsigned char*>(data);
+				for (unsigned int i = 0; i < numMips; ++i) {
+					glTexSubImage2D(m_target, i, 0, 0, Width, Height, GLImageFormat(format), GLImageType(format), pData);
+					pData += GetUncompressedLevelSize(Width, Height, format);
+					Width = std::max<size_t>(Width / 2, 1);
+					Height = std::max<size_t>(Height / 2, 1);
+				}
+			} else if (!IsCompressed(format)) {
 				glTexSubImage2D(m_target, 0, pos.x, pos.y, dataSize.x, dataSize.y, GLImageFormat(format), GLImageType(format), data);
 			} else {
 				const GLint oglInternalFormat = GLImageFormat(format);
@@ -269,15 +324,13 @@ void TextureGL::Update(const void *data, const vector2f &pos, const vector2f &da
 		default:
 			assert(0);
 	}
-
-	glBindTexture(m_target, 0);
 }
 
 void TextureGL::Update(const TextureCubeData &data, const vector2f &dataSize, TextureFormat format, const unsigned int numMips)
 {
 	assert(m_target == GL_TEXTURE_CUBE_MAP);
 
-	glBindTexture(m_target, m_texture);
+	Bind();
 
 	switch (m_target) {
 		case GL_TEXTURE_CUBE_MAP:
@@ -322,18 +375,59 @@ void TextureGL::Update(const TextureCubeData &data, const vector2f &dataSize, Te
 		default:
 			assert(0);
 	}
-
-	glBindTexture(m_target, 0);
 }
 
+GLuint TextureGL::s_bound[MAX_TEXTURE_UNITS][2];
+Uint32 TextureGL::s_activeUnit = 0;
+Uint32 TextureGL::s_numBinds = 0;
+
 void TextureGL::Bind()
 {
-	glBindTexture(m_target, m_texture);
+	GLuint &slot = BoundSlot();
+	if (slot != m_texture) {
+		glBindTexture(m_target, m_texture);
+		slot = m_texture;
+		++s_numBinds;
+	}
 }
 
 void TextureGL::Unbind()
 {
-	glBindTexture(m_target, 0);
+	GLuint &slot = BoundSlot();
+	if (slot != 0) {
+		glBindTexture(m_target, 0);
+		slot = 0;
+		++s_numBinds;
+	}
+}
+
+//static
+void TextureGL::SetActiveUnit(Uint32 unit)
+{
+	assert(unit < MAX_TEXTURE_UNITS);
+	if (s_activeUnit != unit) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		s_activeUnit = unit;
+		++s_numBinds;
+	}
+}
+
+//static
+void TextureGL::InvalidateBindings()
+{
+	// the bound names are unknown, make the next binds go through
+	for (Uint32 i = 0; i < MAX_TEXTURE_UNITS; i++)
+		s_bound[i][0] = s_bound[i][1] = ~0u;
+	glActiveTexture(GL_TEXTURE0);
+	s_activeUnit = 0;
+}
+
+//static
+Uint32 TextureGL::TakeNumBinds()
+{
+	const Uint32 n = s_numBinds;
+	s_numBinds = 0;
+	return n;
 }
 
 void TextureGL::SetSampleMode(TextureSampleMode mode)
@@ -363,10 +457,9 @@ void TextureGL::SetSampleMode(TextureSampleMode mode)
 			minFilter =mipmaps ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
 			break;
 	}
-	glBindTexture(m_target, m_texture);
+	Bind();
 	glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, magFilter);
 	glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, minFilter);
-	glBindTexture(m_target, 0);
 }
 
 }
@@ -16,18 +16,37 @@ public:
 
 	virtual ~TextureGL();
 
+	// bind to the active unit. Bindings are tracked and binding
+	// the bound texture again is skipped
 	void Bind();
 	void Unbind();
 
+	static void SetActiveUnit(Uint32 unit);
+	// forget the tracked bindings after GL state was restored
+	// without going through here (glPopAttrib)
+	static void InvalidateBindings();
+	// binds and unit changes since the last call
+	static Uint32 TakeNumBinds();
+
 	virtual void SetSampleMode(TextureSampleMode);
+	virtual void Reallocate(const TextureDescriptor &descriptor);
 	GLuint GetTexture() const { return m_texture; }
 
 private:
 	friend class RendererGL2;
 	TextureGL(const TextureDescriptor &descriptor, const bool useCompressed);
+	void Allocate(const TextureDescriptor &descriptor);
 
 	GLenum m_target;
 	GLuint m_texture;
+	bool m_useCompressed;
+
+	enum { MAX_TEXTURE_UNITS = 8 };
+	// bound 2D and cube map texture of each unit
+	static GLuint s_bound[MAX_TEXTURE_UNITS][2];
+	static Uint32 s_activeUnit;
+	static Uint32 s_numBinds;
+	GLuint &BoundSlot() const { return s_bound[s_activeUnit][m_target == GL_TEXTURE_2D ? 0 : 1]; }
 };
 
 }
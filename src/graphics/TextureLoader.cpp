@@ -0,0 +1,118 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "TextureLoader.h"
+#include "TextureBuilder.h"
+#include "TextureCache.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "FileSystem.h"
+#include "utils.h"
+
+// about a 1024x1024 RGBA image with its mipmaps
+static const Uint32 DEFAULT_UPLOAD_BUDGET = 6 * 1024 * 1024;
+
+namespace Graphics {
+
+// Only OnRun is called on the worker
+class TextureLoader::DecodeJob : public Job {
+public:
+	DecodeJob(TextureLoader *loader, Texture *texture, const TextureBuilder &builder, FileSystem::FileData *data,
+			const std::string &cacheKey, FileSystem::FileData *cacheEntry) :
+		m_loader(loader), m_texture(texture), m_builder(new TextureBuilder(builder)), m_data(data),
+		m_cacheKey(cacheKey), m_cacheEntry(cacheEntry) {}
+
+	virtual void OnRun() {
+		if (m_data)
+			m_builder->PrepareFromData(*m_data, m_cacheKey, m_cacheEntry.Get());
+	}
+
+	virtual void OnFinish() {
+		m_loader->OnDecoded(m_texture, std::move(m_builder));
+	}
+
+private:
+	TextureLoader *m_loader;
+	Texture *m_texture;
+	std::unique_ptr<TextureBuilder> m_builder;
+	RefCountedPtr<FileSystem::FileData> m_data;
+	std::string m_cacheKey;
+	RefCountedPtr<FileSystem::FileData> m_cacheEntry;
+};
+
+TextureLoader::TextureLoader(Renderer *r, JobQueue *jobs) :
+	m_renderer(r),
+	m_jobs(jobs),
+	m_uploadBudget(DEFAULT_UPLOAD_BUDGET)
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+	// m_jobs cancels the jobs still queued or running, their
+	// textures just keep the placeholder
+}
+
+Texture *TextureLoader::Load(const TextureBuilder &builder, const std::string &type, const Color &placeholder)
+{
+	PROFILE_SCOPED()
+	const std::string &filename = builder.GetFilename();
+	Texture *t = m_renderer->GetCachedTexture(type, filename);
+	if (t) return t;
+
+	// same sampling as the real texture so nothing changes when it arrives
+	t = m_renderer->CreateTexture(TextureDescriptor(TEXTURE_RGBA_8888, vector2f(1.0f), builder.GetSampleMode(), false, false));
+	t->Update(&placeholder, vector2f(1.0f), TEXTURE_RGBA_8888);
+	m_renderer->AddCachedTexture(type, filename, t);
+
+	// a missing file is left to the synchronous fallback in Update
+	RefCountedPtr<FileSystem::FileData> data = FileSystem::gameDataFiles.ReadFile(filename);
+	std::string cacheKey;
+	RefCountedPtr<FileSystem::FileData> cacheEntry;
+	if (data) {
+		cacheKey = builder.GetCacheKey(*data);
+		if (!cacheKey.empty())
+			cacheEntry = TextureCache::ReadEntry(cacheKey);
+	}
+	m_decoding[t].Reset(t);
+	m_jobs.Order(new DecodeJob(this, t, builder, data.Get(), cacheKey, cacheEntry.Get()));
+
+	return t;
+}
+
+void TextureLoader::OnDecoded(Texture *texture, std::unique_ptr<TextureBuilder> builder)
+{
+	std::map<Texture*, RefCountedPtr<Texture> >::iterator it = m_decoding.find(texture);
+	assert(it != m_decoding.end());
+
+	// a cache miss the worker encoded, written here as only the main
+	// thread may use the file sources
+	builder->StoreCompressed();
+
+	Upload upload;
+	upload.texture = it->second;
+	upload.builder = std::move(builder);
+	m_uploads.push_back(std::move(upload));
+	m_decoding.erase(it);
+}
+
+void TextureLoader::Update()
+{
+	PROFILE_SCOPED()
+	Uint32 uploaded = 0;
+	while (!m_uploads.empty() && uploaded < m_uploadBudget) {
+		Upload &upload = m_uploads.front();
+
+		// if decoding failed GetDescriptor loads the file here,
+		// falling back to the unknown texture
+		if (!upload.builder->IsPrepared())
+			Output("TextureLoader: %s: decoding failed, loading synchronously\n", upload.builder->GetFilename().c_str());
+		upload.texture->Reallocate(upload.builder->GetDescriptor());
+		upload.builder->UpdateTexture(upload.texture.Get());
+		uploaded += upload.builder->GetUploadSize();
+
+		m_uploads.pop_front();
+	}
+}
+
+}
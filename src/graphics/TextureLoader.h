@@ -0,0 +1,65 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _TEXTURELOADER_H
+#define _TEXTURELOADER_H
+
+#include "libs.h"
+#include "JobQueue.h"
+#include "Texture.h"
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace Graphics {
+
+class Renderer;
+class TextureBuilder;
+
+// Loads image textures without stalling the main thread. Load() returns a
+// texture right away that shows a 1x1 placeholder colour. The file and its
+// compressed texture cache entry are read on the main thread (the file
+// sources are not thread safe), then decoded, converted and mipmapped on a
+// job worker. Update() uploads the finished images into the placeholder
+// textures, stopping once the frame's byte budget is spent, so a model with
+// many large textures is spread over several frames instead of hitching.
+class TextureLoader {
+public:
+	TextureLoader(Renderer *r, JobQueue *jobs);
+	~TextureLoader();
+
+	// the texture is cached in the renderer under type and the builder's filename
+	Texture *Load(const TextureBuilder &builder, const std::string &type, const Color &placeholder);
+
+	// call once per frame, after JobQueue::FinishJobs
+	void Update();
+
+	// at least one texture is uploaded per frame, even if it is larger
+	void SetUploadBudget(Uint32 bytesPerFrame) { m_uploadBudget = bytesPerFrame; }
+
+	// textures still being decoded or waiting for upload
+	Uint32 GetNumPending() const { return Uint32(m_decoding.size() + m_uploads.size()); }
+
+private:
+	class DecodeJob;
+
+	struct Upload {
+		RefCountedPtr<Texture> texture;
+		std::unique_ptr<TextureBuilder> builder;
+	};
+
+	void OnDecoded(Texture *texture, std::unique_ptr<TextureBuilder> builder);
+
+	Renderer *m_renderer;
+	JobSet m_jobs;
+	std::deque<Upload> m_uploads;
+	Uint32 m_uploadBudget;
+	// textures being decoded. the references are held here rather than in
+	// the jobs, a cancelled job may only be deleted after the renderer
+	std::map<Texture*, RefCountedPtr<Texture> > m_decoding;
+};
+
+}
+
+#endif
@@ -42,8 +42,22 @@ bool WindowSDL::CreateWindowAndContext(const char *name, int w, int h, bool full
 	return true;
 }
 
+// for the dummy renderer: a hidden window without a GL context, which also
+// works with SDL's dummy video driver on machines without a display
+bool WindowSDL::CreateHeadlessWindow(const char *name, int w, int h) {
+	m_glContext = 0;
+	m_window = SDL_CreateWindow(name, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, w, h, SDL_WINDOW_HIDDEN);
+	return m_window != 0;
+}
+
 WindowSDL::WindowSDL(const Graphics::Settings &vs, const std::string &name)
 {
+	if (vs.rendererType == RENDERER_DUMMY) {
+		if (!CreateHeadlessWindow(name.c_str(), vs.width, vs.height))
+			Error("Failed to create window: %s", SDL_GetError());
+		return;
+	}
+
 	bool ok;
 
 	// attempt sequence is:
@@ -84,7 +98,8 @@ WindowSDL::WindowSDL(const Graphics::Settings &vs, const std::string &name)
 
 WindowSDL::~WindowSDL()
 {
-	SDL_GL_DeleteContext(m_glContext);
+	if (m_glContext)
+		SDL_GL_DeleteContext(m_glContext);
 	SDL_DestroyWindow(m_window);
 }
 
@@ -110,7 +125,8 @@ void WindowSDL::SetGrab(bool grabbed)
 
 void WindowSDL::SwapBuffers()
 {
-	SDL_GL_SwapWindow(m_window);
+	if (m_glContext)
+		SDL_GL_SwapWindow(m_window);
 }
 
 }
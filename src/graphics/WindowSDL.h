@@ -22,6 +22,7 @@ public:
 
 private:
 	bool CreateWindowAndContext(const char *name, int w, int h, bool fullscreen, int samples, int depth_bits);
+	bool CreateHeadlessWindow(const char *name, int w, int h);
 
 	SDL_Window *m_window;
 	SDL_GLContext m_glContext;
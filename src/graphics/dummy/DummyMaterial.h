@@ -0,0 +1,24 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef DUMMY_MATERIAL_H
+#define DUMMY_MATERIAL_H
+
+#include "graphics/Material.h"
+#include "graphics/Stats.h"
+
+namespace Graphics { namespace Dummy {
+
+class Material : public Graphics::Material {
+public:
+	Material(const MaterialDescriptor &desc, Stats &stats) : m_stats(stats) { m_descriptor = desc; }
+
+	virtual void Apply() override { m_stats.Add(Stats::STAT_MATERIAL_APPLIES); }
+
+private:
+	Stats &m_stats;
+};
+
+} }
+
+#endif
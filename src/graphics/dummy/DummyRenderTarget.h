@@ -0,0 +1,27 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef DUMMY_RENDERTARGET_H
+#define DUMMY_RENDERTARGET_H
+
+#include "graphics/RenderTarget.h"
+
+namespace Graphics { namespace Dummy {
+
+class RenderTarget : public Graphics::RenderTarget {
+public:
+	RenderTarget(const RenderTargetDesc &d) : Graphics::RenderTarget(d) {}
+
+	virtual Texture *GetColorTexture() const override { return m_colorTexture.Get(); }
+	virtual Texture *GetDepthTexture() const override { return m_depthTexture.Get(); }
+	virtual void SetColorTexture(Texture *t) override { m_colorTexture.Reset(t); }
+	virtual void SetDepthTexture(Texture *t) override { assert(GetDesc().allowDepthTexture); m_depthTexture.Reset(t); }
+
+private:
+	RefCountedPtr<Texture> m_colorTexture;
+	RefCountedPtr<Texture> m_depthTexture;
+};
+
+} }
+
+#endif
@@ -0,0 +1,56 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef DUMMY_TEXTURE_H
+#define DUMMY_TEXTURE_H
+
+#include "graphics/Texture.h"
+#include "graphics/Stats.h"
+
+namespace Graphics { namespace Dummy {
+
+// Keeps no pixels, only counts the bytes that would have been uploaded
+class Texture : public Graphics::Texture {
+public:
+	Texture(const TextureDescriptor &descriptor, Stats &stats) : Graphics::Texture(descriptor), m_stats(stats) {}
+
+	virtual void Update(const void *data, const vector2f &pos, const vector2f &dataSize, TextureFormat format, const unsigned int numMips) override {
+		m_stats.Add(Stats::STAT_TEXTURE_BYTES, GetDataSize(dataSize, format, numMips));
+	}
+	virtual void Update(const TextureCubeData &data, const vector2f &dataSize, TextureFormat format, const unsigned int numMips) override {
+		m_stats.Add(Stats::STAT_TEXTURE_BYTES, 6 * GetDataSize(dataSize, format, numMips));
+	}
+	virtual void SetSampleMode(TextureSampleMode) override {}
+
+	// bytes in an image and its mipmaps
+	static Uint64 GetDataSize(const vector2f &dataSize, TextureFormat format, unsigned int numMips) {
+		Uint64 total = 0;
+		Uint32 width = Uint32(dataSize.x), height = Uint32(dataSize.y);
+		for (unsigned int i = 0; i < std::max(numMips, 1U); i++) {
+			switch (format) {
+				case TEXTURE_DXT1:
+				case TEXTURE_SRGB_DXT1: total += ((width + 3) / 4) * ((height + 3) / 4) * 8; break;
+				case TEXTURE_DXT5:
+				case TEXTURE_SRGB_DXT5: total += ((width + 3) / 4) * ((height + 3) / 4) * 16; break;
+				case TEXTURE_RGBA_8888:
+				case TEXTURE_SRGBA_8888:
+				case TEXTURE_DEPTH: total += width * height * 4; break;
+				case TEXTURE_RGB_888:
+				case TEXTURE_SRGB_888: total += width * height * 3; break;
+				case TEXTURE_LUMINANCE_ALPHA_88: total += width * height * 2; break;
+				case TEXTURE_INTENSITY_8: total += width * height; break;
+				default: break;
+			}
+			width = std::max(width / 2, 1U);
+			height = std::max(height / 2, 1U);
+		}
+		return total;
+	}
+
+private:
+	Stats &m_stats;
+};
+
+} }
+
+#endif
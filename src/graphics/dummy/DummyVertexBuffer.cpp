@@ -0,0 +1,83 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "graphics/dummy/DummyVertexBuffer.h"
+
+namespace Graphics { namespace Dummy {
+
+VertexBuffer::VertexBuffer(const VertexBufferDesc &desc, Stats &stats, const void *data) : m_stats(stats)
+{
+	m_desc = desc;
+	// same layout as GL2 buffers, so byte counts compare
+	for (Uint32 i = 0; i < MAX_ATTRIBS; i++) {
+		if (m_desc.attrib[i].offset == 0)
+			m_desc.attrib[i].offset = VertexBufferDesc::CalculateOffset(m_desc, m_desc.attrib[i].semantic);
+	}
+
+	if (m_desc.stride == 0) {
+		Uint32 lastAttrib = 0;
+		while (lastAttrib < MAX_ATTRIBS) {
+			if (m_desc.attrib[lastAttrib].semantic == ATTRIB_NONE)
+				break;
+			lastAttrib++;
+		}
+
+		m_desc.stride = m_desc.attrib[lastAttrib].offset + VertexBufferDesc::GetAttribSize(m_desc.attrib[lastAttrib].format);
+	}
+	assert(m_desc.stride > 0);
+	assert(m_desc.numVertices > 0);
+
+	SetVertexCount(m_desc.numVertices);
+
+	m_data.resize(m_desc.numVertices * m_desc.stride, 0);
+	if (data)
+		memcpy(&m_data[0], data, m_data.size());
+	m_stats.Add(Stats::STAT_CREATED_VERTEXBUFFERS);
+	m_stats.Add(Stats::STAT_VERTEXBUFFER_BYTES, m_data.size());
+}
+
+Uint8 *VertexBuffer::MapInternal(BufferMapMode mode)
+{
+	assert(mode != BUFFER_MAP_NONE); //makes no sense
+	assert(m_mapMode == BUFFER_MAP_NONE); //must not be currently mapped
+	m_mapMode = mode;
+	return &m_data[0];
+}
+
+void VertexBuffer::Unmap()
+{
+	assert(m_mapMode != BUFFER_MAP_NONE); //not currently mapped
+	if (m_mapMode == BUFFER_MAP_WRITE)
+		m_stats.Add(Stats::STAT_VERTEXBUFFER_BYTES, m_data.size());
+	m_mapMode = BUFFER_MAP_NONE;
+}
+
+IndexBuffer::IndexBuffer(Uint32 size, BufferUsage usage, Stats &stats, const Uint16 *data)
+	: Graphics::IndexBuffer(size, usage)
+	, m_data(size, 0)
+	, m_stats(stats)
+{
+	assert(size > 0);
+	if (data)
+		memcpy(&m_data[0], data, sizeof(Uint16) * size);
+	m_stats.Add(Stats::STAT_CREATED_INDEXBUFFERS);
+	m_stats.Add(Stats::STAT_INDEXBUFFER_BYTES, sizeof(Uint16) * m_size);
+}
+
+Uint16 *IndexBuffer::Map(BufferMapMode mode)
+{
+	assert(mode != BUFFER_MAP_NONE); //makes no sense
+	assert(m_mapMode == BUFFER_MAP_NONE); //must not be currently mapped
+	m_mapMode = mode;
+	return &m_data[0];
+}
+
+void IndexBuffer::Unmap()
+{
+	assert(m_mapMode != BUFFER_MAP_NONE); //not currently mapped
+	if (m_mapMode == BUFFER_MAP_WRITE)
+		m_stats.Add(Stats::STAT_INDEXBUFFER_BYTES, sizeof(Uint16) * m_size);
+	m_mapMode = BUFFER_MAP_NONE;
+}
+
+} }
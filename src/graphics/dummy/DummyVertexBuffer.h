@@ -0,0 +1,44 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef DUMMY_VERTEXBUFFER_H
+#define DUMMY_VERTEXBUFFER_H
+
+#include "graphics/VertexBuffer.h"
+#include "graphics/Stats.h"
+#include <vector>
+
+namespace Graphics { namespace Dummy {
+
+// Buffers live in client memory, so they can be mapped for reading and
+// writing like GL2 ones. Unmapping after a write counts the whole buffer as
+// uploaded, as GL2 does.
+class VertexBuffer : public Graphics::VertexBuffer {
+public:
+	VertexBuffer(const VertexBufferDesc &desc, Stats &stats, const void *data = nullptr);
+
+	virtual void Unmap() override;
+
+protected:
+	virtual Uint8 *MapInternal(BufferMapMode) override;
+
+private:
+	std::vector<Uint8> m_data;
+	Stats &m_stats;
+};
+
+class IndexBuffer : public Graphics::IndexBuffer {
+public:
+	IndexBuffer(Uint32 size, BufferUsage usage, Stats &stats, const Uint16 *data = nullptr);
+
+	virtual Uint16 *Map(BufferMapMode) override;
+	virtual void Unmap() override;
+
+private:
+	std::vector<Uint16> m_data;
+	Stats &m_stats;
+};
+
+} }
+
+#endif
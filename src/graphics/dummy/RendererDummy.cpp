@@ -0,0 +1,354 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "graphics/dummy/RendererDummy.h"
+#include "graphics/Graphics.h"
+#include "graphics/Light.h"
+#include "graphics/VertexArray.h"
+#include "graphics/dummy/DummyMaterial.h"
+#include "graphics/dummy/DummyRenderState.h"
+#include "graphics/dummy/DummyRenderTarget.h"
+#include "graphics/dummy/DummyTexture.h"
+#include "graphics/dummy/DummyVertexBuffer.h"
+#include <ostream>
+
+namespace Graphics {
+
+RendererDummy::RendererDummy(WindowSDL *window, const Graphics::Settings &vs)
+: Renderer(window, window->GetWidth(), window->GetHeight())
+, m_numDirLights(0)
+, m_activeRenderState(nullptr)
+, m_activeRenderTarget(nullptr)
+, m_matrixMode(MatrixMode::MODELVIEW)
+{
+	m_viewportStack.push(Viewport());
+	m_modelViewStack.push(matrix4x4f::Identity());
+	m_projectionStack.push(matrix4x4f::Identity());
+
+	SetViewport(0, 0, m_width, m_height);
+}
+
+RendererDummy::~RendererDummy()
+{
+	for (auto it = m_renderStates.begin(); it != m_renderStates.end(); ++it)
+		delete it->second;
+}
+
+bool RendererDummy::GetNearFarRange(float &near, float &far) const
+{
+	// same as GL2, so camera setup doesn't change
+	near = 0.0001f;
+	far = 10000000.0f;
+	return true;
+}
+
+bool RendererDummy::SwapBuffers()
+{
+	m_stats.NextFrame();
+	return true;
+}
+
+bool RendererDummy::SetRenderState(RenderState *rs)
+{
+	if (m_activeRenderState != rs) {
+		m_activeRenderState = rs;
+		m_stats.Add(Stats::STAT_RENDERSTATE_CHANGES);
+	}
+	return true;
+}
+
+bool RendererDummy::SetRenderTarget(RenderTarget *rt)
+{
+	if (m_activeRenderTarget != rt) {
+		m_activeRenderTarget = rt;
+		m_stats.Add(Stats::STAT_RENDERTARGET_CHANGES);
+	}
+	return true;
+}
+
+bool RendererDummy::ClearScreen()
+{
+	m_activeRenderState = nullptr;
+	m_stats.Add(Stats::STAT_CLEARS);
+	return true;
+}
+
+bool RendererDummy::ClearDepthBuffer()
+{
+	m_activeRenderState = nullptr;
+	m_stats.Add(Stats::STAT_CLEARS);
+	return true;
+}
+
+bool RendererDummy::SetViewport(int x, int y, int width, int height)
+{
+	assert(!m_viewportStack.empty());
+	Viewport& currentViewport = m_viewportStack.top();
+	currentViewport.x = x;
+	currentViewport.y = y;
+	currentViewport.w = width;
+	currentViewport.h = height;
+	return true;
+}
+
+bool RendererDummy::SetTransform(const matrix4x4d &m)
+{
+	matrix4x4f mf;
+	matrix4x4dtof(m, mf);
+	return SetTransform(mf);
+}
+
+bool RendererDummy::SetTransform(const matrix4x4f &m)
+{
+	m_modelViewStack.top() = m;
+	m_matrixMode = MatrixMode::MODELVIEW;
+	m_stats.Add(Stats::STAT_TRANSFORM_CHANGES);
+	return true;
+}
+
+bool RendererDummy::SetPerspectiveProjection(float fov, float aspect, float near, float far)
+{
+	Graphics::SetFov(fov);
+
+	float ymax = near * tan(fov * M_PI / 360.0);
+	float ymin = -ymax;
+	float xmin = ymin * aspect;
+	float xmax = ymax * aspect;
+
+	return SetProjection(matrix4x4f::FrustumMatrix(xmin, xmax, ymin, ymax, near, far));
+}
+
+bool RendererDummy::SetOrthographicProjection(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax)
+{
+	return SetProjection(matrix4x4f::OrthoFrustum(xmin, xmax, ymin, ymax, zmin, zmax));
+}
+
+bool RendererDummy::SetProjection(const matrix4x4f &m)
+{
+	m_projectionStack.top() = m;
+	m_matrixMode = MatrixMode::PROJECTION;
+	m_stats.Add(Stats::STAT_TRANSFORM_CHANGES);
+	return true;
+}
+
+bool RendererDummy::SetLights(int numlights, const Light *lights)
+{
+	if (numlights < 1) return false;
+
+	m_numDirLights = 0;
+	for (int i = 0; i < numlights; i++) {
+		if (lights[i].GetType() == Light::LIGHT_DIRECTIONAL)
+			m_numDirLights++;
+	}
+	assert(m_numDirLights < 5);
+
+	return true;
+}
+
+void RendererDummy::Draw(RenderState *rs, Material *mat, Uint32 vertices, Uint64 immediateBytes)
+{
+	SetRenderState(rs);
+	if (mat)
+		mat->Apply();
+	m_stats.Add(Stats::STAT_DRAWCALLS);
+	m_stats.Add(Stats::STAT_VERTICES, vertices);
+	m_stats.Add(Stats::STAT_IMMEDIATE_BYTES, immediateBytes);
+}
+
+bool RendererDummy::DrawLines(int count, const vector3f *v, const Color *c, RenderState *state, LineType t)
+{
+	if (count < 2 || !v) return false;
+	Draw(state, nullptr, count, count * (sizeof(vector3f) + sizeof(Color)));
+	return true;
+}
+
+bool RendererDummy::DrawLines(int count, const vector3f *v, const Color &c, RenderState *state, LineType t)
+{
+	if (count < 2 || !v) return false;
+	Draw(state, nullptr, count, count * sizeof(vector3f));
+	return true;
+}
+
+bool RendererDummy::DrawLines2D(int count, const vector2f *v, const Color &c, RenderState *state, LineType t)
+{
+	if (count < 2 || !v) return false;
+	Draw(state, nullptr, count, count * sizeof(vector2f));
+	return true;
+}
+
+bool RendererDummy::DrawPoints(int count, const vector3f *points, const Color *colors, RenderState *state, float size)
+{
+	if (count < 1 || !points || !colors) return false;
+	Draw(state, nullptr, count, count * (sizeof(vector3f) + sizeof(Color)));
+	return true;
+}
+
+bool RendererDummy::DrawTriangles(const VertexArray *v, RenderState *rs, Material *m, PrimitiveType t)
+{
+	if (!v || v->position.size() < 3) return false;
+
+	const Uint64 bytes =
+		v->position.size() * sizeof(vector3f) +
+		v->normal.size() * sizeof(vector3f) +
+		v->diffuse.size() * sizeof(Color) +
+		v->uv0.size() * sizeof(vector2f);
+	Draw(rs, m, v->GetNumVerts(), bytes);
+	return true;
+}
+
+bool RendererDummy::DrawPointSprites(int count, const vector3f *positions, RenderState *rs, Material *material, float size)
+{
+	if (count < 1 || !material || !material->texture0) return false;
+
+	// GL2 draws each sprite as two textured triangles
+	Draw(rs, material, count * 6, count * 6 * (sizeof(vector3f) + sizeof(vector2f)));
+	return true;
+}
+
+bool RendererDummy::DrawBuffer(VertexBuffer *vb, RenderState *state, Material *mat, PrimitiveType pt)
+{
+	Draw(state, mat, vb->GetVertexCount(), 0);
+	return true;
+}
+
+bool RendererDummy::DrawBufferIndexed(VertexBuffer *vb, IndexBuffer *ib, RenderState *state, Material *mat, PrimitiveType pt)
+{
+	Draw(state, mat, ib->GetIndexCount(), 0);
+	return true;
+}
+
+Material *RendererDummy::CreateMaterial(const MaterialDescriptor &d)
+{
+	MaterialDescriptor desc = d;
+	if (desc.lighting)
+		desc.dirLights = m_numDirLights;
+
+	m_stats.Add(Stats::STAT_CREATED_MATERIALS);
+	return new Dummy::Material(desc, m_stats);
+}
+
+Texture *RendererDummy::CreateTexture(const TextureDescriptor &descriptor)
+{
+	m_stats.Add(Stats::STAT_CREATED_TEXTURES);
+	return new Dummy::Texture(descriptor, m_stats);
+}
+
+RenderState *RendererDummy::CreateRenderState(const RenderStateDesc &desc)
+{
+	const uint32_t hash = lookup3_hashlittle(&desc, sizeof(RenderStateDesc), 0);
+	auto it = m_renderStates.find(hash);
+	if (it != m_renderStates.end())
+		return it->second;
+	else {
+		auto *rs = new Dummy::RenderState(desc);
+		m_renderStates[hash] = rs;
+		return rs;
+	}
+}
+
+RenderTarget *RendererDummy::CreateRenderTarget(const RenderTargetDesc &desc)
+{
+	Dummy::RenderTarget *rt = new Dummy::RenderTarget(desc);
+	if (desc.colorFormat != TEXTURE_NONE) {
+		Graphics::TextureDescriptor cdesc(
+			desc.colorFormat,
+			vector2f(desc.width, desc.height),
+			vector2f(desc.width, desc.height),
+			LINEAR_CLAMP,
+			false,
+			false);
+		rt->SetColorTexture(CreateTexture(cdesc));
+	}
+	if (desc.depthFormat != TEXTURE_NONE && desc.allowDepthTexture) {
+		Graphics::TextureDescriptor ddesc(
+			TEXTURE_DEPTH,
+			vector2f(desc.width, desc.height),
+			vector2f(desc.width, desc.height),
+			LINEAR_CLAMP,
+			false,
+			false);
+		rt->SetDepthTexture(CreateTexture(ddesc));
+	}
+	m_stats.Add(Stats::STAT_CREATED_RENDERTARGETS);
+	return rt;
+}
+
+VertexBuffer *RendererDummy::CreateVertexBuffer(const VertexBufferDesc &desc, const void *data)
+{
+	return new Dummy::VertexBuffer(desc, m_stats, data);
+}
+
+IndexBuffer *RendererDummy::CreateIndexBuffer(Uint32 size, BufferUsage usage, const Uint16 *data)
+{
+	return new Dummy::IndexBuffer(size, usage, m_stats, data);
+}
+
+void RendererDummy::PushState()
+{
+	m_projectionStack.push(m_projectionStack.top());
+	m_modelViewStack.push(m_modelViewStack.top());
+	m_viewportStack.push(m_viewportStack.top());
+}
+
+void RendererDummy::PopState()
+{
+	m_viewportStack.pop();
+	assert(!m_viewportStack.empty());
+	m_projectionStack.pop();
+	assert(!m_projectionStack.empty());
+	m_modelViewStack.pop();
+	assert(!m_modelViewStack.empty());
+}
+
+bool RendererDummy::PrintDebugInfo(std::ostream &out)
+{
+	out << "Dummy renderer, nothing is drawn\n";
+	m_stats.Print(out);
+	return true;
+}
+
+matrix4x4f &RendererDummy::CurrentMatrix()
+{
+	return (m_matrixMode == MatrixMode::MODELVIEW) ? m_modelViewStack.top() : m_projectionStack.top();
+}
+
+void RendererDummy::PushMatrix()
+{
+	if (m_matrixMode == MatrixMode::MODELVIEW)
+		m_modelViewStack.push(m_modelViewStack.top());
+	else
+		m_projectionStack.push(m_projectionStack.top());
+}
+
+void RendererDummy::PopMatrix()
+{
+	if (m_matrixMode == MatrixMode::MODELVIEW) {
+		m_modelViewStack.pop();
+		assert(m_modelViewStack.size());
+	} else {
+		m_projectionStack.pop();
+		assert(m_projectionStack.size());
+	}
+}
+
+void RendererDummy::LoadIdentity()
+{
+	CurrentMatrix() = matrix4x4f::Identity();
+}
+
+void RendererDummy::LoadMatrix(const matrix4x4f &m)
+{
+	CurrentMatrix() = m;
+}
+
+void RendererDummy::Translate( const float x, const float y, const float z )
+{
+	CurrentMatrix().Translate(x,y,z);
+}
+
+void RendererDummy::Scale( const float x, const float y, const float z )
+{
+	CurrentMatrix().Scale(x,y,z);
+}
+
+}
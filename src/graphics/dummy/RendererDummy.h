@@ -0,0 +1,117 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _RENDERER_DUMMY_H
+#define _RENDERER_DUMMY_H
+/*
+ * Renderer that draws nothing. Every call is counted in the renderer's Stats
+ * instead (draw calls, vertices, state changes, bytes put into buffers and
+ * textures), so the CPU side of rendering can be run and measured on machines
+ * without a GPU. Matrices and viewports are tracked like GL2 does, so code
+ * that reads them back behaves the same.
+ */
+#include "graphics/Renderer.h"
+#include <stack>
+#include <unordered_map>
+
+namespace Graphics {
+
+struct Settings;
+
+class RendererDummy : public Renderer
+{
+public:
+	RendererDummy(WindowSDL *window, const Graphics::Settings &vs);
+	virtual ~RendererDummy();
+
+	virtual const char* GetName() const override { return "Dummy renderer"; }
+	virtual bool GetNearFarRange(float &near, float &far) const override;
+
+	virtual bool BeginFrame() override { return true; }
+	virtual bool EndFrame() override { return true; }
+	virtual bool SwapBuffers() override;
+
+	virtual bool SetRenderState(RenderState*) override;
+	virtual bool SetRenderTarget(RenderTarget*) override;
+
+	virtual bool ClearScreen() override;
+	virtual bool ClearDepthBuffer() override;
+	virtual bool SetClearColor(const Color &c) override { return true; }
+
+	virtual bool SetViewport(int x, int y, int width, int height) override;
+
+	virtual bool SetTransform(const matrix4x4d &m) override;
+	virtual bool SetTransform(const matrix4x4f &m) override;
+	virtual bool SetPerspectiveProjection(float fov, float aspect, float near, float far) override;
+	virtual bool SetOrthographicProjection(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax) override;
+	virtual bool SetProjection(const matrix4x4f &m) override;
+
+	virtual bool SetWireFrameMode(bool enabled) override { return true; }
+
+	virtual bool SetLights(int numlights, const Light *l) override;
+	virtual bool SetAmbientColor(const Color &c) override { m_ambient = c; return true; }
+
+	virtual bool SetScissor(bool enabled, const vector2f &pos = vector2f(0.0f), const vector2f &size = vector2f(0.0f)) override { return true; }
+
+	virtual bool DrawLines(int vertCount, const vector3f *vertices, const Color *colors, RenderState*, LineType type=LINE_SINGLE) override;
+	virtual bool DrawLines(int vertCount, const vector3f *vertices, const Color &color, RenderState*, LineType type=LINE_SINGLE) override;
+	virtual bool DrawLines2D(int vertCount, const vector2f *vertices, const Color &color, RenderState*, LineType type=LINE_SINGLE) override;
+	virtual bool DrawPoints(int count, const vector3f *points, const Color *colors, RenderState*, float pointSize=1.f) override;
+	virtual bool DrawTriangles(const VertexArray *vertices, RenderState *state, Material *material, PrimitiveType type=TRIANGLES) override;
+	virtual bool DrawPointSprites(int count, const vector3f *positions, RenderState *rs, Material *material, float size) override;
+	virtual bool DrawBuffer(VertexBuffer*, RenderState*, Material*, PrimitiveType) override;
+	virtual bool DrawBufferIndexed(VertexBuffer*, IndexBuffer*, RenderState*, Material*, PrimitiveType) override;
+
+	virtual Material *CreateMaterial(const MaterialDescriptor &descriptor) override;
+	virtual Texture *CreateTexture(const TextureDescriptor &descriptor) override;
+	virtual RenderState *CreateRenderState(const RenderStateDesc &) override;
+	virtual RenderTarget *CreateRenderTarget(const RenderTargetDesc &) override;
+	virtual VertexBuffer *CreateVertexBuffer(const VertexBufferDesc&, const void *data = nullptr) override;
+	virtual IndexBuffer *CreateIndexBuffer(Uint32 size, BufferUsage, const Uint16 *data = nullptr) override;
+
+	virtual bool ReloadShaders() override { return true; }
+
+	virtual bool PrintDebugInfo(std::ostream &out) override;
+
+	virtual const matrix4x4f& GetCurrentModelView() const override { return m_modelViewStack.top(); }
+	virtual const matrix4x4f& GetCurrentProjection() const override { return m_projectionStack.top(); }
+	virtual void GetCurrentViewport(Sint32 *vp) const override {
+		const Viewport &cur = m_viewportStack.top();
+		vp[0] = cur.x; vp[1] = cur.y; vp[2] = cur.w; vp[3] = cur.h;
+	}
+
+	virtual void SetMatrixMode(MatrixMode mm) override { m_matrixMode = mm; }
+	virtual void PushMatrix() override;
+	virtual void PopMatrix() override;
+	virtual void LoadIdentity() override;
+	virtual void LoadMatrix(const matrix4x4f &m) override;
+	virtual void Translate( const float x, const float y, const float z ) override;
+	virtual void Scale( const float x, const float y, const float z ) override;
+
+protected:
+	virtual void PushState() override;
+	virtual void PopState() override;
+
+private:
+	matrix4x4f &CurrentMatrix();
+	void Draw(RenderState *rs, Material *mat, Uint32 vertices, Uint64 immediateBytes);
+
+	int m_numDirLights;
+	std::unordered_map<Uint32, RenderState*> m_renderStates;
+	RenderState *m_activeRenderState;
+	RenderTarget *m_activeRenderTarget;
+
+	MatrixMode m_matrixMode;
+	std::stack<matrix4x4f> m_modelViewStack;
+	std::stack<matrix4x4f> m_projectionStack;
+
+	struct Viewport {
+		Viewport() : x(0), y(0), w(0), h(0) {}
+		Sint32 x, y, w, h;
+	};
+	std::stack<Viewport> m_viewportStack;
+};
+
+}
+
+#endif
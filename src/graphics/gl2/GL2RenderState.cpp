@@ -14,9 +14,9 @@ RenderState::RenderState(const RenderStateDesc &d)
 {
 }
 
-void RenderState::Apply()
+static void apply_blend(BlendMode mode)
 {
-	switch (m_desc.blendMode) {
+	switch (mode) {
 	case BLEND_SOLID:
 		glDisable(GL_BLEND);
 		glBlendFunc(GL_ONE, GL_ZERO);
@@ -47,27 +47,40 @@ void RenderState::Apply()
 	default:
 		break;
 	}
+}
 
-	if (m_desc.cullMode == CULL_BACK) {
+static void apply_cull(FaceCullMode mode)
+{
+	if (mode == CULL_BACK) {
 		glEnable(GL_CULL_FACE);
 		glCullFace(GL_BACK);
-	} else if (m_desc.cullMode == CULL_FRONT) {
+	} else if (mode == CULL_FRONT) {
 		glEnable(GL_CULL_FACE);
 		glCullFace(GL_FRONT);
 	} else {
 		glDisable(GL_CULL_FACE);
 	}
+}
 
+void RenderState::Apply(const RenderState *prevState)
+{
+	const RenderStateDesc *prev = prevState ? &prevState->m_desc : nullptr;
 
-	if (m_desc.depthTest)
-		glEnable(GL_DEPTH_TEST);
-	else
-		glDisable(GL_DEPTH_TEST);
+	if (!prev || prev->blendMode != m_desc.blendMode)
+		apply_blend(m_desc.blendMode);
+
+	if (!prev || prev->cullMode != m_desc.cullMode)
+		apply_cull(m_desc.cullMode);
+
+	if (!prev || prev->depthTest != m_desc.depthTest) {
+		if (m_desc.depthTest)
+			glEnable(GL_DEPTH_TEST);
+		else
+			glDisable(GL_DEPTH_TEST);
+	}
 
-	if (m_desc.depthWrite)
-		glDepthMask(GL_TRUE);
-	else
-		glDepthMask(GL_FALSE);
+	if (!prev || prev->depthWrite != m_desc.depthWrite)
+		glDepthMask(m_desc.depthWrite ? GL_TRUE : GL_FALSE);
 }
 
 }
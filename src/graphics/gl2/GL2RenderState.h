@@ -11,7 +11,8 @@ namespace GL2 {
 class RenderState : public Graphics::RenderState {
 public:
 	RenderState(const RenderStateDesc&);
-	void Apply();
+	// sets only what differs from the state applied before, all of it if null
+	void Apply(const RenderState *prev = nullptr);
 };
 
 }
@@ -0,0 +1,67 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "graphics/gl2/GL2StreamBuffer.h"
+
+namespace Graphics { namespace GL2 {
+
+// attribute arrays start at multiples of this
+static const Uint32 STREAM_ALIGNMENT = 16;
+
+static inline Uint32 align(Uint32 n)
+{
+	return (n + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1);
+}
+
+StreamBuffer::StreamBuffer(Uint32 size)
+	: m_size(size)
+	, m_offset(0)
+	, m_reserved(0)
+	, m_numOrphans(0)
+{
+	glGenBuffers(1, &m_buffer);
+	BindArrayBuffer(m_buffer);
+	glBufferData(GL_ARRAY_BUFFER, m_size, 0, GL_STREAM_DRAW);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	ForgetBinding();
+	glDeleteBuffers(1, &m_buffer);
+}
+
+void StreamBuffer::Begin(Uint32 size)
+{
+	PROFILE_SCOPED()
+	BindArrayBuffer(m_buffer);
+
+	// each append may be padded for alignment
+	size += 4 * STREAM_ALIGNMENT;
+	if (size > m_size) {
+		while (m_size < size)
+			m_size *= 2;
+		Orphan();
+	} else if (align(m_offset) + size > m_size) {
+		Orphan();
+	}
+	m_reserved = align(m_offset) + size;
+}
+
+const GLvoid *StreamBuffer::Append(const void *data, Uint32 size)
+{
+	m_offset = align(m_offset);
+	assert(m_offset + size <= m_reserved);
+	glBufferSubData(GL_ARRAY_BUFFER, m_offset, size, data);
+	const GLvoid *ptr = reinterpret_cast<const GLvoid *>(static_cast<uintptr_t>(m_offset));
+	m_offset += size;
+	return ptr;
+}
+
+void StreamBuffer::Orphan()
+{
+	glBufferData(GL_ARRAY_BUFFER, m_size, 0, GL_STREAM_DRAW);
+	m_offset = 0;
+	++m_numOrphans;
+}
+
+} }
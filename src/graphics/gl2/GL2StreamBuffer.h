@@ -0,0 +1,41 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef GL2_STREAMBUFFER_H
+#define GL2_STREAMBUFFER_H
+#include "graphics/gl2/GL2VertexBuffer.h"
+
+namespace Graphics { namespace GL2 {
+
+// Vertex buffer for data that is drawn once, such as the arrays passed to
+// DrawLines or DrawTriangles. Draws are appended one after another and when
+// the buffer is full its storage is orphaned (respecified without data), so
+// the driver can hand out new memory instead of waiting for the draws still
+// reading the old. GL 2.1 has no fences, orphaning takes their place.
+class StreamBuffer : public GLBufferBase {
+public:
+	StreamBuffer(Uint32 size);
+	~StreamBuffer();
+
+	// binds the buffer and makes room for size bytes, growing it if needed
+	void Begin(Uint32 size);
+	// copies data after the previous append, returns the pointer argument
+	// for gl*Pointer. The buffer must still be bound
+	const GLvoid *Append(const void *data, Uint32 size);
+
+	Uint32 GetSize() const { return m_size; }
+	// orphans since the last call
+	Uint32 TakeNumOrphans() { const Uint32 n = m_numOrphans; m_numOrphans = 0; return n; }
+
+private:
+	void Orphan();
+
+	Uint32 m_size;
+	Uint32 m_offset;
+	Uint32 m_reserved; // end of the space claimed by Begin
+	Uint32 m_numOrphans;
+};
+
+} }
+
+#endif // GL2_STREAMBUFFER_H
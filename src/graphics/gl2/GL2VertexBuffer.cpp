@@ -5,6 +5,44 @@
 
 namespace Graphics { namespace GL2 {
 
+GLuint GLBufferBase::s_arrayBuffer = 0;
+GLuint GLBufferBase::s_elementBuffer = 0;
+Uint32 GLBufferBase::s_numBinds = 0;
+
+//static
+void GLBufferBase::BindArrayBuffer(GLuint buffer)
+{
+	if (s_arrayBuffer != buffer) {
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		s_arrayBuffer = buffer;
+		++s_numBinds;
+	}
+}
+
+//static
+void GLBufferBase::BindElementBuffer(GLuint buffer)
+{
+	if (s_elementBuffer != buffer) {
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+		s_elementBuffer = buffer;
+		++s_numBinds;
+	}
+}
+
+//static
+Uint32 GLBufferBase::TakeNumBinds()
+{
+	const Uint32 n = s_numBinds;
+	s_numBinds = 0;
+	return n;
+}
+
+void GLBufferBase::ForgetBinding()
+{
+	if (s_arrayBuffer == m_buffer) s_arrayBuffer = 0;
+	if (s_elementBuffer == m_buffer) s_elementBuffer = 0;
+}
+
 GLint get_num_components(VertexAttribFormat fmt)
 {
 	switch (fmt) {
@@ -34,7 +72,7 @@ GLenum get_component_type(VertexAttribFormat fmt)
 	}
 }
 
-VertexBuffer::VertexBuffer(const VertexBufferDesc &desc)
+VertexBuffer::VertexBuffer(const VertexBufferDesc &desc, const void *data)
 {
 	m_desc = desc;
 	//update offsets in desc
@@ -64,18 +102,26 @@ VertexBuffer::VertexBuffer(const VertexBufferDesc &desc)
 
 	//Allocate initial data store
 	//Using zeroed m_data is not mandatory, but otherwise contents are undefined
-	glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+	BindArrayBuffer(m_buffer);
 	const Uint32 dataSize = m_desc.numVertices * m_desc.stride;
-	m_data = new Uint8[dataSize];
-	memset(m_data, 0, dataSize);
 	const GLenum usage = (m_desc.usage == BUFFER_USAGE_STATIC) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
-	glBufferData(GL_ARRAY_BUFFER, dataSize, m_data, usage);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	//Don't keep client data around for static buffers
-	if (GetDesc().usage == BUFFER_USAGE_STATIC) {
-		delete[] m_data;
+	if (data && GetDesc().usage == BUFFER_USAGE_STATIC) {
+		//uploaded straight from the caller's memory
 		m_data = nullptr;
+		glBufferData(GL_ARRAY_BUFFER, dataSize, data, usage);
+	} else {
+		m_data = new Uint8[dataSize];
+		if (data)
+			memcpy(m_data, data, dataSize);
+		else
+			memset(m_data, 0, dataSize);
+		glBufferData(GL_ARRAY_BUFFER, dataSize, m_data, usage);
+
+		//Don't keep client data around for static buffers
+		if (GetDesc().usage == BUFFER_USAGE_STATIC) {
+			delete[] m_data;
+			m_data = nullptr;
+		}
 	}
 
 	//If we had VAOs could set up the pointers already
@@ -83,6 +129,7 @@ VertexBuffer::VertexBuffer(const VertexBufferDesc &desc)
 
 VertexBuffer::~VertexBuffer()
 {
+	ForgetBinding();
 	glDeleteBuffers(1, &m_buffer);
 	delete[] m_data;
 }
@@ -93,7 +140,7 @@ Uint8 *VertexBuffer::MapInternal(BufferMapMode mode)
 	assert(m_mapMode == BUFFER_MAP_NONE); //must not be currently mapped
 	m_mapMode = mode;
 	if (GetDesc().usage == BUFFER_USAGE_STATIC) {
-		glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+		BindArrayBuffer(m_buffer);
 		if (mode == BUFFER_MAP_READ)
 			return reinterpret_cast<Uint8*>(glMapBuffer(GL_ARRAY_BUFFER, GL_READ_ONLY));
 		else if (mode == BUFFER_MAP_WRITE)
@@ -108,14 +155,13 @@ void VertexBuffer::Unmap()
 	assert(m_mapMode != BUFFER_MAP_NONE); //not currently mapped
 
 	if (GetDesc().usage == BUFFER_USAGE_STATIC) {
+		BindArrayBuffer(m_buffer);
 		glUnmapBuffer(GL_ARRAY_BUFFER);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	} else {
 		if (m_mapMode == BUFFER_MAP_WRITE) {
 			const GLsizei dataSize = m_desc.numVertices * m_desc.stride;
-			glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+			BindArrayBuffer(m_buffer);
 			glBufferSubData(GL_ARRAY_BUFFER, 0, dataSize, m_data);
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
 		}
 	}
 
@@ -151,28 +197,37 @@ void VertexBuffer::UnsetAttribPointers()
 {
 }
 
-IndexBuffer::IndexBuffer(Uint32 size, BufferUsage hint)
+IndexBuffer::IndexBuffer(Uint32 size, BufferUsage hint, const Uint16 *data)
 	: Graphics::IndexBuffer(size, hint)
 {
 	assert(size > 0);
 
 	const GLenum usage = (hint == BUFFER_USAGE_STATIC) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
 	glGenBuffers(1, &m_buffer);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
-	m_data = new Uint16[size];
-	memset(m_data, 0, sizeof(Uint16) * size);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Uint16) * m_size, m_data, usage);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-	//Don't keep client data around for static buffers
-	if (GetUsage() == BUFFER_USAGE_STATIC) {
-		delete[] m_data;
+	BindElementBuffer(m_buffer);
+	if (data && GetUsage() == BUFFER_USAGE_STATIC) {
+		//uploaded straight from the caller's memory
 		m_data = nullptr;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Uint16) * m_size, data, usage);
+	} else {
+		m_data = new Uint16[size];
+		if (data)
+			memcpy(m_data, data, sizeof(Uint16) * size);
+		else
+			memset(m_data, 0, sizeof(Uint16) * size);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Uint16) * m_size, m_data, usage);
+
+		//Don't keep client data around for static buffers
+		if (GetUsage() == BUFFER_USAGE_STATIC) {
+			delete[] m_data;
+			m_data = nullptr;
+		}
 	}
 }
 
 IndexBuffer::~IndexBuffer()
 {
+	ForgetBinding();
 	glDeleteBuffers(1, &m_buffer);
 	delete[] m_data;
 }
@@ -183,7 +238,7 @@ Uint16 *IndexBuffer::Map(BufferMapMode mode)
 	assert(m_mapMode == BUFFER_MAP_NONE); //must not be currently mapped
 	m_mapMode = mode;
 	if (GetUsage() == BUFFER_USAGE_STATIC) {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
+		BindElementBuffer(m_buffer);
 		if (mode == BUFFER_MAP_READ)
 			return reinterpret_cast<Uint16*>(glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_READ_ONLY));
 		else if (mode == BUFFER_MAP_WRITE)
@@ -198,13 +253,12 @@ void IndexBuffer::Unmap()
 	assert(m_mapMode != BUFFER_MAP_NONE); //not currently mapped
 
 	if (GetUsage() == BUFFER_USAGE_STATIC) {
+		BindElementBuffer(m_buffer);
 		glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	} else {
 		if (m_mapMode == BUFFER_MAP_WRITE) {
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
+			BindElementBuffer(m_buffer);
 			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(Uint16) * m_size, m_data);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 		}
 	}
 
@@ -12,13 +12,28 @@ class GLBufferBase {
 public:
 	GLuint GetBuffer() const { return m_buffer; }
 
+	// buffer bindings are tracked, binding the bound buffer again is skipped.
+	// Buffers stay bound after use, nothing draws from client memory
+	static void BindArrayBuffer(GLuint buffer);
+	static void BindElementBuffer(GLuint buffer);
+	// binds since the last call
+	static Uint32 TakeNumBinds();
+
 protected:
+	// call before deleting, GL may reuse the name
+	void ForgetBinding();
+
 	GLuint m_buffer;
+
+private:
+	static GLuint s_arrayBuffer;
+	static GLuint s_elementBuffer;
+	static Uint32 s_numBinds;
 };
 
 class VertexBuffer : public Graphics::VertexBuffer, public GLBufferBase {
 public:
-	VertexBuffer(const VertexBufferDesc&);
+	VertexBuffer(const VertexBufferDesc&, const void *data = nullptr);
 	~VertexBuffer();
 
 	virtual void Unmap() override;
@@ -34,7 +49,7 @@ private:
 
 class IndexBuffer : public Graphics::IndexBuffer, public GLBufferBase {
 public:
-	IndexBuffer(Uint32 size, BufferUsage);
+	IndexBuffer(Uint32 size, BufferUsage, const Uint16 *data = nullptr);
 	~IndexBuffer();
 
 	virtual Uint16 *Map(BufferMapMode) override;
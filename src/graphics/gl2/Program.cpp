@@ -14,6 +14,7 @@ namespace GL2 {
 
 static const char *s_glslVersion = "#version 110\n";
 GLuint Program::s_curProgram = 0;
+Uint32 Program::s_numChanges = 0;
 
 // Check and warn about compile & link errors
 static bool check_glsl_errors(const char *filename, GLuint obj)
@@ -148,6 +149,8 @@ Program::Program(const std::string &name, const std::string &defines)
 
 Program::~Program()
 {
+	if (s_curProgram == m_program)
+		s_curProgram = 0;
 	glDeleteProgram(m_program);
 }
 
@@ -161,11 +164,21 @@ void Program::Reload()
 
 void Program::Use()
 {
-	if (s_curProgram != m_program)
+	if (s_curProgram != m_program) {
 		glUseProgram(m_program);
+		++s_numChanges;
+	}
 	s_curProgram = m_program;
 }
 
+//static
+Uint32 Program::TakeNumChanges()
+{
+	const Uint32 n = s_numChanges;
+	s_numChanges = 0;
+	return n;
+}
+
 void Program::Unuse()
 {
 	glUseProgram(0);
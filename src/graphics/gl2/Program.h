@@ -24,6 +24,8 @@ namespace Graphics {
 			void Reload();
 			virtual void Use();
 			virtual void Unuse();
+			// program switches since the last call
+			static Uint32 TakeNumChanges();
 
 			// Some generic uniforms.
 			// to be added: matrices etc.
@@ -42,6 +44,7 @@ namespace Graphics {
 
 		protected:
 			static GLuint s_curProgram;
+			static Uint32 s_numChanges;
 
 			void LoadShaders(const std::string&, const std::string &defines);
 			virtual void InitUniforms();
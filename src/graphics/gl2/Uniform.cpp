@@ -75,7 +75,7 @@ void Uniform::Set(const matrix4x4f &m)
 void Uniform::Set(Texture *tex, unsigned int unit)
 {
 	if (m_location != -1 && tex) {
-		glActiveTexture(GL_TEXTURE0 + unit);
+		TextureGL::SetActiveUnit(unit);
 		static_cast<TextureGL*>(tex)->Bind();
 		glUniform1i(m_location, unit);
 	}
@@ -178,99 +178,57 @@ namespace Theme {
 		Screen::GetRenderer()->DrawTriangles(&vts, state, Screen::flatColorMaterial, Graphics::TRIANGLE_FAN);
 	}
 
-	void DrawHollowRect(const float size[2], const Color &color, Graphics::RenderState *state)
+	// the eight corners of a rect and of its inside border, and the quads
+	// of the border's four sides, its two shaded halves and the inside
+	static const Uint8 s_borderQuads[] = {
+		0,1,5,4, 0,4,7,3,
+		3,7,6,2, 1,2,6,5,
+		4,5,6,7 };
+
+	static void DrawBorderQuads(const float size[2], const Uint8 *quads, int numQuads, const Color &color, Graphics::RenderState *state)
 	{
-		Screen::flatColorMaterial->diffuse = color;
-		Screen::GetRenderer()->SetRenderState(state);
-		Screen::flatColorMaterial->Apply();
+		const vector3f vertices[] = {
+			vector3f(0,0,0),
+			vector3f(0,size[1],0),
+			vector3f(size[0],size[1],0),
+			vector3f(size[0],0,0),
+			vector3f(BORDER_WIDTH,BORDER_WIDTH,0),
+			vector3f(BORDER_WIDTH,size[1]-BORDER_WIDTH,0),
+			vector3f(size[0]-BORDER_WIDTH,size[1]-BORDER_WIDTH,0),
+			vector3f(size[0]-BORDER_WIDTH,BORDER_WIDTH,0) };
 
-		GLfloat vertices[] = { 0,0,
-			0,size[1],
-			size[0],size[1],
-			size[0],0,
-			BORDER_WIDTH,BORDER_WIDTH,
-			BORDER_WIDTH,size[1]-BORDER_WIDTH,
-			size[0]-BORDER_WIDTH,size[1]-BORDER_WIDTH,
-			size[0]-BORDER_WIDTH,BORDER_WIDTH };
-		GLubyte indices[] = {
-			0,1,5,4, 0,4,7,3,
-			3,7,6,2, 1,2,6,5 };
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glVertexPointer(2, GL_FLOAT, 0, vertices);
-		glDrawElements(GL_QUADS, 16, GL_UNSIGNED_BYTE, indices);
-		glDisableClientState(GL_VERTEX_ARRAY);
+		static Graphics::VertexArray vts(Graphics::ATTRIB_POSITION);
+		vts.Clear();
+		for (int i = 0; i < numQuads; i++, quads += 4) {
+			vts.Add(vertices[quads[0]]);
+			vts.Add(vertices[quads[1]]);
+			vts.Add(vertices[quads[2]]);
+			vts.Add(vertices[quads[0]]);
+			vts.Add(vertices[quads[2]]);
+			vts.Add(vertices[quads[3]]);
+		}
 
-		Screen::flatColorMaterial->Unapply();
+		Screen::flatColorMaterial->diffuse = color;
+		Screen::GetRenderer()->DrawTriangles(&vts, state, Screen::flatColorMaterial);
 	}
 
-	void DrawIndent(const float size[2], Graphics::RenderState *state)
+	void DrawHollowRect(const float size[2], const Color &color, Graphics::RenderState *state)
 	{
-		Screen::GetRenderer()->SetRenderState(state);
-
-		GLfloat vertices[] = { 0,0,
-			0,size[1],
-			size[0],size[1],
-			size[0],0,
-			BORDER_WIDTH,BORDER_WIDTH,
-			BORDER_WIDTH,size[1]-BORDER_WIDTH,
-			size[0]-BORDER_WIDTH,size[1]-BORDER_WIDTH,
-			size[0]-BORDER_WIDTH,BORDER_WIDTH };
-		GLubyte indices[] = {
-			0,1,5,4, 0,4,7,3,
-			3,7,6,2, 1,2,6,5,
-			4,5,6,7 };
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glVertexPointer(2, GL_FLOAT, 0, vertices);
-
-		Screen::flatColorMaterial->diffuse = Colors::bgShadow;
-		Screen::flatColorMaterial->Apply();
-		glDrawElements(GL_QUADS, 8, GL_UNSIGNED_BYTE, indices);
-
-		Screen::flatColorMaterial->diffuse = Color(153,153,153,255);
-		Screen::flatColorMaterial->Apply();
-		glDrawElements(GL_QUADS, 8, GL_UNSIGNED_BYTE, indices+8);
-
-		Screen::flatColorMaterial->diffuse = Colors::bg;
-		Screen::flatColorMaterial->Apply();
-		glDrawElements(GL_QUADS, 4, GL_UNSIGNED_BYTE, indices+16);
-		glDisableClientState(GL_VERTEX_ARRAY);
+		DrawBorderQuads(size, s_borderQuads, 4, color, state);
+	}
 
-		Screen::flatColorMaterial->Unapply();
+	void DrawIndent(const float size[2], Graphics::RenderState *state)
+	{
+		DrawBorderQuads(size, s_borderQuads, 2, Colors::bgShadow, state);
+		DrawBorderQuads(size, s_borderQuads+8, 2, Color(153,153,153,255), state);
+		DrawBorderQuads(size, s_borderQuads+16, 1, Colors::bg, state);
 	}
 
 	void DrawOutdent(const float size[2], Graphics::RenderState *state)
 	{
-		Screen::GetRenderer()->SetRenderState(state);
-
-		GLfloat vertices[] = { 0,0,
-			0,size[1],
-			size[0],size[1],
-			size[0],0,
-			BORDER_WIDTH,BORDER_WIDTH,
-			BORDER_WIDTH,size[1]-BORDER_WIDTH,
-			size[0]-BORDER_WIDTH,size[1]-BORDER_WIDTH,
-			size[0]-BORDER_WIDTH,BORDER_WIDTH };
-		GLubyte indices[] = {
-			0,1,5,4, 0,4,7,3,
-			3,7,6,2, 1,2,6,5,
-			4,5,6,7 };
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glVertexPointer(2, GL_FLOAT, 0, vertices);
-
-		Screen::flatColorMaterial->diffuse = Color(153,153,153,255);
-		Screen::flatColorMaterial->Apply();
-		glDrawElements(GL_QUADS, 8, GL_UNSIGNED_BYTE, indices);
-
-		Screen::flatColorMaterial->diffuse = Colors::bgShadow;
-		Screen::flatColorMaterial->Apply();
-		glDrawElements(GL_QUADS, 8, GL_UNSIGNED_BYTE, indices+8);
-
-		Screen::flatColorMaterial->diffuse = Colors::bg;
-		Screen::flatColorMaterial->Apply();
-		glDrawElements(GL_QUADS, 4, GL_UNSIGNED_BYTE, indices+16);
-		glDisableClientState(GL_VERTEX_ARRAY);
-
-		Screen::flatColorMaterial->Unapply();
+		DrawBorderQuads(size, s_borderQuads, 2, Color(153,153,153,255), state);
+		DrawBorderQuads(size, s_borderQuads+8, 2, Colors::bgShadow, state);
+		DrawBorderQuads(size, s_borderQuads+16, 1, Colors::bg, state);
 	}
 }
 
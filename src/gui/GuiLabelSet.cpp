@@ -5,13 +5,14 @@
 
 namespace Gui {
 
-LabelSet::LabelSet() : Widget()
+LabelSet::LabelSet() : Widget(),
+	m_font(Screen::GetFont()),
+	m_batch(m_font)
 {
 	m_eventMask = EVENT_MOUSEDOWN;
 	m_labelsVisible = true;
 	m_labelsClickable = true;
 	m_labelColor = Color::WHITE;
-	m_font = Screen::GetFont();
 }
 
 bool LabelSet::OnMouseDown(Gui::MouseButtonEvent *e)
@@ -60,8 +61,25 @@ void LabelSet::Draw()
 {
 	PROFILE_SCOPED()
 	if (!m_labelsVisible) return;
-	for (std::vector<LabelSetItem>::iterator i = m_items.begin(); i != m_items.end(); ++i)
-		Gui::Screen::RenderString((*i).text, (*i).screenx, (*i).screeny - Gui::Screen::GetFontHeight()*0.5f, (*i).hasOwnColor ? (*i).color : m_labelColor, m_font.Get());
+
+	// one draw for all the labels, placed as Screen::RenderString would
+	Graphics::Renderer *r = Gui::Screen::GetRenderer();
+	const float *fontScale = Gui::Screen::GetCoords2Pixels();
+	const matrix4x4f &modelMatrix = r->GetCurrentModelView();
+	const float originX = modelMatrix[12];
+	const float originY = modelMatrix[13] - Gui::Screen::GetFontHeight(m_font.Get())*0.5f;
+
+	m_batch.Clear();
+	for (std::vector<LabelSetItem>::iterator i = m_items.begin(); i != m_items.end(); ++i) {
+		const float x = floor((originX + (*i).screenx) / fontScale[0]);
+		const float y = floor((originY + (*i).screeny) / fontScale[1]);
+		m_batch.Add((*i).text, x, y, (*i).hasOwnColor ? (*i).color : m_labelColor);
+	}
+
+	Graphics::Renderer::MatrixTicket ticket(r, Graphics::MatrixMode::MODELVIEW);
+	r->LoadIdentity();
+	r->Scale(fontScale[0], fontScale[1], 1);
+	m_batch.Draw();
 }
 
 void LabelSet::GetSizeRequested(float size[2])
@@ -5,6 +5,7 @@
 #define GUILABELSET_H
 
 #include "GuiWidget.h"
+#include "text/TextMesh.h"
 #include <vector>
 
 /*
@@ -58,6 +59,7 @@ private:
 	Color m_labelColor;
 
 	RefCountedPtr<Text::TextureFont> m_font;
+	Text::TextBatch m_batch;
 };
 }
 
@@ -4,6 +4,8 @@
 #include "libs.h"
 #include "Pi.h"
 #include "ModelViewer.h"
+#include "FileSystem.h"
+#include "graphics/TextureCache.h"
 #include "utils.h"
 #include <cstdio>
 #include "p3/Game.h"
@@ -11,6 +13,7 @@
 enum RunMode {
 	MODE_GAME,
 	MODE_MODELVIEWER,
+	MODE_TEXTURECACHE,
 	MODE_VERSION,
 	MODE_USAGE,
 	MODE_USAGE_ERROR
@@ -43,6 +46,11 @@ int main(int argc, char** argv)
 			goto start;
 		}
 
+		if (modeopt == "texturecache" || modeopt == "tc") {
+			mode = MODE_TEXTURECACHE;
+			goto start;
+		}
+
 		if (modeopt == "version" || modeopt == "v") {
 			mode = MODE_VERSION;
 			goto start;
@@ -93,6 +101,19 @@ start:
 			break;
 		}
 
+		case MODE_TEXTURECACHE: {
+			// encode the model textures now rather than on first use
+			FileSystem::Init();
+			FileSystem::userFiles.MakeDirectory(""); // ensure the config directory exists
+			Graphics::TextureCache::SetEnabled(true);
+			if (!Graphics::TextureCache::IsEnabled())
+				return 1;
+			const Uint32 numCached = Graphics::TextureCache::BuildAll("textures") + Graphics::TextureCache::BuildAll("models");
+			Output("%u textures in the compressed texture cache\n", numCached);
+			FileSystem::Uninit();
+			break;
+		}
+
 		case MODE_VERSION: {
 			std::string version(PIONEER_VERSION);
 			if (strlen(PIONEER_EXTRAVERSION)) version += " (" PIONEER_EXTRAVERSION ")";
@@ -110,6 +131,7 @@ start:
 				"available modes:\n"
 				"    -game        [-g]     game (default)\n"
 				"    -modelviewer [-mv]    model viewer\n"
+				"    -texturecache [-tc]   build the compressed texture cache\n"
 				"    -version     [-v]     show version\n"
 				"    -help        [-h,-?]  this help\n"
 			);
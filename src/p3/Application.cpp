@@ -19,6 +19,7 @@ Application::~Application()
 Graphics::Settings Application::ReadVideoSettings(IniConfig* config)
 {
 	Graphics::Settings s = {};
+	s.rendererType = (config->String("RendererName") == "Dummy") ? Graphics::RENDERER_DUMMY : Graphics::RENDERER_OPENGL;
 	s.width = config->Int("ScrWidth");
 	s.height = config->Int("ScrHeight");
 	s.fullscreen = (config->Int("StartFullscreen") != 0);
@@ -2,7 +2,6 @@
 #include "p3/Common.h"
 #include "p3/EntitySystem.h"
 #include "graphics/Types.h"
-#include "graphics/Frustum.h"
 
 namespace p3
 {
@@ -24,11 +23,6 @@ public:
 	matrix3x3d orient;
 
 	matrix4x4d viewMatrix;
-
-	const Graphics::Frustum& GetFrustum() const { return m_frustum; }
-
-private:
-	Graphics::Frustum m_frustum;
 };
 
 struct CameraComponent : public entityx::Component<CameraComponent> {
@@ -50,6 +50,13 @@ void Game::Init(const std::map<std::string, std::string>& options)
 	vs.title = "P3";
 	m_renderer.reset(Graphics::Init(vs));
 
+	Uint32 numThreads = GetConfig()->Int("WorkerThreads");
+	if (numThreads == 0)
+		numThreads = std::max(Uint32(OS::GetNumCores()) - 1, 1U);
+	m_jobQueue.reset(new JobQueue(numThreads));
+	m_textureLoader.reset(new Graphics::TextureLoader(GetRenderer(), GetJobQueue()));
+	GetRenderer()->SetTextureLoader(m_textureLoader.get());
+
 	EnumStrings::Init();
 
 	Lua::Init();
@@ -61,7 +68,9 @@ void Game::Init(const std::map<std::string, std::string>& options)
 
 	InitLua();
 
-	m_modelCache.reset(new ModelCache(GetRenderer()));
+	m_modelCache.reset(new ModelCache(GetRenderer(), GetJobQueue()));
+	// the models Space starts with, imported while the galaxy is set up
+	m_modelCache->PrefetchModels({ "kanara", "natrix" });
 
 	//init some graphics
 	LaserBoltGraphic::InitResources(GetRenderer());
@@ -78,6 +87,9 @@ void Game::Uninit()
 {
 	m_config->Save();
 	m_ui.Reset();
+	m_modelCache.reset();
+	GetRenderer()->SetTextureLoader(nullptr);
+	m_textureLoader.reset();
 	Lua::Uninit();
 	Graphics::Uninit();
 	SDL_Quit();
@@ -147,6 +159,10 @@ void Game::Run()
 		m_renderer->EndFrame();
 		m_renderer->SwapBuffers();
 
+		m_jobQueue->FinishJobs();
+		m_modelCache->Update();
+		m_textureLoader->Update();
+
 		//if (Pi::game->UpdateTimeAccel())
 		//	accumulator = 0; // fix for huge pauses 10000x -> 1x
 
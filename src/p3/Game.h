@@ -2,6 +2,7 @@
 #include "p3/Application.h"
 #include "p3/Sim.h"
 #include "graphics/Renderer.h"
+#include "graphics/TextureLoader.h"
 #include "ui/Context.h"
 #include "pi/ModelCache.h"
 #include "pi/LuaConsole.h"
@@ -20,6 +21,7 @@ public:
 	Sim* GetSim() const { return m_sim; }
 	UI::Context* GetUI() const { return m_ui.Get(); }
 	ModelCache* GetModelCache() const { return m_modelCache.get(); }
+	JobQueue* GetJobQueue() const { return m_jobQueue.get(); }
 	Random& GetRNG() { return m_rng; }
 
 private:
@@ -27,6 +29,8 @@ private:
 	void InitLua();
 
 	std::unique_ptr<Graphics::Renderer> m_renderer;
+	std::unique_ptr<JobQueue> m_jobQueue;
+	std::unique_ptr<Graphics::TextureLoader> m_textureLoader;
 	std::unique_ptr<LuaConsole> m_console;
 	std::unique_ptr<ModelCache> m_modelCache;
 	RefCountedPtr<UI::Context> m_ui;
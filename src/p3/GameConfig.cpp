@@ -9,6 +9,7 @@ GameConfig::GameConfig(const std::map<std::string, std::string>& override_)
 	// set defaults
 	std::map<std::string, std::string>& map = m_map[""];
 	map["Lang"] = "en";
+	map["RendererName"] = "OpenGL"; // or "Dummy" to draw nothing and count renderer calls
 	map["StartFullscreen"] = "0";
 	map["ScrWidth"] = "800";
 	map["ScrHeight"] = "600";
@@ -17,6 +18,7 @@ GameConfig::GameConfig(const std::map<std::string, std::string>& override_)
 	map["AntiAliasingMode"] = "2";
 	map["VSync"] = "1";
 	map["UseTextureCompression"] = "0";
+	map["WorkerThreads"] = "0"; // 0 for one less than the number of cores
 
 #ifdef _WIN32
 	map["RedirectStdio"] = "1";
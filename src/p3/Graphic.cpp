@@ -11,9 +11,14 @@ using Graphics::Material;
 VertexArray* s_laserVertices = nullptr;
 RenderState* s_laserState    = nullptr;
 Material*    s_laserMaterial = nullptr;
+double       s_laserRadius   = 0.0;
 
 Graphic::Graphic(Graphics::Renderer* r)
-	: m_renderer(r)
+	: modelTransform(matrix4x4d::Identity())
+	, viewTransform(matrix4x4d::Identity())
+	, depth(0.0)
+	, clipRadius(0.0)
+	, m_renderer(r)
 {
 }
 
@@ -21,6 +26,12 @@ Graphic::~Graphic()
 {
 }
 
+bool Graphic::IsTransparent() const
+{
+	const Graphics::RenderState* rs = GetRenderState();
+	return rs && rs->GetDesc().blendMode != Graphics::BLEND_SOLID;
+}
+
 void LaserBoltGraphic::InitResources(Graphics::Renderer* r)
 {
 	SDL_assert(s_laserVertices == nullptr);
@@ -71,6 +82,9 @@ void LaserBoltGraphic::InitResources(Graphics::Renderer* r)
 		four.ArbRotate(vector3f(0.f, 0.f, 1.f), DEG2RAD(45.f));
 	}
 
+	for (Uint32 i = 0; i < s_laserVertices->GetNumVerts(); i++)
+		s_laserRadius = std::max(s_laserRadius, double(s_laserVertices->position[i].Length()));
+
 	//should register uninit function here
 }
 
@@ -101,6 +115,7 @@ LaserBoltGraphic::LaserBoltGraphic(Graphics::Renderer* r)
 	vertexArray = s_laserVertices;
 	renderState = s_laserState;
 	material    = s_laserMaterial;
+	clipRadius  = s_laserRadius;
 }
 
 }
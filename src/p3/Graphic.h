@@ -21,11 +21,25 @@ public:
 	virtual ~Graphic();
 	virtual void Render() = 0;
 
+	//sorting hints for the scene render queue. A graphic
+	//that switches state by itself (models) returns null
+	virtual Graphics::RenderState* GetRenderState() const { return nullptr; }
+	virtual Graphics::Material* GetMaterial() const { return nullptr; }
+	//drawn after all opaque graphics, back to front
+	virtual bool IsTransparent() const;
+	//graphics returning the same mesh, state and material can be
+	//drawn together with their view * model transforms. Null if
+	//the graphic has to be drawn by Render
+	virtual const Graphics::VertexArray* GetInstanceMesh() const { return nullptr; }
+
 	matrix4x4d modelTransform;
 	//has to be copied here due to Frame system
 	matrix4x4d viewTransform;
 
-	double depth; //for sorting
+	double depth; //distance from camera, for sorting
+
+	//bounding sphere around the model origin, 0 to never cull
+	double clipRadius;
 
 	vector3d projPos;
 
@@ -39,7 +53,9 @@ public:
 	ModelGraphic(Graphics::Renderer* r, SceneGraph::Model* m)
 		: Graphic(r)
 		, model(m)
-	{}
+	{
+		clipRadius = m->GetDrawClipRadius();
+	}
 	virtual void Render() override;
 	SceneGraph::Model* model;
 };
@@ -50,6 +66,9 @@ class VertexArrayGraphic : public Graphic
 public:
 	VertexArrayGraphic(Graphics::Renderer*);
 	virtual void Render() override;
+	virtual Graphics::RenderState* GetRenderState() const override { return renderState; }
+	virtual Graphics::Material* GetMaterial() const override { return material; }
+	virtual const Graphics::VertexArray* GetInstanceMesh() const override { return vertexArray; }
 
 	Graphics::VertexArray* vertexArray;
 	Graphics::RenderState* renderState;
@@ -1,6 +1,7 @@
 #include "p3/Scene.h"
 #include "p3/CoreComponents.h"
 #include "scenegraph/Model.h"
+#include "graphics/Frustum.h"
 #include "graphics/Light.h"
 #include "pi/Frame.h"
 #include "p3/Game.h"
@@ -9,6 +10,9 @@
 namespace p3
 {
 
+//graphics smaller than this on screen are not drawn
+static const double GRAPHIC_HIDDEN_PIXEL_THRESHOLD = 1.0;
+
 void FrameRenderSystem::update(ent_ptr<EntityManager> em, ent_ptr<EventManager> events, double dt)
 {
 	for (auto camEntity : em->entities_with_components<CameraComponent, FrameComponent>()) {
@@ -17,23 +21,26 @@ void FrameRenderSystem::update(ent_ptr<EntityManager> em, ent_ptr<EventManager>
 		auto cpoc = camEntity.component<PosOrientComponent>();
 		SDL_assert(cpoc);
 
-		//make a temporary camera frame
-		std::unique_ptr<Frame> camFrame(new Frame(cfc->frame, "camera", Frame::FLAG_ROTATING));
-		camFrame->SetOrient(cpoc->orient, p3::game->GetSim()->GetGameTime());
-		camFrame->SetPosition(cpoc->pos);
-		//update root relative pos & interpolate
-		camFrame->ClearMovement();
-		camFrame->UpdateInterpTransform(1.0);
+		//camera relative to the root, as a rotating child frame of
+		//its own frame would be
+		const Frame* camParent = cfc->frame;
+		const matrix3x3d camOrient = camParent->GetRootOrient() * cpoc->orient;
+		const vector3d camPos = camParent->GetRootOrient() * cpoc->pos + camParent->GetRootPosition();
+
+		const Frame* root = camParent;
+		while (root->GetParent())
+			root = root->GetParent();
+		UpdateFrameTransforms(root, camOrient, camPos);
 
 		//set up star light source(s)
 		for (auto lightEntity : em->entities_with_components<LightComponent, FrameComponent>()) {
 			auto lc  = lightEntity.component<LightComponent>();
-            auto lfc = lightEntity.component<FrameComponent>();
-            vector3d lpos = lfc->frame->GetPositionRelTo(camFrame.get());
+			auto lfc = lightEntity.component<FrameComponent>();
+			vector3d lpos = GetFrameTransform(lfc->frame).GetTranslate();
 			const double dist = lpos.Length() / AU;
 			lpos *= 1.0/dist; // normalize
-            lc->light.SetPosition(vector3f(lpos.x, lpos.y, lpos.z));
-            scene->AddLight(&lc->light);
+			lc->light.SetPosition(vector3f(lpos.x, lpos.y, lpos.z));
+			scene->AddLight(&lc->light);
 		}
 
 		//copy view transform to each graphic
@@ -41,20 +48,48 @@ void FrameRenderSystem::update(ent_ptr<EntityManager> em, ent_ptr<EventManager>
 		for (auto drawEntity : em->entities_with_components<GraphicComponent, FrameComponent>()) {
 			auto efc  = drawEntity.component<FrameComponent>();
 			auto egc  = drawEntity.component<GraphicComponent>();
-			auto epoc = drawEntity.component<PosOrientComponent>();
-			SDL_assert(epoc);
-			matrix4x4d viewTransform;
-			Frame::GetFrameTransform(efc->frame, camFrame.get(), egc->graphic->viewTransform);
-
-			//vector3d viewCoords = viewTransform * epoc->pos; //should be interp pos
+			SDL_assert(drawEntity.component<PosOrientComponent>());
+			egc->graphic->viewTransform = GetFrameTransform(efc->frame);
 		}
 
 		scene->Render(camc->camera.get());
-
-		cfc->frame->RemoveChild(camFrame.get());
 	}
 }
 
+void FrameRenderSystem::UpdateFrameTransforms(const Frame* root, const matrix3x3d& camOrient, const vector3d& camPos)
+{
+	m_frameTransforms.clear();
+	m_lastFrame = 0;
+	AddFrameTransforms(root, camOrient.Transpose(), camPos);
+	std::sort(m_frameTransforms.begin(), m_frameTransforms.end());
+}
+
+void FrameRenderSystem::AddFrameTransforms(const Frame* f, const matrix3x3d& camOrientT, const vector3d& camPos)
+{
+	//same as Frame::GetFrameTransform to a rotating camera frame
+	FrameTransform ft;
+	ft.frame = f;
+	ft.transform = camOrientT * f->GetRootOrient();
+	ft.transform.SetTranslate(camOrientT * (f->GetRootPosition() - camPos));
+	m_frameTransforms.push_back(ft);
+
+	for (const Frame* kid : f->GetChildren())
+		AddFrameTransforms(kid, camOrientT, camPos);
+}
+
+const matrix4x4d& FrameRenderSystem::GetFrameTransform(const Frame* f)
+{
+	if (m_lastFrame < m_frameTransforms.size() && m_frameTransforms[m_lastFrame].frame == f)
+		return m_frameTransforms[m_lastFrame].transform;
+
+	FrameTransform key;
+	key.frame = f;
+	auto it = std::lower_bound(m_frameTransforms.begin(), m_frameTransforms.end(), key);
+	SDL_assert(it != m_frameTransforms.end() && it->frame == f);
+	m_lastFrame = it - m_frameTransforms.begin();
+	return it->transform;
+}
+
 class ModelRenderSystem : public entityx::System<ModelRenderSystem>
 {
 public:
@@ -73,6 +108,7 @@ public:
 
 Scene::Scene(Graphics::Renderer* r, ent_ptr<EntityManager> em, ent_ptr<EventManager> ev)
 	: m_renderer(r)
+	, m_cullStats()
 	, m_entities(em)
 	, m_events(ev)
 {
@@ -127,13 +163,137 @@ void Scene::Render(Camera* cam)
 	if (!m_lights.empty())
 		m_renderer->SetLights(m_lights.size(), m_lights[0]);
 
-	for (auto g : m_graphics)
-		g->Render();
+	BuildRenderQueue(cam);
+	DrawRenderQueue();
 
 	m_lights.clear();
 	m_renderer->EnableFramebufferSRGB(false);
 }
 
+void Scene::BuildRenderQueue(Camera* cam)
+{
+	m_renderQueue.clear();
+	m_stateIds.clear();
+	m_renderQueue.reserve(m_graphics.size());
+
+	//same viewport and projection as Render sets, the camera may have
+	//changed them since the last frame
+	const float viewportWidth = m_renderer->GetWindow()->GetWidth() * cam->viewport.z;
+	const float viewportHeight = m_renderer->GetWindow()->GetHeight() * cam->viewport.w;
+	const Graphics::Frustum frustum(viewportWidth, viewportHeight, cam->fovY, cam->nearZ, cam->farZ);
+
+	//viewport height in pixels over the height of the view at unit distance
+	const double pixelScale = viewportHeight / (2.0 * tan(DEG2RAD(cam->fovY) * 0.5));
+
+	m_cullStats.tested = 0;
+	m_cullStats.culled = 0;
+
+	for (auto g : m_graphics) {
+		//view transform is frame-to-camera
+		const vector3d viewCoords = g->viewTransform * g->modelTransform.GetTranslate();
+		g->depth = viewCoords.Length();
+
+		if (g->clipRadius > 0.0) {
+			m_cullStats.tested++;
+			if (!frustum.TestPoint(viewCoords, g->clipRadius) ||
+			    g->clipRadius * pixelScale < GRAPHIC_HIDDEN_PIXEL_THRESHOLD * g->depth) {
+				m_cullStats.culled++;
+				continue;
+			}
+		}
+
+		RenderItem item;
+		item.key = SortKey(g);
+		item.graphic = g;
+		m_renderQueue.push_back(item);
+	}
+
+	m_cullStats.drawn = m_renderQueue.size();
+
+	//stable, so equal keys keep the order they were added in
+	std::stable_sort(m_renderQueue.begin(), m_renderQueue.end());
+}
+
+//additive blending gives the same result in any order
+static bool IsOrderIndependent(const Graphic* g)
+{
+	const Graphics::RenderState* rs = g->GetRenderState();
+	if (!rs) return false;
+	const Graphics::BlendMode mode = rs->GetDesc().blendMode;
+	return mode == Graphics::BLEND_ADDITIVE || mode == Graphics::BLEND_ALPHA_ONE;
+}
+
+void Scene::DrawRenderQueue()
+{
+	for (size_t i = 0; i < m_renderQueue.size();) {
+		Graphic* g = m_renderQueue[i].graphic;
+
+		//runs of graphics sharing a mesh, state and material are drawn
+		//as instances of it, in one call
+		size_t end = i + 1;
+		const Graphics::VertexArray* mesh = g->GetInstanceMesh();
+		if (mesh) {
+			while (end < m_renderQueue.size()) {
+				const Graphic* next = m_renderQueue[end].graphic;
+				if (next->GetInstanceMesh() != mesh ||
+				    next->GetRenderState() != g->GetRenderState() ||
+				    next->GetMaterial() != g->GetMaterial())
+					break;
+				end++;
+			}
+		}
+
+		if (end - i == 1) {
+			g->Render();
+		} else {
+			m_instanceTransforms.resize(end - i);
+			for (size_t j = i; j < end; j++) {
+				const Graphic* ig = m_renderQueue[j].graphic;
+				matrix4x4dtof(ig->viewTransform * ig->modelTransform, m_instanceTransforms[j - i]);
+			}
+			m_renderer->SetTransform(matrix4x4f::Identity());
+			m_renderer->DrawTrianglesInstanced(mesh, m_instanceTransforms.size(), &m_instanceTransforms[0], nullptr,
+			                                   g->GetRenderState(), g->GetMaterial());
+		}
+
+		i = end;
+	}
+}
+
+Uint64 Scene::SortKey(Graphic* g)
+{
+	//a non-negative float orders the same as its bit pattern
+	float depth = std::max(float(g->depth), 0.f);
+	Uint32 depthBits;
+	memcpy(&depthBits, &depth, sizeof(depthBits));
+	depthBits &= 0x7fffffff;
+
+	//2 bits bin, then for opaque and additive graphics
+	//15 bits state, 16 bits material, 31 bits depth
+	Uint64 bin = 0;
+	if (g->IsTransparent()) {
+		if (!IsOrderIndependent(g))
+			return (Uint64(2) << 62) | Uint64(0x7fffffff - depthBits);
+		bin = 1;
+	}
+
+	const Uint64 state = StateId(g->GetRenderState()) & 0x7fff;
+	const Uint64 material = StateId(g->GetMaterial()) & 0xffff;
+	return (bin << 62) | (state << 47) | (material << 31) | Uint64(depthBits);
+}
+
+Uint32 Scene::StateId(const void* p)
+{
+	//graphics that manage their own state sort together, before the rest
+	if (!p) return 0;
+	auto it = m_stateIds.find(p);
+	if (it != m_stateIds.end())
+		return it->second;
+	const Uint32 id = m_stateIds.size() + 1;
+	m_stateIds.insert(std::make_pair(p, id));
+	return id;
+}
+
 void Scene::AddLight(Graphics::Light* l)
 {
 	//m_lights.insert(l);
@@ -11,17 +11,33 @@ namespace p3
 {
 
 /**
- * For each camera, construct a temporary camera frame, then
- * get a frame render transform for each entity. From that, give
- * each Graphic view coords and orientation.
+ * For each camera, compute the frame-to-camera transform of every
+ * frame once, then give each Graphic its frame's transform as its
+ * view transform.
  */
 class FrameRenderSystem : public entityx::System<FrameRenderSystem>
 {
 public:
-	FrameRenderSystem(Scene* scene_) : scene(scene_) {}
+	FrameRenderSystem(Scene* scene_) : scene(scene_), m_lastFrame(0) {}
 	virtual void update(ent_ptr<EntityManager> em, ent_ptr<EventManager> events, double dt) override;
 
 	Scene* scene;
+
+private:
+	struct FrameTransform {
+		const Frame* frame;
+		matrix4x4d transform;
+		bool operator<(const FrameTransform& b) const { return frame < b.frame; }
+	};
+
+	//camera given relative to the root frame
+	void UpdateFrameTransforms(const Frame* root, const matrix3x3d& camOrient, const vector3d& camPos);
+	void AddFrameTransforms(const Frame* f, const matrix3x3d& camOrientT, const vector3d& camPos);
+	const matrix4x4d& GetFrameTransform(const Frame*);
+
+	//sorted by frame, kept between cameras and frames to avoid reallocating
+	std::vector<FrameTransform> m_frameTransforms;
+	size_t m_lastFrame; //index of the last lookup, entities tend to share frames
 };
 
 /**
@@ -35,9 +51,16 @@ class Scene : public entityx::Receiver<Scene>
 public:
 	enum class RenderBin
 	{
-	    NORMAL,    //depth sorted
+	    NORMAL,    //sorted by state, then depth
 	    BACKGROUND //drawn in order added
 	};
+	//graphics considered by the culling pass of the last Render
+	struct CullStats {
+		Uint32 tested;
+		Uint32 culled; //outside the frustum or below the pixel threshold
+		Uint32 drawn;
+	};
+
 	Scene(Graphics::Renderer*, ent_ptr<EntityManager>, ent_ptr<EventManager>);
 	void Render();
 	void Render(Camera* camera);
@@ -54,7 +77,26 @@ public:
 	void receive(const entityx::ComponentRemovedEvent<GraphicComponent>&);
 	void receive(const entityx::EntityDestroyedEvent&);
 
+	const CullStats& GetCullStats() const { return m_cullStats; }
+
 private:
+	/**
+	 * Render queue item. Opaque keys are ordered by render
+	 * state, material and then depth front to back. Additive
+	 * graphics follow, ordered the same way, and then the other
+	 * transparent graphics, back to front.
+	 */
+	struct RenderItem {
+		Uint64 key;
+		Graphic* graphic;
+		bool operator<(const RenderItem& b) const { return key < b.key; }
+	};
+
+	void BuildRenderQueue(Camera*);
+	void DrawRenderQueue();
+	Uint64 SortKey(Graphic*);
+	Uint32 StateId(const void*);
+
 	Graphics::Renderer* m_renderer;
 
 	std::vector<Graphic*> m_bgGraphics;
@@ -63,6 +105,11 @@ private:
 
 	//filled & emptied each frame
 	std::vector<Graphics::Light*> m_lights;
+	std::vector<RenderItem> m_renderQueue;
+	std::vector<matrix4x4f> m_instanceTransforms;
+	//small ids for render states and materials seen this frame
+	std::map<const void*, Uint32> m_stateIds;
+	CullStats m_cullStats;
 
 	ent_ptr<FrameRenderSystem> m_frameRenderSystem;
 	ent_ptr<entityx::BaseSystem> m_modelRenderSystem;
@@ -201,7 +201,7 @@ void Space::CreateTestScene(Entity player, double time)
 	SystemPath path(10,0,0,0);
 	m_starSystem = StarSystemCache::GetCached(path);
 
-	GenBody(time, m_starSystem->m_rootBody.Get(), m_rootFrame.get());
+	GenBody(time, m_starSystem->GetRootBody(), m_rootFrame.get());
 	m_rootFrame->UpdateOrbitRails(time, 1.0);
 
 	//init "player"
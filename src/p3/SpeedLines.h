@@ -11,6 +11,7 @@ public:
 	SpeedLines(Graphics::Renderer*, Entity owner);
 	void Update(double deltaTime);
 	virtual void Render() override;
+	virtual Graphics::RenderState* GetRenderState() const override { return m_renderState; }
 
 private:
 	Graphics::RenderState* m_renderState;
@@ -47,6 +47,8 @@ struct Color4ub {
 	Color4ub &operator*=(const float v) { r*=v; g*=v; b*=v; a*=v; return *this; }
 	Color4ub operator*(const float f) const { return Color4ub(f*r, f*g, f*b, f*a); }
 	Color4ub operator/(const float f) const { return Color4ub(r/f, g/f, b/f, a/f); }
+	bool operator==(const Color4ub &c) const { return r == c.r && g == c.g && b == c.b && a == c.a; }
+	bool operator!=(const Color4ub &c) const { return !(*this == c); }
 
 	Color4f ToColor4f() const { return Color4f(r/255.0f, g/255.0f, b/255.0f, a/255.0f); }
 
@@ -34,7 +34,7 @@ static Faction       s_no_faction;    // instead of answering null, we often wan
 static FactionList       s_factions;
 static FactionMap        s_factions_byName;
 static HomeSystemSet     s_homesystems;
-static FactionOctsapling s_spatial_index;
+static FactionOctree     s_spatial_index;
 static bool             s_may_assign_factions;
 
 // ------- Lua Faction Builder --------
@@ -345,6 +345,7 @@ void Faction::Init()
 	Output("Number of factions added: " SIZET_FMT "\n", s_factions.size());
 	Faction::ClearHomeSectors();
 	Pi::FlushCaches();    // clear caches of anything we used for faction generation
+	s_spatial_index.Build(); // sector jobs will do lookups from other threads from now on
 	s_may_assign_factions = true;
 }
 
@@ -373,6 +374,7 @@ void Faction::Uninit()
 	}
 	s_factions.clear();
 	s_factions_byName.clear();
+	s_spatial_index.Clear();
 }
 
 // ------- Factions proper --------
@@ -449,25 +451,82 @@ const bool Faction::IsCloserAndContains(double& closestFactionDist, RefCountedPt
 	}
 }
 
-Faction* Faction::GetNearestFaction(RefCountedPtr<const Sector> sec, Uint32 sysIndex)
+Faction* Faction::NearestFactionFromCandidates(RefCountedPtr<const Sector> sec, Uint32 sysIndex, const std::vector<Uint32> &candidates)
 {
-	PROFILE_SCOPED()
+	const Sector::System &sys = sec->m_systems[sysIndex];
+
 	// firstly if this a custom StarSystem it may already have a faction assigned
-	if (sec->m_systems[sysIndex].customSys && sec->m_systems[sysIndex].customSys->faction) {
-		return sec->m_systems[sysIndex].customSys->faction;
+	if (sys.customSys && sys.customSys->faction) {
+		return sys.customSys->faction;
 	}
 
 	// if it didn't, or it wasn't a custom StarStystem, then we go ahead and assign it a faction allegiance like normal below...
 	Faction*    result             = &s_no_faction;
 	double      closestFactionDist = HUGE_VAL;
-	ConstFactionList& candidates   = s_spatial_index.CandidateFactions(sec, sysIndex);
 
-	for (ConstFactionIterator it = candidates.begin(); it != candidates.end(); ++it) {
-		if ((*it)->IsCloserAndContains(closestFactionDist, sec, sysIndex)) result = *it;
+	for (std::vector<Uint32>::const_iterator it = candidates.begin(); it != candidates.end(); ++it) {
+		const FactionOctree::Entry &entry = s_spatial_index.GetEntry(*it);
+		if (!entry.placed) {
+			if (entry.faction->IsCloserAndContains(closestFactionDist, sec, sysIndex)) result = entry.faction;
+			continue;
+		}
+
+		/* same as IsCloserAndContains, but with the homeworld position taken from
+		   the index rather than from the (possibly not yet cached) home sector */
+		float distance = 0;
+		bool  inside   = true;
+		if (entry.homeSector[0] != sys.sx || entry.homeSector[1] != sys.sy || entry.homeSector[2] != sys.sz) {
+			vector3f dv = entry.homePos - sys.p;
+			dv += Sector::SIZE*vector3f(float(entry.homeSector[0] - sys.sx), float(entry.homeSector[1] - sys.sy), float(entry.homeSector[2] - sys.sz));
+			distance = dv.Length();
+			inside   = distance < entry.faction->Radius();
+		}
+		if (inside && (distance <= closestFactionDist)) {
+			closestFactionDist = distance;
+			result = entry.faction;
+		}
 	}
 	return result;
 }
 
+Faction* Faction::GetNearestFaction(RefCountedPtr<const Sector> sec, Uint32 sysIndex)
+{
+	PROFILE_SCOPED()
+	const Sector::System &sys = sec->m_systems[sysIndex];
+	if (sys.customSys && sys.customSys->faction) {
+		return sys.customSys->faction;
+	}
+
+	const vector3d pos(sys.FullPosition());
+	Aabb box;
+	box.min = box.max = pos;
+
+	std::vector<Uint32> candidates;
+	s_spatial_index.CandidateFactions(box, candidates);
+	return NearestFactionFromCandidates(sec, sysIndex, candidates);
+}
+
+void Faction::GetNearestFactions(RefCountedPtr<const Sector> sec, std::vector<Faction*> &outFactions)
+{
+	PROFILE_SCOPED()
+	outFactions.clear();
+	if (sec->m_systems.empty())
+		return;
+
+	// every system lies within the sector cube, so one lookup serves them all
+	const SystemPath secPath = sec->GetSystemPath();
+	Aabb box;
+	box.min = Sector::SIZE * vector3d(secPath.sectorX, secPath.sectorY, secPath.sectorZ);
+	box.max = box.min + vector3d(Sector::SIZE);
+
+	std::vector<Uint32> candidates;
+	s_spatial_index.CandidateFactions(box, candidates);
+
+	outFactions.reserve(sec->m_systems.size());
+	for (Uint32 i = 0; i < sec->m_systems.size(); i++)
+		outFactions.push_back(NearestFactionFromCandidates(sec, i, candidates));
+}
+
 bool Faction::IsHomeSystem(const SystemPath& sysPath)
 {
 	PROFILE_SCOPED()
@@ -529,7 +588,7 @@ void Faction::SetBestFitHomeworld(Sint32 x, Sint32 y, Sint32 z, Sint32 si, Uint3
 		while (Uint32(candidateSi) < sec->m_systems.size()) {
 			path.systemIndex = candidateSi;
 			sys = StarSystemCache::GetCached(path);
-			if (sys->m_spaceStations.size() > 0) {
+			if (sys->HasSpaceStations()) {
 				si = candidateSi;
 				break;
 			}
@@ -566,97 +625,156 @@ Faction::Faction() :
 
 // ------ Factions Spatial Indexing ------
 
-void FactionOctsapling::Add(Faction* faction)
+void FactionOctree::Add(Faction* faction)
 {
 	PROFILE_SCOPED()
-	/*  The general principle here is to put the faction in every octbox cell that a system
-	    that is a member of that faction could be in. This should let us cut the number
-		of factions that have to be checked by GetNearestFaction, by eliminating right off
-		all the those Factions that aren't in the same cell.
+	/* This part happens at faction generation time so isn't performance critical.
+	   The tree itself is only built once all the factions are known.
+	*/
+	Entry entry;
+	entry.faction = faction;
+	entry.placed  = false;
 
-		As I'm just going for the quick performance win, I'm being very sloppy and
-		treating a Faction as if it was a cube rather than a sphere. I'm also not even
-		attempting to work out real faction boundaries for this.
+	if (faction->hasHomeworld) {
+		RefCountedPtr<const Sector> sec = faction->GetHomeSector();
 
-		Obviously this all could be improved even without this Octsapling growing into
-		a full Octree.
+		/* only factions with homeworlds that are available at faction generation time
+		   can be placed in the tree
+		*/
+		if (faction->homeworld.systemIndex < sec->m_systems.size()) {
+			const Sector::System &sys = sec->m_systems[faction->homeworld.systemIndex];
+			entry.placed        = true;
+			entry.homePos       = sys.p;
+			entry.homeSector[0] = sys.sx;
+			entry.homeSector[1] = sys.sy;
+			entry.homeSector[2] = sys.sz;
+
+			/* the faction claims its whole home sector and everything within its
+			   radius. pad a little so float rounding can't drop a system on the edge
+			*/
+			const vector3d home   = HomePosition(entry);
+			const double   radius = std::max(faction->Radius(), 0.0) + 1.0;
+			const vector3d secMin = Sector::SIZE * vector3d(sys.sx, sys.sy, sys.sz);
+			entry.bounds.Update(home - vector3d(radius));
+			entry.bounds.Update(home + vector3d(radius));
+			entry.bounds.Update(secMin - vector3d(1.0));
+			entry.bounds.Update(secMin + vector3d(Sector::SIZE + 1.0));
+		}
+	}
 
-		This part happens at faction generation time so shouldn't be too performance
-		critical
-	*/
-	RefCountedPtr<const Sector> sec = faction->GetHomeSector();
+	if (!entry.placed)
+		m_unplaced.push_back(m_entries.size());
+	m_entries.push_back(entry);
+	m_dirty = true;
+}
 
-	/* only factions with homeworlds that are available at faction generation time can
-	   be added to specific cells...
-	*/
-	if (faction->hasHomeworld && (faction->homeworld.systemIndex < sec->m_systems.size())) {
-		/* calculate potential indexes for the octbox cells the faction needs to go into
-		*/
-		Sector::System sys = sec->m_systems[faction->homeworld.systemIndex];
+void FactionOctree::Clear()
+{
+	m_entries.clear();
+	m_unplaced.clear();
+	m_nodes.clear();
+	m_dirty = false;
+}
 
-		int xmin = BoxIndex(Sint32(sys.FullPosition().x - float((faction->Radius()))));
-		int xmax = BoxIndex(Sint32(sys.FullPosition().x + float((faction->Radius()))));
-		int ymin = BoxIndex(Sint32(sys.FullPosition().y - float((faction->Radius()))));
-		int ymax = BoxIndex(Sint32(sys.FullPosition().y + float((faction->Radius()))));
-		int zmin = BoxIndex(Sint32(sys.FullPosition().z - float((faction->Radius()))));
-		int zmax = BoxIndex(Sint32(sys.FullPosition().z + float((faction->Radius()))));
+void FactionOctree::Build()
+{
+	PROFILE_SCOPED()
+	if (!m_dirty)
+		return;
 
-		/* put the faction in all the octbox cells needed in a hideously inexact way that
-		   will generate duplicates in each cell in many cases
-		*/
-		octbox[xmin][ymin][zmin].push_back(faction);  // 0,0,0
-		octbox[xmax][ymin][zmin].push_back(faction);  // 1,0,0
-		octbox[xmax][ymax][zmin].push_back(faction);  // 1,1,0
-		octbox[xmax][ymax][zmax].push_back(faction);  // 1,1,1
+	m_nodes.clear();
+	std::vector<Uint32> placed;
+	for (Uint32 i = 0; i < m_entries.size(); i++)
+		if (m_entries[i].placed)
+			placed.push_back(i);
+	if (!placed.empty())
+		BuildNode(placed, 0);
+	m_dirty = false;
+}
 
-		octbox[xmin][ymax][zmin].push_back(faction);  // 0,1,0
-		octbox[xmin][ymax][zmax].push_back(faction);  // 0,1,1
-		octbox[xmin][ymin][zmax].push_back(faction);  // 0,0,1
-		octbox[xmax][ymin][zmax].push_back(faction);  // 1,0,1
+//static
+vector3d FactionOctree::HomePosition(const Entry &entry)
+{
+	return Sector::SIZE * vector3d(entry.homeSector[0], entry.homeSector[1], entry.homeSector[2]) + vector3d(entry.homePos);
+}
 
-		/* prune any duplicates from the octbox cells making things slightly saner
-		*/
-		PruneDuplicates(0,0,0);
-		PruneDuplicates(1,0,0);
-		PruneDuplicates(1,1,0);
-		PruneDuplicates(1,1,1);
+int FactionOctree::BuildNode(std::vector<Uint32> &entries, unsigned depth)
+{
+	const int nodeIdx = m_nodes.size();
+	m_nodes.push_back(Node());
+	for (int i = 0; i < 8; i++)
+		m_nodes[nodeIdx].children[i] = -1;
 
-		PruneDuplicates(0,1,0);
-		PruneDuplicates(0,1,1);
-		PruneDuplicates(0,0,1);
-		PruneDuplicates(1,0,1);
+	Aabb bounds, homes;
+	for (Uint32 e : entries) {
+		bounds.Update(m_entries[e].bounds.min);
+		bounds.Update(m_entries[e].bounds.max);
+		homes.Update(HomePosition(m_entries[e]));
+	}
+	m_nodes[nodeIdx].bounds = bounds;
 
-	} else {
-	/* ...other factions, such as ones with no homeworlds, and more annoyingly ones
-	   whose homeworlds don't exist yet because they're custom systems have to go in
-	   *every* octbox cell
-	*/
-		octbox[0][0][0].push_back(faction);
-		octbox[1][0][0].push_back(faction);
-		octbox[1][1][0].push_back(faction);
-		octbox[1][1][1].push_back(faction);
-
-		octbox[0][1][0].push_back(faction);
-		octbox[0][1][1].push_back(faction);
-		octbox[0][0][1].push_back(faction);
-		octbox[1][0][1].push_back(faction);
+	if (entries.size() <= MAX_LEAF_ENTRIES || depth >= MAX_DEPTH) {
+		m_nodes[nodeIdx].entries.swap(entries);
+		return nodeIdx;
+	}
+
+	// split around the centre of the faction positions. entries is in add
+	// order and stays that way in every octant
+	const vector3d centre = (homes.min + homes.max) * 0.5;
+	std::vector<Uint32> octants[8];
+	for (Uint32 e : entries) {
+		const vector3d p = HomePosition(m_entries[e]);
+		octants[(p.x >= centre.x ? 1 : 0) | (p.y >= centre.y ? 2 : 0) | (p.z >= centre.z ? 4 : 0)].push_back(e);
+	}
+
+	// all in one octant means they all share a position, no point subdividing further
+	for (int i = 0; i < 8; i++) {
+		if (octants[i].size() == entries.size()) {
+			m_nodes[nodeIdx].entries.swap(entries);
+			return nodeIdx;
+		}
+	}
+
+	entries.clear();
+	for (int i = 0; i < 8; i++) {
+		if (!octants[i].empty()) {
+			const int child = BuildNode(octants[i], depth + 1);
+			m_nodes[nodeIdx].children[i] = child;
+		}
 	}
+	return nodeIdx;
 }
 
-void FactionOctsapling::PruneDuplicates(const int bx, const int by, const int bz)
+void FactionOctree::Query(int nodeIdx, const Aabb &box, std::vector<Uint32> &outEntries) const
 {
-	PROFILE_SCOPED()
-	FactionList vec = octbox[bx][by][bz];
-	octbox[bx][by][bz].erase(std::unique( octbox[bx][by][bz].begin(), octbox[bx][by][bz].end() ), octbox[bx][by][bz].end() );
+	const Node &node = m_nodes[nodeIdx];
+	if (!node.bounds.Intersects(box))
+		return;
+
+	for (Uint32 e : node.entries)
+		if (m_entries[e].bounds.Intersects(box))
+			outEntries.push_back(e);
+
+	for (int i = 0; i < 8; i++)
+		if (node.children[i] >= 0)
+			Query(node.children[i], box, outEntries);
 }
 
-const std::vector<Faction*>& FactionOctsapling::CandidateFactions(RefCountedPtr<const Sector> sec, Uint32 sysIndex)
+void FactionOctree::CandidateFactions(const Aabb &box, std::vector<Uint32> &outEntries) const
 {
 	PROFILE_SCOPED()
-	/* answer the factions that we've put in the same octobox cell as the one the
-	   system would go in. This part happens every time we do GetNearest faction
-	   so *is* performance criticale.e
+	/* This part happens every time we do GetNearestFaction, so *is* performance critical.
+	   While the factions are being generated the tree can be out of date, in that case
+	   (and only then, as it isn't thread safe) it's rebuilt first.
 	*/
-	Sector::System sys = sec->m_systems[sysIndex];
-	return octbox[BoxIndex(sys.sx)][BoxIndex(sys.sy)][BoxIndex(sys.sz)];
+	if (m_dirty)
+		const_cast<FactionOctree*>(this)->Build();
+
+	outEntries.clear();
+	outEntries.insert(outEntries.end(), m_unplaced.begin(), m_unplaced.end());
+	if (!m_nodes.empty())
+		Query(0, box, outEntries);
+
+	// candidates are checked in the order the factions were added, as that decides ties
+	std::sort(outEntries.begin(), outEntries.end());
 }
@@ -8,6 +8,7 @@
 #include "galaxy/StarSystem.h"
 #include "Polit.h"
 #include "vector3.h"
+#include "Aabb.h"
 #include "fixed.h"
 #include "DeleteEmitter.h"
 #include <map>
@@ -25,6 +26,8 @@ public:
 	static Faction *GetFaction       (const Uint32 index);
 	static Faction *GetFaction       (const std::string& factionName);
 	static Faction *GetNearestFaction(RefCountedPtr<const Sector> sec, Uint32 sysIndex);
+	// nearest faction of every system in the sector, using one spatial lookup for the whole sector
+	static void     GetNearestFactions(RefCountedPtr<const Sector> sec, std::vector<Faction*> &outFactions);
 	static bool     IsHomeSystem     (const SystemPath& sysPath);
 
 	static const Uint32 GetNumFactions();
@@ -82,23 +85,58 @@ private:
 
 	RefCountedPtr<const Sector> m_homesector;	// cache of home sector to use in distance calculations
 	const bool IsCloserAndContains(double& closestFactionDist, RefCountedPtr<const Sector> sec, Uint32 sysIndex);
+
+	static Faction *NearestFactionFromCandidates(RefCountedPtr<const Sector> sec, Uint32 sysIndex, const std::vector<Uint32> &candidates);
 };
 
-/* One day it might grow up to become a full tree, on the  other hand it might be
-   cut down before it's full growth to be replaced by
-   a proper spatial data structure.
-*/
+/* Octree over the faction homeworlds. The bounds of every node enclose the
+   whole volume its factions can claim (the sphere of influence plus the home
+   sector), so a lookup only descends into branches that may contain the
+   point or box asked about.
 
-class FactionOctsapling {
+   Factions without a homeworld, or whose homeworld system didn't exist when
+   they were added, can't be placed and are returned for every lookup.
+*/
+class FactionOctree {
 public:
+	FactionOctree() : m_dirty(false) {}
+
 	void Add(Faction* faction);
-	const std::vector<Faction*>& CandidateFactions(RefCountedPtr<const Sector> sec, Uint32 sysIndex);
+	void Clear();
+	// (re)builds the tree if factions were added since the last build.
+	// Lookups must not run concurrently with a build.
+	void Build();
+
+	// entries of the factions that may claim any point inside box, in the order the factions were added
+	void CandidateFactions(const Aabb &box, std::vector<Uint32> &outEntries) const;
+
+	struct Entry {
+		Faction *faction;
+		bool     placed;     // homeworld position is known
+		vector3f homePos;    // homeworld position within its sector
+		Sint32   homeSector[3];
+		Aabb     bounds;     // everything the faction may claim, in lightyears
+	};
+	const Entry &GetEntry(Uint32 i) const { return m_entries[i]; }
 
 private:
-	std::vector<Faction*> octbox[2][2][2];
-	const int BoxIndex(Sint32 sectorIndex) { return sectorIndex < 0 ? 0: 1; };
-	void PruneDuplicates(const int bx, const int by, const int bz);
+	static const unsigned MAX_LEAF_ENTRIES = 4;
+	static const unsigned MAX_DEPTH        = 10;
+
+	struct Node {
+		Aabb                bounds;      // union of the bounds of all entries below
+		int                 children[8]; // -1 for none
+		std::vector<Uint32> entries;     // only in leaves
+	};
+
+	static vector3d HomePosition(const Entry &entry);
+	int BuildNode(std::vector<Uint32> &entries, unsigned depth);
+	void Query(int nodeIdx, const Aabb &box, std::vector<Uint32> &outEntries) const;
+
+	std::vector<Entry>  m_entries;
+	std::vector<Uint32> m_unplaced;
+	std::vector<Node>   m_nodes;
+	bool                m_dirty;
 };
 
-
 #endif /* _FACTIONS_H */
@@ -95,18 +95,22 @@ bool FileSourceZip::FindDirectoryAndFile(const std::string &path, const Director
 	return true;
 }
 
-FileInfo FileSourceZip::Lookup(const std::string &path)
+const FileSourceZip::FileStat *FileSourceZip::FindFile(const std::string &path) const
 {
-	const Directory *dir;
-	std::string filename;
-	if (!FindDirectoryAndFile(path, dir, filename))
-		return MakeFileInfo(path, FileInfo::FT_NON_EXISTENT);
+	std::string key = NormalisePath(path);
+	if (!key.empty() && key[0] == '/')
+		key.erase(0, 1);
+	std::unordered_map<std::string, const FileStat*>::const_iterator i = m_index.find(key);
+	return (i != m_index.end()) ? (*i).second : 0;
+}
 
-	std::map<std::string,FileStat>::const_iterator i = dir->files.find(filename);
-	if (i == dir->files.end())
+FileInfo FileSourceZip::Lookup(const std::string &path)
+{
+	const FileStat *st = FindFile(path);
+	if (!st)
 		return MakeFileInfo(path, FileInfo::FT_NON_EXISTENT);
 
-	return (*i).second.info;
+	return st->info;
 }
 
 RefCountedPtr<FileData> FileSourceZip::ReadFile(const std::string &path)
@@ -114,24 +118,18 @@ RefCountedPtr<FileData> FileSourceZip::ReadFile(const std::string &path)
 	if (!m_archive) return RefCountedPtr<FileData>();
 	mz_zip_archive *zip = static_cast<mz_zip_archive*>(m_archive);
 
-	const Directory *dir;
-	std::string filename;
-	if (!FindDirectoryAndFile(path, dir, filename))
-		return RefCountedPtr<FileData>();
-
-	std::map<std::string,FileStat>::const_iterator i = dir->files.find(filename);
-	if (i == dir->files.end())
+	const FileStat *st = FindFile(path);
+	if (!st)
 		return RefCountedPtr<FileData>();
 
-	const FileStat &st = (*i).second;
-
-	char *data = static_cast<char*>(std::malloc(st.size));
-	if (!mz_zip_reader_extract_to_mem(zip, st.index, data, st.size, 0)) {
+	char *data = static_cast<char*>(std::malloc(st->size));
+	if (!mz_zip_reader_extract_to_mem(zip, st->index, data, st->size, 0)) {
 		Output("FileSourceZip::ReadFile: couldn't extract '%s'\n", path.c_str());
+		std::free(data);
 		return RefCountedPtr<FileData>();
 	}
 
-	return RefCountedPtr<FileData>(new FileDataMalloc(st.info, st.size, data));
+	return RefCountedPtr<FileData>(new FileDataMalloc(st->info, st->size, data));
 }
 
 bool FileSourceZip::ReadDirectory(const std::string &path, std::vector<FileInfo> &output)
@@ -154,6 +152,14 @@ bool FileSourceZip::ReadDirectory(const std::string &path, std::vector<FileInfo>
 	return true;
 }
 
+bool FileSourceZip::ListPaths(std::vector<std::string> &output)
+{
+	// the archive is read once when it is opened
+	for (std::unordered_map<std::string, const FileStat*>::const_iterator i = m_index.begin(); i != m_index.end(); ++i)
+		output.push_back((*i).first);
+	return true;
+}
+
 void FileSourceZip::AddFile(const std::string &path, const FileStat &fileStat)
 {
 	std::vector<std::string> fragments;
@@ -162,26 +168,30 @@ void FileSourceZip::AddFile(const std::string &path, const FileStat &fileStat)
 	assert(fragments.size() > 0);
 
 	Directory *dir = &m_root;
+	std::string fullPath;
 
 	if (fragments.size() > 1) {
-		std::string fullPath;
-
 		for (unsigned int i = 0; i < fragments.size()-1; i++) {
 			fullPath += ((i > 0) ? "/" : "") + fragments[i];
 
 			std::map<std::string,FileStat>::const_iterator it = dir->files.find(fragments[i]);
-			if (it == dir->files.end())
-				dir->files.insert(std::make_pair(fragments[i], FileStat(Uint32(-1), 0, MakeFileInfo(fullPath, FileInfo::FT_DIR))));
+			if (it == dir->files.end()) {
+				it = dir->files.insert(std::make_pair(fragments[i], FileStat(Uint32(-1), 0, MakeFileInfo(fullPath, FileInfo::FT_DIR)))).first;
+				m_index.insert(std::make_pair(fullPath, &(*it).second));
+			}
 			dir = &(dir->subdirs[fragments[i]]);
 		}
 	}
 
 	const std::string &filename = fragments.back();
+	fullPath += (fragments.size() > 1 ? "/" : "") + filename;
 
 	if (fileStat.info.IsDir())
 		dir->subdirs.insert(std::make_pair(filename, Directory()));
 
-	dir->files.insert(std::make_pair(filename, fileStat));
+	// std::map nodes don't move, so the index can point into the tree
+	std::map<std::string,FileStat>::const_iterator it = dir->files.insert(std::make_pair(filename, fileStat)).first;
+	m_index.insert(std::make_pair(fullPath, &(*it).second));
 }
 
 }
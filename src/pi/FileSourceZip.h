@@ -8,6 +8,7 @@
 #include <SDL_stdinc.h>
 #include <map>
 #include <string>
+#include <unordered_map>
 
 namespace FileSystem {
 
@@ -21,6 +22,7 @@ public:
 	virtual FileInfo Lookup(const std::string &path);
 	virtual RefCountedPtr<FileData> ReadFile(const std::string &path);
 	virtual bool ReadDirectory(const std::string &path, std::vector<FileInfo> &output);
+	virtual bool ListPaths(std::vector<std::string> &output);
 
 private:
 	void *m_archive;
@@ -38,8 +40,11 @@ private:
 	};
 
 	Directory m_root;
+	// every entry of the tree above by its full path, for Lookup and ReadFile
+	std::unordered_map<std::string, const FileStat*> m_index;
 
 	bool FindDirectoryAndFile(const std::string &path, const Directory* &dir, std::string &filename);
+	const FileStat *FindFile(const std::string &path) const;
 	void AddFile(const std::string &path, const FileStat &fileStat);
 };
 
@@ -19,6 +19,10 @@ namespace FileSystem {
 	FileSourceUnion gameDataFiles;
 	FileSourceFS userFiles(GetUserDir());
 
+	// big enough that mapping beats a read into a fresh buffer; textures,
+	// heightmaps and binary models are well above it
+	static const size_t DATA_MAP_THRESHOLD = 256 * 1024;
+
 	// note: some functions (GetUserDir(), GetDataDir()) are in FileSystem{Posix,Win32}.cpp
 	std::string SanitiseFileName(const std::string &a)
 	{
@@ -123,6 +127,8 @@ namespace FileSystem {
 
 	void Init()
 	{
+		// the install directory is never written to, unlike the user's
+		dataFilesApp.SetMapThreshold(DATA_MAP_THRESHOLD);
 		gameDataFiles.AppendSource(&dataFilesUser);
 		gameDataFiles.AppendSource(&dataFilesApp);
 	}
@@ -151,35 +157,76 @@ namespace FileSystem {
 		return FileInfo(this, path, fileType);
 	}
 
-	FileSourceUnion::FileSourceUnion(): FileSource(":union:") {}
+	FileSourceUnion::FileSourceUnion(): FileSource(":union:"), m_generation(0) {}
 	FileSourceUnion::~FileSourceUnion() {}
 
 	void FileSourceUnion::PrependSource(FileSource *fs)
 	{
 		assert(fs);
-		RemoveSource(fs);
+		EraseSource(fs);
 		m_sources.insert(m_sources.begin(), fs);
+		RebuildIndex();
 	}
 
 	void FileSourceUnion::AppendSource(FileSource *fs)
 	{
 		assert(fs);
-		RemoveSource(fs);
+		EraseSource(fs);
 		m_sources.push_back(fs);
+		RebuildIndex();
 	}
 
 	void FileSourceUnion::RemoveSource(FileSource *fs)
+	{
+		EraseSource(fs);
+		RebuildIndex();
+	}
+
+	void FileSourceUnion::EraseSource(FileSource *fs)
 	{
 		std::vector<FileSource*>::iterator nend = std::remove(m_sources.begin(), m_sources.end(), fs);
 		m_sources.erase(nend, m_sources.end());
 	}
 
+	void FileSourceUnion::RebuildIndex()
+	{
+		m_index.clear();
+		m_indexed.assign(m_sources.size(), false);
+		std::vector<std::string> paths;
+		for (unsigned int i = 0; i < m_sources.size(); i++) {
+			paths.clear();
+			if (!m_sources[i]->ListPaths(paths))
+				continue;
+			m_indexed[i] = true;
+			// insert keeps the entry of an earlier source
+			for (std::vector<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+				m_index.insert(std::make_pair(*it, i));
+		}
+		m_generation++;
+	}
+
+	// the position of the first listing source with the path,
+	// past the end if none has it
+	unsigned int FileSourceUnion::FindIndexed(const std::string &path) const
+	{
+		if (m_index.empty())
+			return m_sources.size();
+		std::string key = NormalisePath(path);
+		if (!key.empty() && key[0] == '/')
+			key.erase(0, 1);
+		std::unordered_map<std::string, unsigned int>::const_iterator it = m_index.find(key);
+		return (it != m_index.end()) ? it->second : m_sources.size();
+	}
+
+	// Listing sources before the first one with the path don't have it and
+	// are skipped, so a path only costs a lookup in the sources that list
+	// their paths when one of them has it. Everything else is asked in order
 	FileInfo FileSourceUnion::Lookup(const std::string &path)
 	{
-		for (std::vector<FileSource*>::const_iterator
-			it = m_sources.begin(); it != m_sources.end(); ++it)
-		{
-			FileInfo info = (*it)->Lookup(path);
+		const unsigned int first = FindIndexed(path);
+		for (unsigned int i = 0; i < m_sources.size(); i++) {
+			if (m_indexed[i] && i < first) continue;
+			FileInfo info = m_sources[i]->Lookup(path);
 			if (info.Exists()) { return info; }
 		}
 		return MakeFileInfo(path, FileInfo::FT_NON_EXISTENT);
@@ -187,10 +234,10 @@ namespace FileSystem {
 
 	RefCountedPtr<FileData> FileSourceUnion::ReadFile(const std::string &path)
 	{
-		for (std::vector<FileSource*>::const_iterator
-			it = m_sources.begin(); it != m_sources.end(); ++it)
-		{
-			RefCountedPtr<FileData> data = (*it)->ReadFile(path);
+		const unsigned int first = FindIndexed(path);
+		for (unsigned int i = 0; i < m_sources.size(); i++) {
+			if (m_indexed[i] && i < first) continue;
+			RefCountedPtr<FileData> data = m_sources[i]->ReadFile(path);
 			if (data) { return data; }
 		}
 		return RefCountedPtr<FileData>();
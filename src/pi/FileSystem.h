@@ -11,6 +11,7 @@
 #include <vector>
 #include <deque>
 #include <memory>
+#include <unordered_map>
 
 /*
  * Functionality:
@@ -160,6 +161,12 @@ namespace FileSystem {
 		virtual RefCountedPtr<FileData> ReadFile(const std::string &path) = 0;
 		virtual bool ReadDirectory(const std::string &path, std::vector<FileInfo> &output) = 0;
 
+		// sources whose contents can't change once opened (archives) add
+		// the normalised path, without a leading '/', of every file and
+		// directory they hold and return true. A union then only asks them
+		// for paths they have. Others return false and are always asked
+		virtual bool ListPaths(std::vector<std::string> &output) { return false; }
+
 		bool IsTrusted() const { return m_trusted; }
 
 	protected:
@@ -181,6 +188,12 @@ namespace FileSystem {
 
 		bool MakeDirectory(const std::string &path);
 
+		// files of at least this size are mapped into memory instead of
+		// read into a buffer, 0 (the default) never maps. Only for
+		// directories the game does not write to: a mapped file that is
+		// truncated faults on access. Posix only for now
+		void SetMapThreshold(size_t size) { m_mapThreshold = size; }
+
 		enum WriteFlags {
 			WRITE_TEXT = 1
 		};
@@ -189,6 +202,13 @@ namespace FileSystem {
 		FILE* OpenReadStream(const std::string &path);
 		// similar to fopen(path, "wb")
 		FILE* OpenWriteStream(const std::string &path, int flags = 0);
+
+		// replaces to if it exists, so a file can be written under a
+		// temporary name and moved into place once it is complete
+		bool RenameFile(const std::string &from, const std::string &to);
+
+	private:
+		size_t m_mapThreshold;
 	};
 
 	class FileSourceUnion : public FileSource {
@@ -203,12 +223,25 @@ namespace FileSystem {
 		void AppendSource(FileSource *fs);
 		void RemoveSource(FileSource *fs);
 
+		// changes whenever the sources do, for things that cache lookups
+		unsigned int GetGeneration() const { return m_generation; }
+
 		virtual FileInfo Lookup(const std::string &path);
 		virtual RefCountedPtr<FileData> ReadFile(const std::string &path);
 		virtual bool ReadDirectory(const std::string &path, std::vector<FileInfo> &output);
 
 	private:
+		void EraseSource(FileSource *fs);
+		void RebuildIndex();
+		unsigned int FindIndexed(const std::string &path) const;
+
 		std::vector<FileSource*> m_sources;
+		unsigned int m_generation;
+
+		// every path in the sources that list them, to the position of
+		// the first of those sources that has it
+		std::unordered_map<std::string, unsigned int> m_index;
+		std::vector<bool> m_indexed;
 	};
 
 	class FileEnumerator {
@@ -90,6 +90,10 @@ public:
 
 	static void GetFrameTransform(const Frame *fFrom, const Frame *fTo, matrix4x4d &m);
 
+	// relative to the root frame, as of the last physics update
+	const vector3d &GetRootPosition() const { return m_rootPos; }
+	const matrix3x3d &GetRootOrient() const { return m_rootOrient; }
+
 private:
 	void Init(Frame *parent, const char *label, unsigned int flags);
 	void UpdateRootRelativeVars();
@@ -11,6 +11,7 @@ GameConfig::GameConfig(const std::map<std::string,std::string> &override_)
 	std::map<std::string, std::string> &map = m_map[""];
 	map["Lang"] = "en";
 	map["DisableSound"] = "0";
+	map["RendererName"] = "OpenGL"; // or "Dummy" to draw nothing and count renderer calls
 	map["StartFullscreen"] = "0";
 	map["ScrWidth"] = "800";
 	map["ScrHeight"] = "600";
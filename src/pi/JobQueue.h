@@ -144,6 +144,9 @@ public:
 	// finished jobs (not cancelled)
 	Uint32 FinishJobs();
 
+	// number of jobs that can run at the same time
+	Uint32 GetNumRunners() const { return m_runners.size(); }
+
 private:
 	friend class JobRunner;
 	Job *GetJob();
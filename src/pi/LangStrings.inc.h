@@ -10,6 +10,7 @@ DECLARE_STRING(VID_CONNECTING)
 DECLARE_STRING(NUMBER_TONNES)
 DECLARE_STRING(NUMBER_G)
 DECLARE_STRING(NUMBER_LY)
+DECLARE_STRING(NUMBER_JUMPS)
 DECLARE_STRING(NUMBER_HOURS)
 DECLARE_STRING(NUMBER_DAYS)
 DECLARE_STRING(VIEW)
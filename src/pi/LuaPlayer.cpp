@@ -257,7 +257,7 @@ static int l_set_hyperspace_target(lua_State *l)
 			RefCountedPtr<StarSystem> sys = StarSystemCache::GetCached(path);
 			// Lua should never be able to get an invalid SystemPath
 			// (note: this may change if it becomes possible to remove systems during the game)
-			assert(size_t(path.bodyIndex) < sys->m_bodies.size());
+			assert(size_t(path.bodyIndex) < sys->GetNumBodies());
 			SystemBody *sbody = sys->GetBodyByPath(path);
 			if (!sbody->GetSuperType() == SystemBody::SUPERTYPE_STAR)
 				return luaL_error(l, "Player:SetHyperspaceTarget() -- second parameter is not a system path or the path of a star");
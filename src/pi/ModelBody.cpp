@@ -65,6 +65,7 @@ ModelBody::ModelBody()
 : m_isStatic(false)
 , m_geom(0)
 , m_model(0)
+, m_modelAcquired(false)
 {
 }
 
@@ -75,6 +76,8 @@ ModelBody::~ModelBody()
 
 	//delete instanced model
 	delete m_model;
+	if (m_modelAcquired)
+		Pi::modelCache->ReleaseModel(m_modelName);
 }
 
 void ModelBody::SetStatic(bool isStatic)
@@ -140,11 +143,24 @@ void ModelBody::SetModel(const char *modelName)
 	//remove old instance
 	delete m_model;
 	m_model = 0;
+	if (m_modelAcquired) {
+		Pi::modelCache->ReleaseModel(m_modelName);
+		m_modelAcquired = false;
+	}
 
 	m_modelName = modelName;
 
 	//create model instance (some modelbodies, like missiles could avoid this)
-	m_model = Pi::FindModel(m_modelName)->MakeInstance();
+	//the reference keeps the cache from dropping the model while it is used
+	SceneGraph::Model *model;
+	try {
+		model = Pi::modelCache->AcquireModel(m_modelName);
+		m_modelAcquired = true;
+	} catch (ModelCache::ModelNotFoundException) {
+		//reports it and gives the placeholder
+		model = Pi::FindModel(m_modelName);
+	}
+	m_model = model->MakeInstance();
 	m_idleAnimation = m_model->FindAnimation("idle");
 
 	SetClipRadius(m_model->GetDrawClipRadius());
@@ -49,6 +49,7 @@ private:
 	Geom *m_geom; //static geom
 	std::string m_modelName;
 	SceneGraph::Model *m_model;
+	bool m_modelAcquired; //holds a reference in the model cache
 	std::vector<Geom*> m_dynGeoms;
 	SceneGraph::Animation *m_idleAnimation;
 };
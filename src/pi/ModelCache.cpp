@@ -3,9 +3,81 @@
 
 #include "ModelCache.h"
 #include "scenegraph/SceneGraph.h"
+#include "scenegraph/NodeVisitor.h"
+#include <set>
 
-ModelCache::ModelCache(Graphics::Renderer *r)
+// a few ms of a 60fps frame
+static const Uint32 DEFAULT_FINISH_BUDGET = 4;
+static const size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+
+// Only OnRun is called on the worker
+class ModelCache::ImportJob : public Job {
+public:
+	ImportJob(ModelCache *cache, SceneGraph::PreparedModel *prepared) :
+		m_cache(cache), m_prepared(prepared) {}
+
+	virtual void OnRun() {
+		m_prepared->Import();
+	}
+
+	virtual void OnFinish() {
+		const std::string name = m_prepared->GetName();
+		m_cache->OnImported(name, std::move(m_prepared));
+	}
+
+private:
+	ModelCache *m_cache;
+	std::unique_ptr<SceneGraph::PreparedModel> m_prepared;
+};
+
+namespace {
+// Adds up the vertex and index buffers, once each as
+// detail levels may share meshes
+class BufferSizeVisitor : public SceneGraph::NodeVisitor {
+public:
+	BufferSizeVisitor() : size(0) {}
+
+	virtual void ApplyStaticGeometry(SceneGraph::StaticGeometry &g) {
+		for (unsigned int i = 0; i < g.GetNumMeshes(); i++) {
+			const SceneGraph::StaticGeometry::Mesh &mesh = g.GetMeshAt(i);
+			if (mesh.vertexBuffer && m_seen.insert(mesh.vertexBuffer.Get()).second) {
+				const Graphics::VertexBufferDesc &desc = mesh.vertexBuffer->GetDesc();
+				size += size_t(desc.numVertices) * desc.stride;
+			}
+			if (mesh.indexBuffer && m_seen.insert(mesh.indexBuffer.Get()).second)
+				size += size_t(mesh.indexBuffer->GetSize()) * sizeof(Uint16);
+		}
+		ApplyNode(g);
+	}
+
+	size_t size;
+
+private:
+	std::set<const void*> m_seen;
+};
+}
+
+// out of line, PreparedModel is incomplete in the header
+ModelCache::Entry::Entry()
+: model(0)
+, refs(0)
+, pinned(false)
+, size(0)
+, lastUsed(0)
+{
+}
+
+ModelCache::Entry::~Entry()
+{
+}
+
+ModelCache::ModelCache(Graphics::Renderer *r, JobQueue *jobs)
 : m_renderer(r)
+, m_jobQueue(jobs)
+, m_finishBudget(DEFAULT_FINISH_BUDGET)
+, m_memoryBudget(DEFAULT_MEMORY_BUDGET)
+, m_memoryUsed(0)
+, m_frame(0)
 {
 
 }
@@ -16,26 +88,161 @@ ModelCache::~ModelCache()
 }
 
 SceneGraph::Model *ModelCache::FindModel(const std::string &name)
+{
+	Entry &entry = LoadEntry(name);
+	entry.pinned = true;
+	return entry.model;
+}
+
+SceneGraph::Model *ModelCache::AcquireModel(const std::string &name)
+{
+	Entry &entry = LoadEntry(name);
+	entry.refs++;
+	return entry.model;
+}
+
+void ModelCache::ReleaseModel(const std::string &name)
 {
 	ModelMap::iterator it = m_models.find(name);
+	assert(it != m_models.end() && it->second.refs > 0);
+	it->second.refs--;
+	it->second.lastUsed = m_frame;
+}
+
+void ModelCache::PrefetchModels(const std::vector<std::string> &names)
+{
+	PROFILE_SCOPED()
+	for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+		if (m_models.count(*it)) continue;
 
-	if (it == m_models.end()) {
+		std::unique_ptr<SceneGraph::PreparedModel> prepared(new SceneGraph::PreparedModel);
 		try {
 			SceneGraph::Loader loader(m_renderer);
-			SceneGraph::Model *m = loader.LoadModel(name);
-			m_models[name] = m;
-			return m;
+			loader.PrepareModel(*it, *prepared);
 		} catch (SceneGraph::LoadingError &) {
-			throw ModelNotFoundException();
+			continue;
 		}
+
+		Entry &entry = m_models[*it];
+		entry.job = m_jobQueue->Queue(new ImportJob(this, prepared.release()));
+	}
+}
+
+void ModelCache::OnImported(const std::string &name, std::unique_ptr<SceneGraph::PreparedModel> prepared)
+{
+	// Flush and FindModel cancel the import of the models they drop or load
+	ModelMap::iterator it = m_models.find(name);
+	assert(it != m_models.end() && !it->second.model);
+	it->second.prepared = std::move(prepared);
+	m_imported.push_back(name);
+}
+
+void ModelCache::Update()
+{
+	PROFILE_SCOPED()
+	const Uint32 start = SDL_GetTicks();
+	while (!m_imported.empty()) {
+		const std::string name = m_imported.front();
+		m_imported.pop_front();
+
+		// FindModel may have finished it already
+		ModelMap::iterator it = m_models.find(name);
+		if (it == m_models.end() || !it->second.prepared)
+			continue;
+
+		if (!FinishLoad(name, it->second))
+			Output("ModelCache: could not load prefetched model %s\n", name.c_str());
+
+		if (SDL_GetTicks() - start >= m_finishBudget)
+			break;
 	}
-	return it->second;
+
+	Evict();
+	m_frame++;
+}
+
+Uint32 ModelCache::GetNumPending() const
+{
+	Uint32 pending = 0;
+	for (ModelMap::const_iterator it = m_models.begin(); it != m_models.end(); ++it)
+		if (!it->second.model)
+			pending++;
+	return pending;
 }
 
 void ModelCache::Flush()
 {
 	for(ModelMap::iterator it = m_models.begin(); it != m_models.end(); ++it) {
-		delete it->second;
+		delete it->second.model;
 	}
 	m_models.clear();
+	m_imported.clear();
+	m_memoryUsed = 0;
+}
+
+ModelCache::Entry &ModelCache::LoadEntry(const std::string &name)
+{
+	Entry &entry = m_models[name];
+	// an import that is done but not delivered yet is still used
+	if (entry.job.HasJob())
+		m_jobQueue->FinishJobs();
+	if (!entry.model && !FinishLoad(name, entry))
+		throw ModelNotFoundException();
+
+	entry.lastUsed = m_frame;
+	return entry;
+}
+
+// loads the model from its import if that is done, from the files otherwise.
+// An entry that fails to load is removed
+bool ModelCache::FinishLoad(const std::string &name, Entry &entry)
+{
+	PROFILE_SCOPED()
+	if (entry.job.HasJob()) {
+		// destroying the handle cancels the import, it is done again here
+		JobHandle cancelled(std::move(entry.job));
+	}
+	std::unique_ptr<SceneGraph::PreparedModel> prepared(std::move(entry.prepared));
+
+	SceneGraph::Model *m = 0;
+	try {
+		SceneGraph::Loader loader(m_renderer);
+		m = prepared ? loader.LoadModel(*prepared) : loader.LoadModel(name);
+	} catch (SceneGraph::LoadingError &) {
+	}
+	if (!m) {
+		m_models.erase(name);
+		return false;
+	}
+
+	BufferSizeVisitor sizes;
+	m->GetRoot()->Accept(sizes);
+
+	entry.model = m;
+	entry.size = sizes.size;
+	entry.lastUsed = m_frame;
+	m_memoryUsed += entry.size;
+	return true;
+}
+
+void ModelCache::Evict()
+{
+	while (m_memoryUsed > m_memoryBudget) {
+		ModelMap::iterator oldest = m_models.end();
+		for (ModelMap::iterator it = m_models.begin(); it != m_models.end(); ++it) {
+			const Entry &entry = it->second;
+			if (!entry.model || entry.pinned || entry.refs > 0)
+				continue;
+			if (oldest == m_models.end() || entry.lastUsed < oldest->second.lastUsed)
+				oldest = it;
+		}
+		if (oldest == m_models.end())
+			break;
+
+		// instances share the buffers, so only models without
+		// references free anything
+		m_memoryUsed -= oldest->second.size;
+		delete oldest->second.model;
+		m_models.erase(oldest);
+	}
 }
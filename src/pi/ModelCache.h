@@ -4,29 +4,89 @@
 #ifndef _MODELCACHE_H
 #define _MODELCACHE_H
 /*
- * This class is a quick thoughtless hack
- * Also it only deals in New Models
+ * Keeps the loaded models, it only deals in New Models
  */
 #include "libs.h"
+#include "JobQueue.h"
+#include <deque>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace Graphics { class Renderer; }
-namespace SceneGraph { class Model; }
+namespace SceneGraph { class Model; class PreparedModel; }
 
+// Models can be loaded ahead of use with PrefetchModels. The model files are
+// read on the main thread and imported on a job worker; Update() then builds
+// the buffers, materials and collision meshes of the imported models on the
+// main thread, stopping once the frame's time budget is spent. FindModel
+// always returns a complete model, finishing a prefetched one or loading it
+// right there if the import is not done yet.
+//
+// Models taken with FindModel are kept until Flush, callers may hold on to
+// the pointer. AcquireModel counts references instead, and a model nobody
+// holds may be deleted, least recently used first, while the models use
+// more than the memory budget.
 class ModelCache {
 public:
 	struct ModelNotFoundException : public std::runtime_error {
 		ModelNotFoundException() : std::runtime_error("Could not find model") { }
 	};
-	ModelCache(Graphics::Renderer*);
+	ModelCache(Graphics::Renderer*, JobQueue*);
 	~ModelCache();
 	SceneGraph::Model *FindModel(const std::string&);
+
+	// every AcquireModel needs a ReleaseModel with the same name
+	SceneGraph::Model *AcquireModel(const std::string&);
+	void ReleaseModel(const std::string&);
+
+	// starts loading the models that are not loaded or loading yet. Names
+	// without a model are skipped, FindModel reports them
+	void PrefetchModels(const std::vector<std::string> &names);
+
+	// call once per frame, after JobQueue::FinishJobs
+	void Update();
+
+	// at least one model is finished per frame, even if it takes longer
+	void SetFinishBudget(Uint32 msPerFrame) { m_finishBudget = msPerFrame; }
+	// vertex and index buffer bytes of the loaded models
+	void SetMemoryBudget(size_t bytes) { m_memoryBudget = bytes; }
+	size_t GetMemoryUsed() const { return m_memoryUsed; }
+
+	// models still being imported or waiting to be finished
+	Uint32 GetNumPending() const;
+
 	void Flush();
 
 private:
-	typedef std::map<std::string, SceneGraph::Model*> ModelMap;
+	class ImportJob;
+
+	struct Entry {
+		Entry();
+		~Entry();
+		SceneGraph::Model *model; // null while loading
+		JobHandle job; // the import, destroying the handle cancels it
+		std::unique_ptr<SceneGraph::PreparedModel> prepared; // imported, waiting for Update
+		Uint32 refs;
+		bool pinned; // taken with FindModel
+		size_t size;
+		Uint32 lastUsed; // frame
+	};
+	typedef std::map<std::string, Entry> ModelMap;
+
+	Entry &LoadEntry(const std::string &name);
+	bool FinishLoad(const std::string &name, Entry &entry);
+	void OnImported(const std::string &name, std::unique_ptr<SceneGraph::PreparedModel> prepared);
+	void Evict();
+
 	ModelMap m_models;
+	std::deque<std::string> m_imported; // in the order the imports finished
 	Graphics::Renderer *m_renderer;
+	JobQueue *m_jobQueue;
+	Uint32 m_finishBudget;
+	size_t m_memoryBudget;
+	size_t m_memoryUsed;
+	Uint32 m_frame;
 };
 
 #endif
@@ -139,6 +139,7 @@ void ModelViewer::Run(const std::string &modelName)
 
 	//video
 	Graphics::Settings videoSettings = {};
+	videoSettings.rendererType = (config->String("RendererName") == "Dummy") ? Graphics::RENDERER_DUMMY : Graphics::RENDERER_OPENGL;
 	videoSettings.width = config->Int("ScrWidth");
 	videoSettings.height = config->Int("ScrHeight");
 	videoSettings.fullscreen = (config->Int("StartFullscreen") != 0);
@@ -722,8 +723,16 @@ void ModelViewer::SaveModelToBinary()
 
 	std::unique_ptr<SceneGraph::Model> model;
 	try {
-		SceneGraph::Loader ld(m_renderer);
+		//the optimized mesh order is saved with the model
+		SceneGraph::Loader ld(m_renderer, true);
+		ld.SetOptimizeMeshes(true);
 		model.reset(ld.LoadModel(m_modelName));
+
+		for (std::vector<std::string>::const_iterator it = ld.GetLogMessages().begin();
+			it != ld.GetLogMessages().end(); ++it)
+		{
+			AddLog(*it);
+		}
 	} catch (...) {
 		//minimal error handling, this is not expected to happen since we got this far.
 		AddLog("Could not load model");
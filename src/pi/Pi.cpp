@@ -54,6 +54,7 @@
 #include "graphics/Graphics.h"
 #include "graphics/Light.h"
 #include "graphics/Renderer.h"
+#include "graphics/TextureLoader.h"
 #include "gui/Gui.h"
 #include "scenegraph/Model.h"
 #include "scenegraph/Lua.h"
@@ -118,6 +119,7 @@ Intro *Pi::intro;
 SDLGraphics *Pi::sdl;
 
 std::unique_ptr<JobQueue> Pi::jobQueue;
+std::unique_ptr<Graphics::TextureLoader> Pi::textureLoader;
 
 static void draw_progress(UI::Gauge *gauge, UI::Label *label, float progress)
 {
@@ -262,6 +264,7 @@ void Pi::Init(const std::map<std::string,std::string> &options)
 
 	// Do rest of SDL video initialization and create Renderer
 	Graphics::Settings videoSettings = {};
+	videoSettings.rendererType = (config->String("RendererName") == "Dummy") ? Graphics::RENDERER_DUMMY : Graphics::RENDERER_OPENGL;
 	videoSettings.width = config->Int("ScrWidth");
 	videoSettings.height = config->Int("ScrHeight");
 	videoSettings.fullscreen = (config->Int("StartFullscreen") != 0);
@@ -302,6 +305,9 @@ void Pi::Init(const std::map<std::string,std::string> &options)
 	jobQueue.reset(new JobQueue(numThreads));
 	Output("started %d worker threads\n", numThreads);
 
+	textureLoader.reset(new Graphics::TextureLoader(renderer, jobQueue.get()));
+	renderer->SetTextureLoader(textureLoader.get());
+
 	// XXX early, Lua init needs it
 	ShipType::Init();
 
@@ -350,7 +356,7 @@ void Pi::Init(const std::map<std::string,std::string> &options)
 	Faction::SetHomeSectors();
 	draw_progress(gauge, label, 0.45f);
 
-	modelCache = new ModelCache(Pi::renderer);
+	modelCache = new ModelCache(Pi::renderer, jobQueue.get());
 	draw_progress(gauge, label, 0.5f);
 
 	draw_progress(gauge, label, 0.6f);
@@ -398,6 +404,8 @@ void Pi::Quit()
 	LuaUninit();
 	Gui::Uninit();
 	delete Pi::modelCache;
+	Pi::renderer->SetTextureLoader(nullptr);
+	textureLoader.reset();
 	delete Pi::renderer;
 	delete Pi::config;
 	StarSystemCache::ShrinkCache(SystemPath(), true);
@@ -721,6 +729,10 @@ void Pi::Start()
 
 		Pi::renderer->SwapBuffers();
 
+		jobQueue->FinishJobs();
+		modelCache->Update();
+		textureLoader->Update();
+
 		Pi::frameTime = 0.001f*(SDL_GetTicks() - last_time);
 		_time += Pi::frameTime;
 		last_time = SDL_GetTicks();
@@ -918,6 +930,8 @@ void Pi::MainLoop()
 		cpan->Update();
 
 		jobQueue->FinishJobs();
+		modelCache->Update();
+		textureLoader->Update();
 
 #if WITH_DEVKEYS
 		if (Pi::showDebugInfo && SDL_GetTicks() - last_stats > 1000) {
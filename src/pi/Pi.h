@@ -32,7 +32,7 @@ class UIView;
 class View;
 class WorldView;
 class SDLGraphics;
-namespace Graphics { class Renderer; }
+namespace Graphics { class Renderer; class TextureLoader; }
 namespace SceneGraph { class Model; }
 namespace UI { class Context; }
 
@@ -153,6 +153,7 @@ private:
 	static void InitJoysticks();
 
 	static std::unique_ptr<JobQueue> jobQueue;
+	static std::unique_ptr<Graphics::TextureLoader> textureLoader;
 
 	static bool menuDone;
 
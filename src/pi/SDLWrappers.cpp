@@ -14,7 +14,12 @@ SDLSurfacePtr LoadSurfaceFromFile(const std::string &fname, FileSystem::FileSour
 		return SDLSurfacePtr();
 	}
 
-	SDL_RWops *datastream = SDL_RWFromConstMem(filedata->GetData(), filedata->GetSize());
+	return LoadSurfaceFromData(*filedata, fname);
+}
+
+SDLSurfacePtr LoadSurfaceFromData(const FileSystem::FileData &filedata, const std::string &fname)
+{
+	SDL_RWops *datastream = SDL_RWFromConstMem(filedata.GetData(), filedata.GetSize());
 	SDL_Surface *surface = IMG_Load_RW(datastream, 1);
 	if (!surface) {
 		Output("LoadSurfaceFromFile: %s: %s\n", fname.c_str(), IMG_GetError());
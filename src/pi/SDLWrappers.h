@@ -6,7 +6,7 @@
 
 #include "SmartPtr.h"
 
-namespace FileSystem { class FileSource; }
+namespace FileSystem { class FileSource; class FileData; }
 
 struct SDL_Surface;
 
@@ -30,5 +30,8 @@ public:
 
 SDLSurfacePtr LoadSurfaceFromFile(const std::string &fname, FileSystem::FileSource &source);
 SDLSurfacePtr LoadSurfaceFromFile(const std::string &fname);
+// decodes an image read earlier, fname is only for messages. touches no file
+// system state, so it can be used from worker threads
+SDLSurfacePtr LoadSurfaceFromData(const FileSystem::FileData &filedata, const std::string &fname);
 
 #endif
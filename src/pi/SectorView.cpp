@@ -40,6 +40,12 @@ enum DetailSelection {
 
 static const float ZOOM_SPEED = 15;
 static const float WHEEL_SENSITIVITY = .03f;		// Should be a variable in user settings.
+// bounds on the route planner's memory and effort, enough for routes well past 1000ly
+static const size_t ROUTE_MAX_OPEN_SYSTEMS = 50000;
+static const size_t ROUTE_MAX_SECTORS = 8192;
+static const size_t ROUTE_MAX_EXPANDED = 20000;
+// routes at most 5% longer than the shortest, searching a fraction of the systems
+static const float ROUTE_HEURISTIC_WEIGHT = 1.05f;
 
 SectorView::SectorView() : UIView()
 {
@@ -230,6 +236,8 @@ void SectorView::InitObject()
 	hbox->PackEnd(m_targetSystemLabels.sector);
 	systemBox->PackEnd(hbox);
 	systemBox->PackEnd(m_targetSystemLabels.distance.label);
+	m_routeLabel = (new Gui::Label(""))->Color(0, 255, 0);
+	systemBox->PackEnd(m_routeLabel);
 	m_targetSystemLabels.starType = (new Gui::Label(""))->Color(255, 0, 255);
 	m_targetSystemLabels.shortDesc = (new Gui::Label(""))->Color(255, 0, 255);
 	systemBox->PackEnd(m_targetSystemLabels.starType);
@@ -364,60 +372,9 @@ void SectorView::OnSearchBoxKeyPress(const SDL_Keysym *keysym)
 		return;
 	} catch (SystemPath::ParseFailure) {}
 
-	bool gotMatch = false, gotStartMatch = false;
 	SystemPath bestMatch;
-	const std::string *bestMatchName = 0;
-
-	for (auto i = m_sectorCache->Begin(); i != m_sectorCache->End(); ++i)
-
-		for (unsigned int systemIndex = 0; systemIndex < (*i).second->m_systems.size(); systemIndex++) {
-			const Sector::System *ss = &((*i).second->m_systems[systemIndex]);
-
-			// compare with the start of the current system
-			if (strncasecmp(search.c_str(), ss->name.c_str(), search.size()) == 0) {
-
-				// matched, see if they're the same size
-				if (search.size() == ss->name.size()) {
-
-					// exact match, take it and go
-					SystemPath path = (*i).first;
-					path.systemIndex = systemIndex;
-					GotoSystem(path);
-					return;
-				}
-
-				// partial match at start of name
-				if (!gotMatch || !gotStartMatch || bestMatchName->size() > ss->name.size()) {
-
-					// don't already have one or its shorter than the previous
-					// one, take it
-					bestMatch = (*i).first;
-					bestMatch.systemIndex = systemIndex;
-					bestMatchName = &(ss->name);
-					gotMatch = gotStartMatch = true;
-				}
-
-				continue;
-			}
-
-			// look for the search term somewhere within the current system
-			if (pi_strcasestr(ss->name.c_str(), search.c_str())) {
-
-				// found it
-				if (!gotMatch || !gotStartMatch || bestMatchName->size() > ss->name.size()) {
-
-					// best we've found so far, take it
-					bestMatch = (*i).first;
-					bestMatch.systemIndex = systemIndex;
-					bestMatchName = &(ss->name);
-					gotMatch = true;
-				}
-			}
-		}
-
-	if (gotMatch) {
+	if (Sector::cache.GetNameIndex().FindBest(search, bestMatch) != SystemNameIndex::MATCH_NONE)
 		GotoSystem(bestMatch);
-	}
 }
 
 #define FFRAC(_x)	((_x)-floor(_x))
@@ -567,20 +524,20 @@ void SectorView::OnClickSystem(const SystemPath &path)
 		if (system->GetNumStars() > 1 && m_selected.IsBodyPath()) {
 			int i;
 			for (i = 0; i < system->GetNumStars(); ++i)
-				if (system->m_stars[i]->GetPath() == m_selected) break;
+				if (system->GetStars()[i]->GetPath() == m_selected) break;
 			if (i >= system->GetNumStars() - 1)
-				SetSelected(system->m_stars[0]->GetPath());
+				SetSelected(system->GetStars()[0]->GetPath());
 			else
-				SetSelected(system->m_stars[i+1]->GetPath());
+				SetSelected(system->GetStars()[i+1]->GetPath());
 		} else {
-			SetSelected(system->m_stars[0]->GetPath());
+			SetSelected(system->GetStars()[0]->GetPath());
 		}
 	} else {
 		if (m_selectionFollowsMovement) {
 			GotoSystem(path);
 		} else {
 			RefCountedPtr<StarSystem> system = StarSystemCache::GetCached(path);
-			SetSelected(system->m_stars[0]->GetPath());
+			SetSelected(system->GetStars()[0]->GetPath());
 		}
 	}
 }
@@ -760,17 +717,7 @@ void SectorView::UpdateSystemLabels(SystemLabels &labels, const SystemPath &path
 
 	RefCountedPtr<StarSystem> sys = StarSystemCache::GetCached(path);
 
-	std::string desc;
-	if (sys->GetNumStars() == 4) {
-		desc = Lang::QUADRUPLE_SYSTEM;
-	} else if (sys->GetNumStars() == 3) {
-		desc = Lang::TRIPLE_SYSTEM;
-	} else if (sys->GetNumStars() == 2) {
-		desc = Lang::BINARY_SYSTEM;
-	} else {
-		desc = sys->m_rootBody->GetAstroDescription();
-	}
-	labels.starType->SetText(desc);
+	labels.starType->SetText(sys->GetStarDescription());
 
 	if (path.IsBodyPath()) {
 		labels.systemName->SetText(sys->GetBodyByPath(path)->GetName());
@@ -786,6 +733,41 @@ void SectorView::UpdateSystemLabels(SystemLabels &labels, const SystemPath &path
 	if (m_detailBoxVisible == DETAILBOX_INFO) m_infoBox->ShowAll();
 }
 
+// Plans a multi-jump route to a hyperspace target that is out of range. The
+// search is spread over frames and only shown once it has finished.
+void SectorView::UpdateRoute()
+{
+	PROFILE_SCOPED()
+	const bool wanted = m_playerHyperspaceRange > 0.0f && !m_current.IsSameSystem(m_hyperspaceTarget)
+		&& Sector::DistanceBetween(GetCached(m_current), m_current.systemIndex, GetCached(m_hyperspaceTarget), m_hyperspaceTarget.systemIndex) > m_playerHyperspaceRange;
+	if (!wanted) {
+		if (m_routePlanner) {
+			m_routePlanner.reset();
+			m_routeLabel->SetText("");
+		}
+		return;
+	}
+
+	if (!m_routePlanner || !m_routePlanner->GetFrom().IsSameSystem(m_current) || !m_routePlanner->GetTo().IsSameSystem(m_hyperspaceTarget)
+			|| m_routePlanner->GetJumpRange() != m_playerHyperspaceRange) {
+		m_routePlanner.reset(new RoutePlanner(m_current, m_hyperspaceTarget, m_playerHyperspaceRange));
+		m_routePlanner->SetMemoryBudget(ROUTE_MAX_OPEN_SYSTEMS, ROUTE_MAX_SECTORS);
+		m_routePlanner->SetSearchLimit(ROUTE_MAX_EXPANDED);
+		m_routePlanner->SetHeuristicWeight(ROUTE_HEURISTIC_WEIGHT);
+		m_routeLabel->SetText("");
+	}
+
+	if (m_routePlanner->GetStatus() != RoutePlanner::SEARCHING)
+		return;
+
+	if (m_routePlanner->Update() == RoutePlanner::FOUND) {
+		char format[256];
+		snprintf(format, sizeof(format), "[ %s | %s ]", Lang::NUMBER_JUMPS, Lang::NUMBER_LY);
+		m_routeLabel->SetText(stringf(format,
+			formatarg("jumps", int(m_routePlanner->GetNumJumps())), formatarg("distance", m_routePlanner->GetDistance())));
+	}
+}
+
 void SectorView::OnToggleFaction(Gui::ToggleButton* button, bool pressed, Faction* faction)
 {
 	// hide or show the faction's systems depending on whether the button is pressed
@@ -1321,7 +1303,7 @@ void SectorView::Update()
 
 			if (!m_selected.IsSameSystem(new_selected)) {
 				RefCountedPtr<StarSystem> system = StarSystemCache::GetCached(new_selected);
-				SetSelected(system->m_stars[0]->GetPath());
+				SetSelected(system->GetStars()[0]->GetPath());
 			}
 		}
 	}
@@ -1329,6 +1311,7 @@ void SectorView::Update()
 	ShrinkCache();
 
 	m_playerHyperspaceRange = Pi::player->GetStats().hyperspace_range;
+	UpdateRoute();
 
 	if(!m_jumpSphere)
 	{
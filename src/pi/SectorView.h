@@ -11,6 +11,7 @@
 #include <set>
 #include <string>
 #include "View.h"
+#include "galaxy/RoutePlanner.h"
 #include "galaxy/Sector.h"
 #include "galaxy/SystemPath.h"
 #include "graphics/Drawables.h"
@@ -78,6 +79,7 @@ private:
 
 	void UpdateDistanceLabelAndLine(DistanceIndicator &distance, const SystemPath &src, const SystemPath &dest);
 	void UpdateSystemLabels(SystemLabels &labels, const SystemPath &path);
+	void UpdateRoute();
 	void UpdateFactionToggles();
 	void RefreshDetailBoxVisibility();
 
@@ -134,6 +136,8 @@ private:
 	SystemLabels m_targetSystemLabels;
 	DistanceIndicator m_secondDistance;
 	Gui::Label *m_hyperspaceLockLabel;
+	Gui::Label *m_routeLabel;
+	std::unique_ptr<RoutePlanner> m_routePlanner;
 
 	Gui::VBox *m_factionBox;
 	std::set<Faction*>              m_visibleFactions;
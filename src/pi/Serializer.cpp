@@ -92,6 +92,22 @@ void Writer::String(const std::string &s)
 	Byte(0);
 }
 
+void Writer::Blob(const void *data, size_t size)
+{
+	// same layout as String, so Reader::Blob skips the terminator
+	Int32(size+1);
+	m_str.append(static_cast<const char*>(data), size);
+	Byte(0);
+}
+
+void Writer::AlignedBlob(const void *data, size_t size, size_t alignment)
+{
+	Int32(size);
+	while (m_str.size() % alignment)
+		Byte(0);
+	m_str.append(static_cast<const char*>(data), size);
+}
+
 void Writer::Vector3f(vector3f vec)
 {
 	Float(vec.x);
@@ -210,20 +226,30 @@ ByteRange Reader::Blob()
 	int size = Int32();
 	if (size == 0) return ByteRange();
 
-	if (size > (m_data.end - m_at)) {
-		// XXX error condition -- exception? some kind of error state on the Reader?
-		assert(0 && "Serializer:Reader stream is truncated");
-		size = (m_data.end - m_at);
-	}
+	if (size < 0 || size > (m_data.end - m_at))
+		throw SavedGameCorruptException();
 
-	assert(size > 0);
-	assert(size <= (m_data.end - m_at));
 	ByteRange range = ByteRange(m_at, m_at + (size - 1)); // -1 to exclude the null terminator
 	m_at += size;
 	assert(m_at <= m_data.end);
 	return range;
 }
 
+ByteRange Reader::AlignedBlob(size_t alignment)
+{
+	const size_t size = Int32();
+	while ((m_at - m_data.begin) % alignment && m_at < m_data.end)
+		m_at++;
+
+	if (size > size_t(m_data.end - m_at))
+		throw SavedGameCorruptException();
+	if (size == 0) return ByteRange();
+
+	ByteRange range = ByteRange(m_at, size);
+	m_at += size;
+	return range;
+}
+
 std::string Reader::String()
 {
 	ByteRange range = Blob();
@@ -34,6 +34,11 @@ namespace Serializer {
 		void Double(double f);
 		void String(const char* s);
 		void String(const std::string &s);
+		// raw bytes, read back with Reader::Blob
+		void Blob(const void *data, size_t size);
+		// raw bytes starting at a multiple of alignment from the start of
+		// the stream, read back with Reader::AlignedBlob
+		void AlignedBlob(const void *data, size_t size, size_t alignment);
 		void Vector3f(vector3f vec);
 		void Vector3d(vector3d vec);
 		void WrQuaternionf(const Quaternionf &q);
@@ -67,6 +72,8 @@ namespace Serializer {
 		double Double ();
 		std::string String();
 		ByteRange Blob();
+		// points into the data, aligned if the data itself is
+		ByteRange AlignedBlob(size_t alignment);
 		vector3f Vector3f();
 		vector3d Vector3d();
 		Quaternionf RdQuaternionf();
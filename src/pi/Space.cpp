@@ -86,7 +86,7 @@ Space::Space(Game *game, const SystemPath &path)
 	m_rootFrame.reset(new Frame(0, Lang::SYSTEM));
 	m_rootFrame->SetRadius(FLT_MAX);
 
-	GenBody(m_game->GetTime(), m_starSystem->m_rootBody.Get(), m_rootFrame.get());
+	GenBody(m_game->GetTime(), m_starSystem->GetRootBody(), m_rootFrame.get());
 	m_rootFrame->UpdateOrbitRails(m_game->GetTime(), m_game->GetTimeStep());
 
 	GenSectorCache(&path);
@@ -251,7 +251,7 @@ void Space::RebuildSystemBodyIndex()
 	m_sbodyIndex.push_back(0);
 
 	if (m_starSystem)
-		AddSystemBodyToIndex(m_starSystem->m_rootBody.Get());
+		AddSystemBodyToIndex(m_starSystem->GetRootBody());
 
 	m_sbodyIndexValid = true;
 }
@@ -306,7 +306,7 @@ vector3d Space::GetHyperspaceExitPoint(const SystemPath &source, const SystemPat
 
 	Body *primary = 0;
 	if (dest.IsBodyPath()) {
-		assert(size_t(dest.bodyIndex) < m_starSystem->m_bodies.size());
+		assert(size_t(dest.bodyIndex) < m_starSystem->GetNumBodies());
 		primary = FindBodyForPath(&dest);
 		while (primary && primary->GetSystemBody()->GetSuperType() != SystemBody::SUPERTYPE_STAR) {
 			SystemBody* parent = primary->GetSystemBody()->GetParent();
@@ -9,6 +9,8 @@
 #include <cerrno>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <dirent.h>
 #include <unistd.h>
 
@@ -95,8 +97,43 @@ namespace FileSystem {
 		return data_path;
 	}
 
+	// The file's pages come straight from the page cache, no copy is made.
+	// The mapping is private and read only, so the data looks the same as
+	// a buffer read at open time, as long as the file is not truncated
+	class FileDataMapped : public FileData {
+	public:
+		FileDataMapped(const FileInfo &info, size_t size, void *data):
+			FileData(info, size, static_cast<char*>(data)) {}
+		virtual ~FileDataMapped() { munmap(m_data, m_size); }
+	};
+
+	// 0 if the file is smaller than threshold or can't be mapped
+	static void *map_file(const std::string &fullpath, size_t threshold, size_t &size)
+	{
+		const int fd = open(fullpath.c_str(), O_RDONLY);
+		if (fd == -1) return 0;
+
+		void *data = 0;
+		struct stat statinfo;
+		if (fstat(fd, &statinfo) == 0 && S_ISREG(statinfo.st_mode) && size_t(statinfo.st_size) >= threshold) {
+			size = statinfo.st_size;
+			data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED) {
+				data = 0;
+			} else {
+				// loaders read the whole file front to back, so start
+				// reading it in now and read ahead aggressively
+				madvise(data, size, MADV_SEQUENTIAL);
+				madvise(data, size, MADV_WILLNEED);
+			}
+		}
+		// the mapping keeps the file open
+		close(fd);
+		return data;
+	}
+
 	FileSourceFS::FileSourceFS(const std::string &root, bool trusted):
-		FileSource(absolute_path(root), trusted) {}
+		FileSource(absolute_path(root), trusted), m_mapThreshold(0) {}
 
 	FileSourceFS::~FileSourceFS() {}
 
@@ -122,6 +159,12 @@ namespace FileSystem {
 	RefCountedPtr<FileData> FileSourceFS::ReadFile(const std::string &path)
 	{
 		const std::string fullpath = JoinPathBelow(GetRoot(), path);
+		if (m_mapThreshold > 0) {
+			size_t size;
+			if (void *data = map_file(fullpath, m_mapThreshold, size))
+				return RefCountedPtr<FileData>(new FileDataMapped(MakeFileInfo(path, FileInfo::FT_FILE), size, data));
+		}
+
 		FILE *fl = fopen(fullpath.c_str(), "rb");
 		if (!fl) {
 			return RefCountedPtr<FileData>(0);
@@ -244,4 +287,11 @@ namespace FileSystem {
 		const std::string fullpath = JoinPathBelow(GetRoot(), path);
 		return fopen(fullpath.c_str(), (flags & WRITE_TEXT) ? "w" : "wb");
 	}
+
+	bool FileSourceFS::RenameFile(const std::string &from, const std::string &to)
+	{
+		const std::string fullfrom = JoinPathBelow(GetRoot(), from);
+		const std::string fullto = JoinPathBelow(GetRoot(), to);
+		return rename(fullfrom.c_str(), fullto.c_str()) == 0;
+	}
 }
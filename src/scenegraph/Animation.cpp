@@ -43,21 +43,22 @@ void Animation::Interpolate()
 
 	//go through channels and calculate transforms
 	for(ChannelIterator chan = m_channels.begin(); chan != m_channels.end(); ++chan) {
+		const AnimationKeys &keys = *chan->keys;
 		matrix4x4f trans = chan->node->GetTransform();
 
-		if (!chan->rotationKeys.empty()) {
+		if (!keys.rotationKeys.empty()) {
 			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
 			unsigned int frame = 0;
-			while (frame + 1 < chan->rotationKeys.size()) {
-				if (mtime < chan->rotationKeys[frame+1].time)
+			while (frame + 1 < keys.rotationKeys.size()) {
+				if (mtime < keys.rotationKeys[frame+1].time)
 					break;
 				frame++;
 			}
 
-			const RotationKey &a = chan->rotationKeys[frame];
+			const RotationKey &a = keys.rotationKeys[frame];
 			vector3f saved_position = trans.GetTranslate();
-			if (frame + 1 < chan->rotationKeys.size()) {
-				const RotationKey &b = chan->rotationKeys[frame + 1];
+			if (frame + 1 < keys.rotationKeys.size()) {
+				const RotationKey &b = keys.rotationKeys[frame + 1];
 				double diffTime = b.time - a.time;
 				assert(diffTime > 0.0);
 				const float factor = Clamp(float((mtime - a.time) / diffTime), 0.f, 1.f);
@@ -71,19 +72,19 @@ void Animation::Interpolate()
 		//scaling will not work without rotation since it would
 		//continously scale the transform (would have to add originalTransform or
 		//something to MT)
-		if (!chan->scaleKeys.empty() && !chan->rotationKeys.empty()) {
+		if (!keys.scaleKeys.empty() && !keys.rotationKeys.empty()) {
 			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
 			unsigned int frame = 0;
-			while (frame + 1 < chan->scaleKeys.size()) {
-				if (mtime < chan->scaleKeys[frame+1].time)
+			while (frame + 1 < keys.scaleKeys.size()) {
+				if (mtime < keys.scaleKeys[frame+1].time)
 					break;
 				frame++;
 			}
 
-			const ScaleKey &a = chan->scaleKeys[frame];
+			const ScaleKey &a = keys.scaleKeys[frame];
 			vector3f out;
-			if (frame + 1 < chan->scaleKeys.size()) {
-				const ScaleKey &b = chan->scaleKeys[frame + 1];
+			if (frame + 1 < keys.scaleKeys.size()) {
+				const ScaleKey &b = keys.scaleKeys[frame + 1];
 				double diffTime = b.time - a.time;
 				assert(diffTime > 0.0);
 				const float factor = Clamp(float((mtime - a.time) / diffTime), 0.f, 1.f);
@@ -94,19 +95,19 @@ void Animation::Interpolate()
 			trans.Scale(out.x, out.y, out.z);
 		}
 
-		if (!chan->positionKeys.empty()) {
+		if (!keys.positionKeys.empty()) {
 			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
 			unsigned int frame = 0;
-			while (frame + 1 < chan->positionKeys.size()) {
-				if (mtime < chan->positionKeys[frame+1].time)
+			while (frame + 1 < keys.positionKeys.size()) {
+				if (mtime < keys.positionKeys[frame+1].time)
 					break;
 				frame++;
 			}
 
-			const PositionKey &a = chan->positionKeys[frame];
+			const PositionKey &a = keys.positionKeys[frame];
 			vector3f out;
-			if (frame + 1 < chan->positionKeys.size()) {
-				const PositionKey &b = chan->positionKeys[frame + 1];
+			if (frame + 1 < keys.positionKeys.size()) {
+				const PositionKey &b = keys.positionKeys[frame + 1];
 				double diffTime = b.time - a.time;
 				assert(diffTime > 0.0);
 				const float factor = Clamp(float((mtime - a.time) / diffTime), 0.f, 1.f);
@@ -10,12 +10,18 @@
 #include "AnimationKey.h"
 namespace SceneGraph {
 
-class AnimationChannel {
-public:
-	AnimationChannel(MatrixTransform *t) : node(t) { }
+//keyframes are never changed after loading, copies of a channel
+//in model instances share them
+struct AnimationKeys : public RefCounted {
 	std::vector<PositionKey> positionKeys;
 	std::vector<RotationKey> rotationKeys;
 	std::vector<ScaleKey> scaleKeys;
+};
+
+class AnimationChannel {
+public:
+	AnimationChannel(MatrixTransform *t) : keys(new AnimationKeys), node(t) { }
+	RefCountedPtr<AnimationKeys> keys;
 	MatrixTransform *node;
 };
 
@@ -47,14 +47,16 @@ void BaseLoader::ConvertMaterialDefinition(const MaterialDefinition &mdef)
 	if (mdef.opacity < 100)
 		mat->diffuse.a = (float(mdef.opacity) / 100.f) * 255;
 
+	//textures are decoded in the background when the renderer supports it,
+	//placeholders are chosen to neither light up nor shine until then
 	if (!diffTex.empty())
-		mat->texture0 = Graphics::TextureBuilder::ModelSRGB(diffTex).GetOrCreateTexture(m_renderer, "model");
+		mat->texture0 = Graphics::TextureBuilder::ModelSRGB(diffTex).GetOrCreateTextureAsync(m_renderer, "model", Color::GRAY);
 	else
 		mat->texture0 = Graphics::TextureBuilder::GetWhiteTexture(m_renderer);
 	if (!specTex.empty())
-		mat->texture1 = Graphics::TextureBuilder::Model(specTex).GetOrCreateTexture(m_renderer, "model");
+		mat->texture1 = Graphics::TextureBuilder::Model(specTex).GetOrCreateTextureAsync(m_renderer, "model", Color::BLACK);
 	if (!glowTex.empty())
-		mat->texture2 = Graphics::TextureBuilder::Model(glowTex).GetOrCreateTexture(m_renderer, "model");
+		mat->texture2 = Graphics::TextureBuilder::Model(glowTex).GetOrCreateTextureAsync(m_renderer, "model", Color::BLACK);
 	//texture3 is reserved for pattern
 	//texture4 is reserved for color gradient
 
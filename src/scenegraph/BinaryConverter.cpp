@@ -1,6 +1,7 @@
 // Copyright © 2008-2013 Pioneer Developers. See AUTHORS.txt for details
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 #include "BinaryConverter.h"
+#include "ModelIndex.h"
 #include "NodeVisitor.h"
 #include "Parser.h"
 #include "FileSystem.h"
@@ -11,10 +12,33 @@ using namespace SceneGraph;
 // Attempt at version history:
 // 1: prototype
 // 2: converted StaticMesh to VertexBuffer
-const Uint32 SGM_VERSION = 2;
+// 3: collision mesh with prebuilt GeomTrees after the tags
+// 4: vertex and index buffers as aligned blobs, node types by index
+const Uint32 SGM_VERSION = 4;
 const std::string SGM_EXTENSION = ".sgm";
 const std::string SAVE_TARGET_DIR = "binarymodels";
 
+//hands the loaded dynamic GeomTrees to their nodes, in the order
+//CollisionVisitor created them
+class DynGeomTreeVisitor : public NodeVisitor
+{
+public:
+	DynGeomTreeVisitor(const std::vector<GeomTree*> &trees) : m_trees(trees), m_next(0) { }
+
+	virtual void ApplyCollisionGeometry(CollisionGeometry &cg) override
+	{
+		if (!cg.IsDynamic()) return;
+		cg.SetGeomTree(m_next < m_trees.size() ? m_trees[m_next] : nullptr);
+		m_next++;
+	}
+
+	bool AllAssigned() const { return m_next == m_trees.size(); }
+
+private:
+	const std::vector<GeomTree*> &m_trees;
+	size_t m_next;
+};
+
 class SaveHelperVisitor : public NodeVisitor
 {
 public:
@@ -91,6 +115,8 @@ void BinaryConverter::Save(const std::string& filename, Model* m)
 	for (unsigned int i = 0; i < m->GetNumTags(); i++)
 		wr.String(m->GetTagByIndex(i)->GetName().c_str());
 
+	SaveCollision(wr, m);
+
 	const std::string& data = wr.GetData();
 	const size_t nwritten = fwrite(data.data(), data.length(), 1, f);
 	fclose(f);
@@ -106,31 +132,17 @@ Model *BinaryConverter::Load(const std::string &filename)
 
 Model *BinaryConverter::Load(const std::string &shortname, const std::string &basepath)
 {
-	FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
-	for (FileSystem::FileEnumerator files(fileSource, basepath, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
-		const FileSystem::FileInfo &info = files.Current();
-		const std::string &fpath = info.GetPath();
-
-		//check it's the expected type
-		if (info.IsFile() && ends_with_ci(fpath, SGM_EXTENSION)) {
-			//check it's the wanted name & load it
-			const std::string name = info.GetName();
-
-			if (shortname == name.substr(0, name.length() - SGM_EXTENSION.length())) {
-				//curPath is used to find textures, patterns,
-				//possibly other data files for this model.
-				//Strip trailing slash
-				m_curPath = info.GetDir();
-				if (m_curPath[m_curPath.length()-1] == '/')
-					m_curPath = m_curPath.substr(0, m_curPath.length()-1);
-
-				RefCountedPtr<FileSystem::FileData> binfile = info.Read();
-				if (binfile.Valid()) {
-					Serializer::Reader rd(binfile->AsByteRange());
-					Model* model = CreateModel(rd);
-					return model;
-				}
-			}
+	const std::string fpath = ModelIndex::Find(basepath, shortname, SGM_EXTENSION);
+	if (!fpath.empty()) {
+		//curPath is used to find textures, patterns,
+		//possibly other data files for this model.
+		m_curPath = fpath.substr(0, fpath.rfind('/'));
+
+		RefCountedPtr<FileSystem::FileData> binfile = FileSystem::gameDataFiles.ReadFile(fpath);
+		if (binfile.Valid()) {
+			Serializer::Reader rd(binfile->AsByteRange());
+			Model* model = CreateModel(rd);
+			return model;
 		}
 	}
 
@@ -146,8 +158,10 @@ Model *BinaryConverter::CreateModel(Serializer::Reader &rd)
 		throw LoadingError("Not a binary model file");
 
 	const Uint32 version = rd.Int32();
-	if (version != 2)
+	if (version < 2 || version > SGM_VERSION)
 		throw LoadingError("Unsupported file version");
+	rd.SetStreamVersion(version);
+	m_nodeTypes.clear();
 
 	const std::string modelName = rd.String();
 
@@ -163,7 +177,16 @@ Model *BinaryConverter::CreateModel(Serializer::Reader &rd)
 	LoadAnimations(rd);
 
 	m_model->UpdateAnimations();
-	m_model->CreateCollisionMesh();
+
+	//tags are restored from the node flags, skip the names
+	bool haveCollision = false;
+	if (version >= 3) {
+		for (Uint32 numTags = rd.Int32(); numTags > 0; numTags--)
+			rd.String();
+		haveCollision = LoadCollision(rd);
+	}
+	if (!haveCollision)
+		m_model->CreateCollisionMesh();
 	if (m_patternsUsed) SetUpPatterns();
 
 	return m_model;
@@ -229,18 +252,18 @@ void BinaryConverter::SaveAnimations(Serializer::Writer &wr, Model *m)
 		for (const auto &chan : anim->GetChannels()) {
 			wr.String(chan.node->GetName());
 			//write pos/rot/scale keys
-			wr.Int32(chan.positionKeys.size());
-			for (const auto &pkey : chan.positionKeys) {
+			wr.Int32(chan.keys->positionKeys.size());
+			for (const auto &pkey : chan.keys->positionKeys) {
 				wr.Double(pkey.time);
 				wr.Vector3f(pkey.position);
 			}
-			wr.Int32(chan.rotationKeys.size());
-			for (const auto &rkey : chan.rotationKeys) {
+			wr.Int32(chan.keys->rotationKeys.size());
+			for (const auto &rkey : chan.keys->rotationKeys) {
 				wr.Double(rkey.time);
 				wr.WrQuaternionf(rkey.rotation);
 			}
-			wr.Int32(chan.scaleKeys.size());
-			for (const auto &skey : chan.scaleKeys) {
+			wr.Int32(chan.keys->scaleKeys.size());
+			for (const auto &skey : chan.keys->scaleKeys) {
 				wr.Double(skey.time);
 				wr.Vector3f(skey.scale);
 			}
@@ -265,64 +288,111 @@ void BinaryConverter::LoadAnimations(Serializer::Reader &rd)
 			for (Uint32 numKeys = rd.Int32(); numKeys > 0; numKeys--) {
 				const double ktime = rd.Double();
 				const vector3f kpos = rd.Vector3f();
-				chan.positionKeys.push_back(PositionKey(ktime, kpos));
+				chan.keys->positionKeys.push_back(PositionKey(ktime, kpos));
 			}
 			for (Uint32 numKeys = rd.Int32(); numKeys > 0; numKeys--) {
 				const double ktime = rd.Double();
 				const Quaternionf krot = rd.RdQuaternionf();
-				chan.rotationKeys.push_back(RotationKey(ktime, krot));
+				chan.keys->rotationKeys.push_back(RotationKey(ktime, krot));
 			}
 			for (Uint32 numKeys = rd.Int32(); numKeys > 0; numKeys--) {
 				const double ktime = rd.Double();
 				const vector3f kscale = rd.Vector3f();
-				chan.scaleKeys.push_back(ScaleKey(ktime, kscale));
+				chan.keys->scaleKeys.push_back(ScaleKey(ktime, kscale));
 			}
 		}
 		m_model->m_animations.push_back(anim);
 	}
 }
 
+void BinaryConverter::SaveCollision(Serializer::Writer &wr, Model *m)
+{
+	RefCountedPtr<CollMesh> collMesh = m->GetCollisionMesh();
+	wr.Bool(collMesh.Valid());
+	if (!collMesh.Valid()) return;
+
+	const Aabb &aabb = collMesh->GetAabb();
+	wr.Vector3d(aabb.min);
+	wr.Vector3d(aabb.max);
+	wr.Double(aabb.radius);
+	wr.Int32(collMesh->GetNumTriangles());
+
+	collMesh->GetGeomTree()->Save(wr);
+	const std::vector<GeomTree*> &dynTrees = collMesh->GetDynGeomTrees();
+	wr.Int32(dynTrees.size());
+	for (const auto tree : dynTrees)
+		tree->Save(wr);
+}
+
+bool BinaryConverter::LoadCollision(Serializer::Reader &rd)
+{
+	if (!rd.Bool()) return false;
+
+	//the trees are used as saved, nothing is welded or split again.
+	//If the data is damaged the mesh is built from the nodes instead
+	RefCountedPtr<CollMesh> collMesh(new CollMesh());
+	try {
+		Aabb &aabb = collMesh->GetAabb();
+		aabb.min = rd.Vector3d();
+		aabb.max = rd.Vector3d();
+		aabb.radius = rd.Double();
+		collMesh->SetNumTriangles(rd.Int32());
+
+		collMesh->SetGeomTree(new GeomTree(rd));
+		for (Uint32 numDyn = rd.Int32(); numDyn > 0; numDyn--)
+			collMesh->AddDynGeomTree(new GeomTree(rd));
+	} catch (const SavedGameCorruptException&) {
+		Output("%s: collision data is damaged, rebuilding\n", m_model->GetName().c_str());
+		return false;
+	}
+
+	DynGeomTreeVisitor dv(collMesh->GetDynGeomTrees());
+	m_model->m_root->Accept(dv);
+	if (!dv.AllAssigned()) {
+		Output("%s: collision data does not match the nodes, rebuilding\n", m_model->GetName().c_str());
+		return false;
+	}
+
+	m_model->m_collMesh = collMesh;
+	m_model->m_boundingRadius = collMesh->GetAabb().GetRadius();
+	return true;
+}
+
 ModelDefinition BinaryConverter::FindModelDefinition(const std::string &shortname)
 {
-	const std::string basepath = "models";
-
-	FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
-	for (FileSystem::FileEnumerator files(fileSource, basepath, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
-		const FileSystem::FileInfo &info = files.Current();
-		const std::string &fpath = info.GetPath();
-
-		//check it's the expected type
-		if (info.IsFile() && ends_with_ci(fpath, ".model")) {
-			//check it's the wanted name & load it
-			const std::string name = info.GetName();
-
-			if (shortname == name.substr(0, name.length()-6)) {
-				ModelDefinition modelDefinition;
-				try {
-					//curPath is used to find textures, patterns,
-					//possibly other data files for this model.
-					//Strip trailing slash
-					m_curPath = info.GetDir();
-					assert(!m_curPath.empty());
-					if (m_curPath[m_curPath.length()-1] == '/')
-						m_curPath = m_curPath.substr(0, m_curPath.length()-1);
-
-					Parser p(fileSource, fpath, m_curPath);
-					p.Parse(&modelDefinition);
-					return modelDefinition;
-				} catch (ParseError &err) {
-					Output("%s\n", err.what());
-					throw LoadingError(err.what());
-				}
-			}
-		}
+	const std::string fpath = ModelIndex::Find("models", shortname, ".model");
+	if (fpath.empty())
+		throw (LoadingError("File not found"));
+
+	ModelDefinition modelDefinition;
+	try {
+		//curPath is used to find textures, patterns,
+		//possibly other data files for this model.
+		m_curPath = fpath.substr(0, fpath.rfind('/'));
+		assert(!m_curPath.empty());
+
+		Parser p(FileSystem::gameDataFiles, fpath, m_curPath);
+		p.Parse(&modelDefinition);
+		return modelDefinition;
+	} catch (ParseError &err) {
+		Output("%s\n", err.what());
+		throw LoadingError(err.what());
 	}
-	throw (LoadingError("File not found"));
 }
 
 Node* BinaryConverter::LoadNode(Serializer::Reader &rd)
 {
-	const std::string ntype = rd.String();
+	std::string ntype;
+	if (rd.StreamVersion() >= 4) {
+		//a new type comes with its name, Node::Save
+		const Uint32 typeIndex = rd.Int32();
+		if (typeIndex == m_nodeTypes.size())
+			m_nodeTypes.push_back(rd.String());
+		else if (typeIndex > m_nodeTypes.size())
+			throw LoadingError("Bad node type");
+		ntype = m_nodeTypes[typeIndex];
+	} else
+		ntype = rd.String();
 	const std::string nname = rd.String();
 	//Output("Loading: %s %s\n", ntype.c_str(), nname.c_str());
 	const Uint32 nmask = rd.Int32();
@@ -39,6 +39,8 @@ private:
 	void LoadMaterials(Serializer::Reader&);
 	void SaveAnimations(Serializer::Writer&, Model* m);
 	void LoadAnimations(Serializer::Reader&);
+	void SaveCollision(Serializer::Writer&, Model* m);
+	bool LoadCollision(Serializer::Reader&);
 	ModelDefinition FindModelDefinition(const std::string&);
 
 	Node* LoadNode(Serializer::Reader&);
@@ -47,6 +49,7 @@ private:
 	static Label3D *LoadLabel3D(NodeDatabase&);
 
 	bool m_patternsUsed;
+	std::vector<std::string> m_nodeTypes; //in the order they appear in the file
 	std::map<std::string, std::function<Node*(NodeDatabase&)> > m_loaders;
 };
 }
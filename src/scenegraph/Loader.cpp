@@ -5,6 +5,8 @@
 #include "CollisionGeometry.h"
 #include "FileSystem.h"
 #include "LOD.h"
+#include "MeshOptimizer.h"
+#include "ModelIndex.h"
 #include "Parser.h"
 #include "SceneGraph.h"
 #include "StringF.h"
@@ -110,13 +112,128 @@ namespace {
 	private:
 		FileSystem::FileSource &m_fs;
 	};
+
+	// Serves the files a PreparedModel read ahead, so Assimp can run on a
+	// job worker. Asking for any other file is remembered instead of going
+	// to the file sources, the import is then done again on the main thread
+	class AssimpPreparedFileSystem : public Assimp::IOSystem
+	{
+	public:
+		typedef std::map<std::string, RefCountedPtr<FileSystem::FileData> > FileMap;
+
+		AssimpPreparedFileSystem(const FileMap &files): m_files(files), m_missed(false) {}
+		virtual ~AssimpPreparedFileSystem() {}
+
+		virtual bool Exists(const char *path) const
+		{
+			if (m_files.count(path)) return true;
+			m_missed = true;
+			return false;
+		}
+
+		virtual char getOsSeparator() const { return '/'; }
+
+		virtual Assimp::IOStream *Open(const char *path, const char *mode)
+		{
+			assert(mode[0] == 'r');
+			assert(!strchr(mode, '+'));
+			FileMap::const_iterator it = m_files.find(path);
+			if (it == m_files.end()) {
+				m_missed = true;
+				return 0;
+			}
+			return new AssimpFileReadStream(it->second);
+		}
+
+		virtual void Close(Assimp::IOStream *file)
+		{
+			delete file;
+		}
+
+		bool Missed() const { return m_missed; }
+
+	private:
+		const FileMap &m_files;
+		mutable bool m_missed;
+	};
+
+	const aiScene *ImportMesh(Assimp::Importer &importer, const std::string &filename)
+	{
+		//Removing components is suggested to optimize loading. We do not care about vtx colors now.
+		importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_COLORS);
+		importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, 65536);
+
+		//There are several optimizations assimp can do, intentionally skipping them now
+		return importer.ReadFile(
+			filename,
+			aiProcess_RemoveComponent	|
+			aiProcess_Triangulate		|
+			aiProcess_SortByPType		| //ignore point, line primitive types (collada dummy nodes seem to be fine)
+			aiProcess_GenUVCoords		|
+			aiProcess_FlipUVs			|
+			aiProcess_SplitLargeMeshes	|
+			aiProcess_GenSmoothNormals);  //only if normals not specified
+	}
+
+	const aiScene *ImportCollision(Assimp::Importer &importer, const std::string &filename)
+	{
+		//discard extra data
+		importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS,
+			aiComponent_COLORS    |
+			aiComponent_TEXCOORDS |
+			aiComponent_NORMALS   |
+			aiComponent_MATERIALS
+			);
+		return importer.ReadFile(
+			filename,
+			aiProcess_RemoveComponent |
+			aiProcess_Triangulate     |
+			aiProcess_PreTransformVertices //"bake" transformations so we can disregard the structure
+			);
+	}
 } // anonymous namespace
 
 namespace SceneGraph {
+PreparedModel::PreparedModel()
+{
+}
+
+PreparedModel::~PreparedModel()
+{
+}
+
+void PreparedModel::Import()
+{
+	//a scene is kept only if everything it needed was read ahead,
+	//failures are left for the main thread to report
+	for (std::set<std::string>::const_iterator it = m_meshNames.begin(); it != m_meshNames.end(); ++it) {
+		std::unique_ptr<Assimp::Importer> importer(new Assimp::Importer);
+		AssimpPreparedFileSystem *fs = new AssimpPreparedFileSystem(m_files);
+		importer->SetIOHandler(fs);
+		if (ImportMesh(*importer, *it) && !fs->Missed())
+			m_meshes[*it] = std::move(importer);
+	}
+	for (std::set<std::string>::const_iterator it = m_collisionNames.begin(); it != m_collisionNames.end(); ++it) {
+		std::unique_ptr<Assimp::Importer> importer(new Assimp::Importer);
+		AssimpPreparedFileSystem *fs = new AssimpPreparedFileSystem(m_files);
+		importer->SetIOHandler(fs);
+		if (ImportCollision(*importer, *it) && !fs->Missed())
+			m_collisions[*it] = std::move(importer);
+	}
+}
+
+const aiScene *PreparedModel::GetScene(const SceneMap &scenes, const std::string &filename) const
+{
+	SceneMap::const_iterator it = scenes.find(filename);
+	return (it != scenes.end()) ? it->second->GetScene() : 0;
+}
+
 Loader::Loader(Graphics::Renderer *r, bool logWarnings)
 : BaseLoader(r)
 , m_doLog(logWarnings)
 , m_mostDetailedLod(false)
+, m_optimizeMeshes(false)
+, m_prepared(0)
 {
 }
 
@@ -130,40 +247,68 @@ Model *Loader::LoadModel(const std::string &shortname, const std::string &basepa
 {
 	m_logMessages.clear();
 
-	FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
-	for (FileSystem::FileEnumerator files(fileSource, basepath, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next())
-	{
-		const FileSystem::FileInfo &info = files.Current();
-		const std::string &fpath = info.GetPath();
-
-		//check it's the expected type
-		if (info.IsFile() && ends_with_ci(fpath, ".model")) {
-			//check it's the wanted name & load it
-			const std::string name = info.GetName();
-
-			if (shortname == name.substr(0, name.length()-6)) {
-				ModelDefinition modelDefinition;
-				try {
-					//curPath is used to find textures, patterns,
-					//possibly other data files for this model.
-					//Strip trailing slash
-					m_curPath = info.GetDir();
-					assert(!m_curPath.empty());
-					if (m_curPath[m_curPath.length()-1] == '/')
-						m_curPath = m_curPath.substr(0, m_curPath.length()-1);
-
-					Parser p(fileSource, fpath, m_curPath);
-					p.Parse(&modelDefinition);
-				} catch (ParseError &err) {
-					Output("%s\n", err.what());
-					throw LoadingError(err.what());
-				}
-				modelDefinition.name = shortname;
-				return CreateModel(modelDefinition);
-			}
-		}
+	ModelDefinition modelDefinition;
+	ReadModelDefinition(shortname, basepath, modelDefinition);
+	return CreateModel(modelDefinition);
+}
+
+void Loader::PrepareModel(const std::string &shortname, PreparedModel &out)
+{
+	ReadModelDefinition(shortname, "models", out.m_definition);
+	out.m_path = m_curPath;
+
+	const ModelDefinition &def = out.m_definition;
+	for (std::vector<LodDefinition>::const_iterator lod = def.lodDefs.begin(); lod != def.lodDefs.end(); ++lod)
+		out.m_meshNames.insert((*lod).meshNames.begin(), (*lod).meshNames.end());
+	out.m_collisionNames.insert(def.collisionDefs.begin(), def.collisionDefs.end());
+
+	//a file that can't be read is not an error yet, LoadModel
+	//reports it when it tries again
+	std::set<std::string> names(out.m_meshNames);
+	names.insert(out.m_collisionNames.begin(), out.m_collisionNames.end());
+	for (std::set<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+		RefCountedPtr<FileSystem::FileData> data = FileSystem::gameDataFiles.ReadFile(*it);
+		if (data)
+			out.m_files[*it] = data;
 	}
-	throw (LoadingError("File not found"));
+}
+
+Model *Loader::LoadModel(PreparedModel &prepared)
+{
+	m_logMessages.clear();
+	m_curPath = prepared.m_path;
+
+	m_prepared = &prepared;
+	Model *model = 0;
+	try {
+		model = CreateModel(prepared.m_definition);
+	} catch (...) {
+		m_prepared = 0;
+		throw;
+	}
+	m_prepared = 0;
+	return model;
+}
+
+void Loader::ReadModelDefinition(const std::string &shortname, const std::string &basepath, ModelDefinition &modelDefinition)
+{
+	const std::string fpath = ModelIndex::Find(basepath, shortname, ".model");
+	if (fpath.empty())
+		throw (LoadingError("File not found"));
+
+	try {
+		//curPath is used to find textures, patterns,
+		//possibly other data files for this model.
+		m_curPath = fpath.substr(0, fpath.rfind('/'));
+		assert(!m_curPath.empty());
+
+		Parser p(FileSystem::gameDataFiles, fpath, m_curPath);
+		p.Parse(&modelDefinition);
+	} catch (ParseError &err) {
+		Output("%s\n", err.what());
+		throw LoadingError(err.what());
+	}
+	modelDefinition.name = shortname;
 }
 
 Model *Loader::CreateModel(ModelDefinition &def)
@@ -287,22 +432,11 @@ RefCountedPtr<Node> Loader::LoadMesh(const std::string &filename, const AnimList
 	m_curMeshDef = filename.substr(slashpos+1, filename.length()-slashpos);
 
 	Assimp::Importer importer;
-	importer.SetIOHandler(new AssimpFileSystem(FileSystem::gameDataFiles));
-
-	//Removing components is suggested to optimize loading. We do not care about vtx colors now.
-	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_COLORS);
-	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, 65536);
-
-	//There are several optimizations assimp can do, intentionally skipping them now
-	const aiScene *scene = importer.ReadFile(
-		filename,
-		aiProcess_RemoveComponent	|
-		aiProcess_Triangulate		|
-		aiProcess_SortByPType		| //ignore point, line primitive types (collada dummy nodes seem to be fine)
-		aiProcess_GenUVCoords		|
-		aiProcess_FlipUVs			|
-		aiProcess_SplitLargeMeshes	|
-		aiProcess_GenSmoothNormals);  //only if normals not specified
+	const aiScene *scene = m_prepared ? m_prepared->GetScene(m_prepared->m_meshes, filename) : 0;
+	if (!scene) {
+		importer.SetIOHandler(new AssimpFileSystem(FileSystem::gameDataFiles));
+		scene = ImportMesh(importer, filename);
+	}
 
 	if(!scene)
 		throw LoadingError("Couldn't load file");
@@ -449,11 +583,8 @@ void Loader::ConvertAiMeshes(std::vector<RefCountedPtr<StaticGeometry> > &geoms,
 		vbd.attrib[2].format   = Graphics::ATTRIB_FORMAT_FLOAT2;
 		vbd.attrib[2].offset   = offsetof(ModelVtx, uv0);
 		vbd.stride = sizeof(ModelVtx);
-		vbd.numVertices = mesh->mNumVertices;
 		vbd.usage = Graphics::BUFFER_USAGE_STATIC;
 
-		RefCountedPtr<Graphics::VertexBuffer> vb(m_renderer->CreateVertexBuffer(vbd));
-
 		// huge meshes are split by the importer so this should not exceed 65K indices
 		std::vector<Uint16> indices;
 		if (mesh->mNumFaces > 0)
@@ -475,36 +606,74 @@ void Loader::ConvertAiMeshes(std::vector<RefCountedPtr<StaticGeometry> > &geoms,
 
 		assert(indices.size() > 0);
 
-		//create buffer & copy
-		RefCountedPtr<Graphics::IndexBuffer> ib(m_renderer->CreateIndexBuffer(indices.size(), Graphics::BUFFER_USAGE_STATIC));
-		Uint16* idxPtr = ib->Map(Graphics::BUFFER_MAP_WRITE);
-		for (Uint32 j = 0; j < indices.size(); j++)
-			idxPtr[j] = indices[j];
-		ib->Unmap();
-
 		//copy vertices, always assume normals
 		//replace nonexistent UVs with zeros
-		ModelVtx *vtxPtr = vb->Map<ModelVtx>(Graphics::BUFFER_MAP_WRITE);
+		std::vector<ModelVtx> vertices(mesh->mNumVertices);
 		for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
 			const aiVector3D &vtx = mesh->mVertices[v];
 			const aiVector3D &norm = mesh->mNormals[v];
 			const aiVector3D &uv0 = hasUVs ? mesh->mTextureCoords[0][v] : aiVector3D(0.f);
-			vtxPtr[v].pos = vector3f(vtx.x, vtx.y, vtx.z);
-			vtxPtr[v].nrm = vector3f(norm.x, norm.y, norm.z);
-			vtxPtr[v].uv0 = vector2f(uv0.x, uv0.y);
+			vertices[v].pos = vector3f(vtx.x, vtx.y, vtx.z);
+			vertices[v].nrm = vector3f(norm.x, norm.y, norm.z);
+			vertices[v].uv0 = vector2f(uv0.x, uv0.y);
 
 			//update bounding box
 			//untransformed points, collision visitor will transform
 			geom->m_boundingBox.Update(vtx.x, vtx.y, vtx.z);
 		}
+
+		if (m_optimizeMeshes && mesh->mNumFaces > 0)
+			OptimizeMesh(indices, vertices, i);
+
+		//the optimizer drops degenerate triangles, which can be all of them.
+		//An empty entry keeps the mesh indices of the nodes lined up
+		if (indices.empty()) {
+			AddLog(stringf("%0: mesh %1{u} has only degenerate triangles, skipped", m_curMeshDef, i));
+			geoms.push_back(RefCountedPtr<StaticGeometry>());
+			continue;
+		}
+
+		//create buffers & copy
+		vbd.numVertices = vertices.size();
+		RefCountedPtr<Graphics::VertexBuffer> vb(m_renderer->CreateVertexBuffer(vbd));
+		ModelVtx *vtxPtr = vb->Map<ModelVtx>(Graphics::BUFFER_MAP_WRITE);
+		std::copy(vertices.begin(), vertices.end(), vtxPtr);
 		vb->Unmap();
 
+		RefCountedPtr<Graphics::IndexBuffer> ib(m_renderer->CreateIndexBuffer(indices.size(), Graphics::BUFFER_USAGE_STATIC));
+		Uint16* idxPtr = ib->Map(Graphics::BUFFER_MAP_WRITE);
+		for (Uint32 j = 0; j < indices.size(); j++)
+			idxPtr[j] = indices[j];
+		ib->Unmap();
+
 		geom->AddMesh(vb, ib, mat);
 
 		geoms.push_back(geom);
 	}
 }
 
+void Loader::OptimizeMesh(std::vector<Uint16> &indices, std::vector<ModelVtx> &vertices, unsigned int meshIndex)
+{
+	const float acmrBefore = MeshOptimizer::CalcACMR(indices);
+	const size_t numVerticesBefore = vertices.size();
+
+	std::vector<vector3f> positions(vertices.size());
+	for (size_t v = 0; v < vertices.size(); v++)
+		positions[v] = vertices[v].pos;
+	MeshOptimizer::OptimizeTriangles(indices, positions);
+
+	std::vector<Uint32> remap;
+	std::vector<ModelVtx> fetchOrder(MeshOptimizer::OptimizeVertexFetch(indices, vertices.size(), remap));
+	for (size_t v = 0; v < vertices.size(); v++) {
+		if (remap[v] != MeshOptimizer::NO_VERTEX)
+			fetchOrder[remap[v]] = vertices[v];
+	}
+	vertices.swap(fetchOrder);
+
+	AddLog(stringf("%0: mesh %1{u}: ACMR %2{f.3} -> %3{f.3}, %4{u} -> %5{u} vertices",
+		m_curMeshDef, meshIndex, acmrBefore, MeshOptimizer::CalcACMR(indices), Uint32(numVerticesBefore), Uint32(vertices.size())));
+}
+
 void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, Node *meshRoot)
 {
 	//Split convert assimp animations according to anim defs
@@ -568,7 +737,7 @@ void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, N
 					const aiVector3D &aipos = aikey.mValue;
 					if (in_range(aikey.mTime, defStart, defEnd)) {
 						const double t = aikey.mTime * secondsPerTick;
-						chan.positionKeys.push_back(PositionKey(t, vector3f(aipos.x, aipos.y, aipos.z)));
+						chan.keys->positionKeys.push_back(PositionKey(t, vector3f(aipos.x, aipos.y, aipos.z)));
 						start = std::min(start, t);
 						end = std::max(end, t);
 					}
@@ -583,7 +752,7 @@ void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, N
 					const aiQuaternion &airot = aikey.mValue;
 					if (in_range(aikey.mTime, defStart, defEnd)) {
 						const double t = aikey.mTime * secondsPerTick;
-						chan.rotationKeys.push_back(RotationKey(t, Quaternionf(airot.w, airot.x, airot.y, airot.z)));
+						chan.keys->rotationKeys.push_back(RotationKey(t, Quaternionf(airot.w, airot.x, airot.y, airot.z)));
 						start = std::min(start, t);
 						end = std::max(end, t);
 					}
@@ -594,7 +763,7 @@ void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, N
 					const aiVector3D &aipos = aikey.mValue;
 					if (in_range(aikey.mTime, defStart, defEnd)) {
 						const double t = aikey.mTime * secondsPerTick;
-						chan.scaleKeys.push_back(ScaleKey(t, vector3f(aipos.x, aipos.y, aipos.z)));
+						chan.keys->scaleKeys.push_back(ScaleKey(t, vector3f(aipos.x, aipos.y, aipos.z)));
 						start = std::min(start, t);
 						end = std::max(end, t);
 					}
@@ -605,17 +774,17 @@ void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, N
 		// convert remove initial offset (so the first keyframe is at exactly t=0)
 		for (std::vector<AnimationChannel>::iterator chan = animation->m_channels.begin() + first_new_channel;
 				chan != animation->m_channels.end(); ++chan) {
-			for (unsigned int k = 0; k < chan->positionKeys.size(); ++k) {
-				chan->positionKeys[k].time -= start;
-				assert(chan->positionKeys[k].time >= 0.0);
+			for (unsigned int k = 0; k < chan->keys->positionKeys.size(); ++k) {
+				chan->keys->positionKeys[k].time -= start;
+				assert(chan->keys->positionKeys[k].time >= 0.0);
 			}
-			for (unsigned int k = 0; k < chan->rotationKeys.size(); ++k) {
-				chan->rotationKeys[k].time -= start;
-				assert(chan->rotationKeys[k].time >= 0.0);
+			for (unsigned int k = 0; k < chan->keys->rotationKeys.size(); ++k) {
+				chan->keys->rotationKeys[k].time -= start;
+				assert(chan->keys->rotationKeys[k].time >= 0.0);
 			}
-			for (unsigned int k = 0; k < chan->scaleKeys.size(); ++k) {
-				chan->scaleKeys[k].time -= start;
-				assert(chan->scaleKeys[k].time >= 0.0);
+			for (unsigned int k = 0; k < chan->keys->scaleKeys.size(); ++k) {
+				chan->keys->scaleKeys[k].time -= start;
+				assert(chan->keys->scaleKeys[k].time >= 0.0);
 			}
 		}
 
@@ -786,6 +955,9 @@ void Loader::ConvertNodes(aiNode *node, Group *_parent, std::vector<RefCountedPt
 
 	//nodes named collision_* are not added as renderable geometry
 	if (node->mNumMeshes == 1 && starts_with(nodename, "collision_")) {
+		//skipped in ConvertAiMeshes
+		if (!geoms.at(node->mMeshes[0]))
+			return;
 		const unsigned int collflag = GetGeomFlagForNodeName(nodename);
 		RefCountedPtr<CollisionGeometry> cgeom = CreateCollisionGeometry(geoms.at(node->mMeshes[0]), collflag);
 		cgeom->SetName(nodename + "_cgeom");
@@ -806,6 +978,7 @@ void Loader::ConvertNodes(aiNode *node, Group *_parent, std::vector<RefCountedPt
 
 		for(unsigned int i=0; i<node->mNumMeshes; i++) {
 			RefCountedPtr<StaticGeometry> geom = geoms.at(node->mMeshes[i]);
+			if (!geom) continue; //skipped in ConvertAiMeshes
 
 			//handle special decal material
 			//set special material for decals
@@ -838,21 +1011,11 @@ void Loader::LoadCollision(const std::string &filename)
 	assert(m_model);
 
 	Assimp::Importer importer;
-	importer.SetIOHandler(new AssimpFileSystem(FileSystem::gameDataFiles));
-
-	//discard extra data
-	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS,
-		aiComponent_COLORS    |
-		aiComponent_TEXCOORDS |
-		aiComponent_NORMALS   |
-		aiComponent_MATERIALS
-		);
-	const aiScene *scene = importer.ReadFile(
-		filename,
-		aiProcess_RemoveComponent |
-		aiProcess_Triangulate     |
-		aiProcess_PreTransformVertices //"bake" transformations so we can disregard the structure
-		);
+	const aiScene *scene = m_prepared ? m_prepared->GetScene(m_prepared->m_collisions, filename) : 0;
+	if (!scene) {
+		importer.SetIOHandler(new AssimpFileSystem(FileSystem::gameDataFiles));
+		scene = ImportCollision(importer, filename);
+	}
 
 	if(!scene)
 		throw LoadingError("Could not load file");
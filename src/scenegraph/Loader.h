@@ -9,15 +9,54 @@
 #include "BaseLoader.h"
 #include "CollisionGeometry.h"
 #include "graphics/Material.h"
+#include "FileSystem.h"
 #include <assimp/types.h>
+#include <map>
+#include <memory>
+#include <set>
 
 struct aiNode;
 struct aiMesh;
 struct aiScene;
 struct aiNodeAnim;
+namespace Assimp { class Importer; }
 
 namespace SceneGraph {
 
+struct ModelVtx;
+
+// The part of loading a model that does not need the renderer.
+// Loader::PrepareModel finds and parses the .model file and reads the mesh
+// files it names, on the main thread as the file sources are not thread
+// safe. Import() then runs Assimp on the files in memory and can be called
+// from a job worker. Loader::LoadModel builds the model from the imported
+// scenes, importing again anything Import could not do on its own
+class PreparedModel {
+public:
+	PreparedModel();
+	~PreparedModel();
+
+	const std::string &GetName() const { return m_definition.name; }
+
+	void Import();
+
+private:
+	friend class Loader;
+	typedef std::map<std::string, RefCountedPtr<FileSystem::FileData> > FileMap;
+	typedef std::map<std::string, std::unique_ptr<Assimp::Importer> > SceneMap;
+
+	const aiScene *GetScene(const SceneMap &scenes, const std::string &filename) const;
+
+	ModelDefinition m_definition;
+	std::string m_path;
+	std::set<std::string> m_meshNames;
+	std::set<std::string> m_collisionNames;
+	FileMap m_files;
+	// the importers own their scenes
+	SceneMap m_meshes;
+	SceneMap m_collisions;
+};
+
 class Loader : public BaseLoader {
 public:
 	Loader(Graphics::Renderer *r, bool logWarnings = false);
@@ -26,24 +65,36 @@ public:
 	Model *LoadModel(const std::string &name);
 	Model *LoadModel(const std::string &name, const std::string &basepath);
 
+	//the same in two steps, see PreparedModel
+	void PrepareModel(const std::string &name, PreparedModel &out);
+	Model *LoadModel(PreparedModel &prepared);
+
 	const std::vector<std::string> &GetLogMessages() const { return m_logMessages; }
 
+	//reorder mesh triangles and vertices for drawing, see MeshOptimizer.
+	//Meant for converting models to binary, it takes a while
+	void SetOptimizeMeshes(bool optimize) { m_optimizeMeshes = optimize; }
+
 protected:
 	bool m_doLog;
 	bool m_mostDetailedLod;
+	bool m_optimizeMeshes;
 	std::vector<std::string> m_logMessages;
 	std::string m_curMeshDef; //for logging
+	PreparedModel *m_prepared; //scenes imported ahead, during LoadModel(PreparedModel&)
 
 	RefCountedPtr<Group> m_thrustersRoot;
 	RefCountedPtr<Group> m_billboardsRoot;
 
 	bool CheckKeysInRange(const aiNodeAnim *, double start, double end);
 	matrix4x4f ConvertMatrix(const aiMatrix4x4&) const;
+	void ReadModelDefinition(const std::string &name, const std::string &basepath, ModelDefinition &def); //also sets m_curPath
 	Model *CreateModel(ModelDefinition &def);
 	RefCountedPtr<Node> LoadMesh(const std::string &filename, const AnimList &animDefs); //load one mesh file so it can be added to the model scenegraph. Materials should be created before this!
 	void AddLog(const std::string&);
 	void CheckAnimationConflicts(const Animation*, const std::vector<Animation*>&); //detect animation overlap
 	void ConvertAiMeshes(std::vector<RefCountedPtr<StaticGeometry> >&, const aiScene*); //model is only for material lookup
+	void OptimizeMesh(std::vector<Uint16> &indices, std::vector<ModelVtx> &vertices, unsigned int meshIndex);
 	void ConvertAnimations(const aiScene *, const AnimList &, Node *meshRoot);
 	void ConvertNodes(aiNode *node, Group *parent, std::vector<RefCountedPtr<StaticGeometry> >& meshes, const matrix4x4f&);
 	void CreateLabel(Group *parent, const matrix4x4f&);
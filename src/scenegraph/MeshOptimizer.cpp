@@ -0,0 +1,192 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "MeshOptimizer.h"
+#include "vcacheopt/vcacheopt.h"
+#include <algorithm>
+
+namespace SceneGraph {
+
+namespace MeshOptimizer {
+
+static const Uint32 CACHE_SIZE = 16;
+// a run of triangles ends once its ACMR is within this factor
+// of the ACMR of the whole run it was split from
+static const float OVERDRAW_THRESHOLD = 1.05f;
+
+// A vertex is cached if it was added less than CACHE_SIZE misses ago
+class FifoCache {
+public:
+	FifoCache(Uint32 numVertices) : m_added(numVertices, 0), m_clock(CACHE_SIZE + 1) {}
+
+	// true if the vertex had to be transformed
+	bool Use(Uint16 v) {
+		if (m_clock - m_added[v] <= CACHE_SIZE)
+			return false;
+		m_added[v] = m_clock++;
+		return true;
+	}
+
+	Uint32 UseTriangle(const Uint16 *tri) {
+		return Uint32(Use(tri[0])) + Uint32(Use(tri[1])) + Uint32(Use(tri[2]));
+	}
+
+	void Flush() { m_clock += CACHE_SIZE + 1; }
+
+private:
+	std::vector<Uint32> m_added;
+	Uint32 m_clock;
+};
+
+static Uint32 CountVertices(const std::vector<Uint16> &indices)
+{
+	Uint32 numVertices = 0;
+	for (size_t i = 0; i < indices.size(); i++)
+		numVertices = std::max(numVertices, Uint32(indices[i]) + 1);
+	return numVertices;
+}
+
+float CalcACMR(const std::vector<Uint16> &indices)
+{
+	const size_t numTris = indices.size() / 3;
+	if (numTris == 0) return 0.0f;
+
+	FifoCache cache(CountVertices(indices));
+	Uint32 misses = 0;
+	for (size_t t = 0; t < numTris; t++)
+		misses += cache.UseTriangle(&indices[t * 3]);
+	return float(misses) / float(numTris);
+}
+
+// Splits the triangles into runs that can be drawn in any order without
+// losing much cache efficiency: a new run starts where all three vertices
+// miss, which is where the cache order started over anyway, and inside
+// those where the run so far is about as cache efficient as the whole.
+// Returns the first triangle of every run
+static std::vector<Uint32> FindClusters(const std::vector<Uint16> &indices, Uint32 numVertices)
+{
+	const Uint32 numTris = indices.size() / 3;
+	FifoCache cache(numVertices);
+
+	std::vector<Uint32> hard;
+	for (Uint32 t = 0; t < numTris; t++) {
+		if (cache.UseTriangle(&indices[t * 3]) == 3)
+			hard.push_back(t);
+	}
+	hard.push_back(numTris);
+
+	std::vector<Uint32> clusters;
+	for (size_t h = 0; h + 1 < hard.size(); h++) {
+		const Uint32 start = hard[h], end = hard[h + 1];
+
+		cache.Flush();
+		Uint32 misses = 0;
+		for (Uint32 t = start; t < end; t++)
+			misses += cache.UseTriangle(&indices[t * 3]);
+		const float threshold = OVERDRAW_THRESHOLD * float(misses) / float(end - start);
+
+		clusters.push_back(start);
+		cache.Flush();
+		Uint32 runMisses = 0, runTris = 0;
+		for (Uint32 t = start; t < end; t++) {
+			runMisses += cache.UseTriangle(&indices[t * 3]);
+			runTris++;
+			if (float(runMisses) / float(runTris) <= threshold && t + 1 < end) {
+				clusters.push_back(t + 1);
+				cache.Flush();
+				runMisses = runTris = 0;
+			}
+		}
+	}
+	return clusters;
+}
+
+struct ClusterOrder {
+	Uint32 start, end;
+	float facing;
+	bool operator<(const ClusterOrder &o) const { return facing > o.facing; }
+};
+
+void OptimizeTriangles(std::vector<Uint16> &indices, const std::vector<vector3f> &positions)
+{
+	PROFILE_SCOPED()
+	std::vector<int> tris;
+	tris.reserve(indices.size());
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		const Uint16 a = indices[i], b = indices[i + 1], c = indices[i + 2];
+		if (a == b || b == c || c == a) continue;
+		tris.push_back(a);
+		tris.push_back(b);
+		tris.push_back(c);
+	}
+	const Uint32 numTris = tris.size() / 3;
+	if (numTris == 0) {
+		indices.clear();
+		return;
+	}
+
+	// the int variant, the unsigned short one takes index 65535 for its
+	// "no vertex" value
+	VertexCacheOptimizerInt vco;
+	vco.Optimize(&tris[0], numTris);
+	indices.assign(tris.begin(), tris.end());
+
+	const std::vector<Uint32> starts = FindClusters(indices, CountVertices(indices));
+
+	// area weighted, so that slivers count for little
+	vector3f meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	std::vector<ClusterOrder> clusters(starts.size());
+	std::vector<vector3f> centroids(starts.size()), normals(starts.size());
+	for (size_t c = 0; c < starts.size(); c++) {
+		ClusterOrder &cluster = clusters[c];
+		cluster.start = starts[c];
+		cluster.end = (c + 1 < starts.size()) ? starts[c + 1] : numTris;
+
+		vector3f centroid(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (Uint32 t = cluster.start; t < cluster.end; t++) {
+			const vector3f &p0 = positions[indices[t * 3]];
+			const vector3f &p1 = positions[indices[t * 3 + 1]];
+			const vector3f &p2 = positions[indices[t * 3 + 2]];
+			const vector3f n = (p1 - p0).Cross(p2 - p0);
+			const float a = n.Length();
+			centroid += (p0 + p1 + p2) * (a / 3.0f);
+			normal += n;
+			area += a;
+		}
+		meshCentroid += centroid;
+		meshArea += area;
+		centroids[c] = (area > 0.0f) ? centroid / area : positions[indices[cluster.start * 3]];
+		normals[c] = (normal.LengthSqr() > 0.0f) ? normal.Normalized() : vector3f(0.0f);
+	}
+	if (meshArea > 0.0f)
+		meshCentroid /= meshArea;
+
+	for (size_t c = 0; c < clusters.size(); c++)
+		clusters[c].facing = (centroids[c] - meshCentroid).Dot(normals[c]);
+	std::stable_sort(clusters.begin(), clusters.end());
+
+	std::vector<Uint16> sorted;
+	sorted.reserve(indices.size());
+	for (size_t c = 0; c < clusters.size(); c++)
+		sorted.insert(sorted.end(), indices.begin() + clusters[c].start * 3, indices.begin() + clusters[c].end * 3);
+	indices.swap(sorted);
+}
+
+Uint32 OptimizeVertexFetch(std::vector<Uint16> &indices, Uint32 numVertices, std::vector<Uint32> &remap)
+{
+	remap.assign(numVertices, NO_VERTEX);
+	Uint32 next = 0;
+	for (size_t i = 0; i < indices.size(); i++) {
+		Uint32 &v = remap[indices[i]];
+		if (v == NO_VERTEX)
+			v = next++;
+		indices[i] = Uint16(v);
+	}
+	return next;
+}
+
+}
+
+}
@@ -0,0 +1,39 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _SCENEGRAPH_MESHOPTIMIZER_H
+#define _SCENEGRAPH_MESHOPTIMIZER_H
+/**
+ * Reordering of indexed triangle lists for faster drawing
+ */
+#include "libs.h"
+#include <vector>
+
+namespace SceneGraph {
+
+// Meant for when models are converted, the result is saved with the model.
+// Indices are triangle lists, positions are indexed by them
+namespace MeshOptimizer {
+
+	static const Uint32 NO_VERTEX = ~0u;
+
+	// average number of vertices transformed per triangle, with a 16 entry
+	// FIFO post-transform cache. 3 is the worst, about 0.5-0.7 is very good
+	float CalcACMR(const std::vector<Uint16> &indices);
+
+	// drops degenerate triangles, orders the rest for the vertex cache and
+	// then sorts runs of them so that ones facing out from the middle of
+	// the mesh are drawn first and hide what is behind them. The cache
+	// efficiency is kept within a few percent of the cache-only order
+	void OptimizeTriangles(std::vector<Uint16> &indices, const std::vector<vector3f> &positions);
+
+	// numbers the vertices in the order the triangles first use them, so
+	// they are fetched from memory in order, and leaves out unused ones.
+	// remap gets the new index of every old vertex, or NO_VERTEX. Returns
+	// the new number of vertices
+	Uint32 OptimizeVertexFetch(std::vector<Uint16> &indices, Uint32 numVertices, std::vector<Uint32> &remap);
+}
+
+}
+
+#endif
@@ -2,8 +2,10 @@
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 
 #include "Model.h"
+#include "CollisionGeometry.h"
 #include "CollisionVisitor.h"
 #include "NodeCopyCache.h"
+#include "RenderList.h"
 #include "graphics/Renderer.h"
 #include "graphics/TextureBuilder.h"
 #include "graphics/VertexArray.h"
@@ -20,6 +22,52 @@ public:
 	std::string label;
 };
 
+//Finds the nodes an instance needs its own copy of: animated transforms,
+//labels, moving collision geometry and the groups above them. Everything
+//else (usually nearly all of the tree) never changes and is shared
+class InstanceNodeVisitor : public NodeVisitor {
+public:
+	InstanceNodeVisitor(const AnimationContainer &anims) {
+		for (AnimationContainer::const_iterator anim = anims.begin(); anim != anims.end(); ++anim) {
+			const std::vector<AnimationChannel> &channels = (*anim)->GetChannels();
+			for (std::vector<AnimationChannel>::const_iterator chan = channels.begin(); chan != channels.end(); ++chan)
+				m_animated.insert(chan->node);
+		}
+	}
+
+	virtual void ApplyGroup(Group &g) {
+		m_path.push_back(&g);
+		g.Traverse(*this);
+		m_path.pop_back();
+	}
+
+	virtual void ApplyMatrixTransform(MatrixTransform &m) {
+		if (m_animated.count(&m))
+			Add(m);
+		ApplyGroup(m);
+	}
+
+	virtual void ApplyLabel(Label3D &l) {
+		Add(l);
+	}
+
+	virtual void ApplyCollisionGeometry(CollisionGeometry &cg) {
+		if (cg.IsDynamic())
+			Add(cg);
+	}
+
+	std::set<const Node*> nodes;
+
+private:
+	void Add(const Node &n) {
+		nodes.insert(&n);
+		nodes.insert(m_path.begin(), m_path.end());
+	}
+
+	std::set<const MatrixTransform*> m_animated;
+	std::vector<const Node*> m_path;
+};
+
 Model::Model(Graphics::Renderer *r, const std::string &name)
 : m_boundingRadius(10.f)
 , m_renderer(r)
@@ -44,8 +92,14 @@ Model::Model(const Model &model)
 , m_curPattern(model.m_curPattern)
 , m_debugFlags(0)
 {
-	//selective copying of node structure
+	//selective copying of node structure, only the parts that can
+	//differ between instances. The root is always copied so AddTag
+	//on an instance leaves the original alone
+	InstanceNodeVisitor inv(model.m_animations);
+	model.m_root->Accept(inv);
+	inv.nodes.insert(model.m_root.Get());
 	NodeCopyCache cache;
+	cache.SetCopiedNodes(&inv.nodes);
 	m_root.Reset(dynamic_cast<Group*>(model.m_root->Clone(&cache)));
 
 	//materials are shared by meshes
@@ -64,7 +118,7 @@ Model::Model(const Model &model)
 		SetPattern(0);
 	}
 
-	//animations need to be copied and retargeted
+	//animations need to be copied and retargeted, the keyframes are shared
 	for (AnimationContainer::const_iterator it = model.m_animations.begin(); it != model.m_animations.end(); ++it) {
 		const Animation *anim = *it;
 		m_animations.push_back(new Animation(*anim));
@@ -84,6 +138,11 @@ Model::~Model()
 	while(!m_animations.empty()) delete m_animations.back(), m_animations.pop_back();
 }
 
+void Model::InvalidateRenderList()
+{
+	m_renderList.reset();
+}
+
 Model *Model::MakeInstance() const
 {
 	Model *m = new Model(*this);
@@ -119,13 +178,17 @@ void Model::Render(const matrix4x4f &trans, const RenderData *rd)
 	if (m_debugFlags & DEBUG_WIREFRAME)
 		m_renderer->SetWireFrameMode(true);
 
+	if (!m_renderList)
+		m_renderList.reset(new RenderList(m_root.Get(), m_animations));
+	m_renderList->Update(trans, &params);
+
 	if (params.nodemask & MASK_IGNORE) {
-		m_root->Render(trans, &params);
+		m_renderList->Draw(m_renderer, &params);
 	} else {
 		params.nodemask = NODE_SOLID;
-		m_root->Render(trans, &params);
+		m_renderList->Draw(m_renderer, &params);
 		params.nodemask = NODE_TRANSPARENT;
-		m_root->Render(trans, &params);
+		m_renderList->Draw(m_renderer, &params);
 	}
 
 	if (!m_debugFlags)
@@ -284,6 +347,7 @@ void Model::AddTag(const std::string &name, MatrixTransform *node)
 	node->SetNodeFlags(node->GetNodeFlags() | NODE_TAG);
 	m_root->AddChild(node);
 	m_tags.push_back(node);
+	InvalidateRenderList();
 }
 
 void Model::SetPattern(unsigned int index)
@@ -377,6 +441,21 @@ void Model::SetThrust(const vector3f &lin, const vector3f &ang)
 	m_renderData.angthrust[2] = ang.z;
 }
 
+//the transforms an instance owns, the animation targets. Every other
+//MatrixTransform is shared with the other instances (see MakeInstance)
+static std::set<const MatrixTransform*> GetOwnedTransforms(const AnimationContainer &anims)
+{
+	std::set<const MatrixTransform*> owned;
+	for (AnimationContainer::const_iterator anim = anims.begin(); anim != anims.end(); ++anim) {
+		const std::vector<AnimationChannel> &channels = (*anim)->GetChannels();
+		for (std::vector<AnimationChannel>::const_iterator chan = channels.begin(); chan != channels.end(); ++chan)
+			owned.insert(chan->node);
+	}
+	return owned;
+}
+
+//shared transforms are written as well, so the layout of the stream does
+//not depend on which nodes an instance owns
 class SaveVisitor : public NodeVisitor {
 public:
 	SaveVisitor(Serializer::Writer *wr_): wr(wr_) {}
@@ -402,24 +481,28 @@ void Model::Save(Serializer::Writer &wr) const
 	wr.Int32(m_curPatternIndex);
 }
 
+//only owned transforms are set, writing a shared one would change every
+//instance of the model. The others are read past
 class LoadVisitor : public NodeVisitor {
 public:
-	LoadVisitor(Serializer::Reader *rd_): rd(rd_) {}
+	LoadVisitor(Serializer::Reader *rd_, const std::set<const MatrixTransform*> &owned_): rd(rd_), owned(owned_) {}
 
 	void ApplyMatrixTransform(MatrixTransform &node) {
 		matrix4x4f m;
 		for (int i = 0; i < 16; i++)
 			m[i] = rd->Float();
-		node.SetTransform(m);
+		if (owned.count(&node))
+			node.SetTransform(m);
 	}
 
 private:
 	Serializer::Reader *rd;
+	const std::set<const MatrixTransform*> &owned;
 };
 
 void Model::Load(Serializer::Reader &rd)
 {
-	LoadVisitor lv(&rd);
+	LoadVisitor lv(&rd, GetOwnedTransforms(m_animations));
 	m_root->Accept(lv);
 
 	for (AnimationContainer::const_iterator i = m_animations.begin(); i != m_animations.end(); ++i)
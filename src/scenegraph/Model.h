@@ -70,6 +70,7 @@
 #include "graphics/Drawables.h"
 #include "Serializer.h"
 #include "DeleteEmitter.h"
+#include <memory>
 #include <stdexcept>
 
 namespace Graphics { class Renderer; }
@@ -79,6 +80,7 @@ namespace SceneGraph
 class BaseLoader;
 class ModelBinarizer;
 class BinaryConverter;
+class RenderList;
 
 struct LoadingError : public std::runtime_error {
 	LoadingError(const std::string &str) : std::runtime_error(str.c_str()) { }
@@ -98,6 +100,8 @@ public:
 	Model(Graphics::Renderer *r, const std::string &name);
 	~Model();
 
+	//shares the nodes and keyframes that never change with this model,
+	//only animated transforms, labels and the nodes above them are copied
 	Model *MakeInstance() const;
 
 	const std::string& GetName() const { return m_name; }
@@ -107,6 +111,8 @@ public:
 	RefCountedPtr<CollMesh> CreateCollisionMesh();
 	RefCountedPtr<CollMesh> GetCollisionMesh() const { return m_collMesh; }
 	RefCountedPtr<Group> GetRoot() { return m_root; }
+	//call after changing the node tree or a transform that is not animated
+	void InvalidateRenderList();
 	//materials used in the nodes should be accessible from here for convenience
 	RefCountedPtr<Graphics::Material> GetMaterialByName(const std::string &name) const;
 	RefCountedPtr<Graphics::Material> GetMaterialByIndex(int) const;
@@ -174,6 +180,7 @@ private:
 	std::vector<Animation *> m_animations;
 	TagContainer m_tags; //named attachment points
 	RenderData m_renderData;
+	std::unique_ptr<RenderList> m_renderList; //built from m_root on the first Render
 
 	//per-instance flavour data
 	unsigned int m_curPatternIndex;
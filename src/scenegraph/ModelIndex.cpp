@@ -0,0 +1,63 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "ModelIndex.h"
+#include "FileSystem.h"
+#include <map>
+
+namespace SceneGraph {
+
+namespace ModelIndex {
+
+// lower case extension, then the name without it
+typedef std::pair<std::string, std::string> FileKey;
+typedef std::map<FileKey, std::string> FileMap;
+
+static std::map<std::string, FileMap> s_index; // by base path
+static unsigned int s_generation = 0;
+
+static std::string ToLower(const std::string &s)
+{
+	std::string out(s);
+	for (std::string::iterator it = out.begin(); it != out.end(); ++it)
+		*it = tolower(*it);
+	return out;
+}
+
+static const FileMap &GetFiles(const std::string &basepath)
+{
+	if (s_generation != FileSystem::gameDataFiles.GetGeneration()) {
+		s_index.clear();
+		s_generation = FileSystem::gameDataFiles.GetGeneration();
+	}
+
+	std::map<std::string, FileMap>::iterator it = s_index.find(basepath);
+	if (it != s_index.end())
+		return it->second;
+
+	PROFILE_SCOPED()
+	FileMap &files = s_index[basepath];
+	for (FileSystem::FileEnumerator e(FileSystem::gameDataFiles, basepath, FileSystem::FileEnumerator::Recurse); !e.Finished(); e.Next()) {
+		const FileSystem::FileInfo &info = e.Current();
+		if (!info.IsFile()) continue;
+
+		const std::string name = info.GetName();
+		const size_t dot = name.rfind('.');
+		if (dot == std::string::npos) continue;
+
+		// the first one found wins, as it did when every lookup walked the tree
+		files.insert(std::make_pair(FileKey(ToLower(name.substr(dot)), name.substr(0, dot)), info.GetPath()));
+	}
+	return files;
+}
+
+std::string Find(const std::string &basepath, const std::string &name, const std::string &extension)
+{
+	const FileMap &files = GetFiles(basepath);
+	FileMap::const_iterator it = files.find(FileKey(ToLower(extension), name));
+	return (it != files.end()) ? it->second : std::string();
+}
+
+}
+
+}
@@ -0,0 +1,29 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _SCENEGRAPH_MODELINDEX_H
+#define _SCENEGRAPH_MODELINDEX_H
+/**
+ * Where the model files are in the game data
+ */
+#include "libs.h"
+#include <string>
+
+namespace SceneGraph {
+
+// The first lookup below a base path walks it once and remembers every file
+// there by extension and name, later lookups are a map search instead of a
+// walk over the whole tree. The index is built again when the game data
+// sources change (mods). Files the game writes itself, like binary models,
+// go to the user directory outside the game data and never need adding.
+// Main thread only, like the file sources
+namespace ModelIndex {
+
+	// the path of the first file called <name><extension> below basepath,
+	// empty if there is none. The extension is compared ignoring case
+	std::string Find(const std::string &basepath, const std::string &name, const std::string &extension);
+}
+
+}
+
+#endif
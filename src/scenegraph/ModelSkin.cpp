@@ -21,7 +21,7 @@ void ModelSkin::Apply(Model *model) const
 		if (m_decals[i].empty())
 			model->ClearDecal(i);
 		else
-			model->SetDecalTexture(Graphics::TextureBuilder::Decal(stringf("textures/decals/%0.png", m_decals[i])).GetOrCreateTexture(model->GetRenderer(), "decal"), i);
+			model->SetDecalTexture(Graphics::TextureBuilder::Decal(stringf("textures/decals/%0.png", m_decals[i])).GetOrCreateTextureAsync(model->GetRenderer(), "decal", Color(0)), i);
 	}
 	model->SetLabel(m_label);
 }
@@ -78,7 +78,17 @@ void Node::DrawAxes()
 
 void Node::Save(NodeDatabase &db)
 {
-    db.wr->String(GetTypeName());
+	//the first node of a type also writes the name, see BinaryConverter::LoadNode
+	const std::string typeName = GetTypeName();
+	auto typeIt = db.typeIndices.find(typeName);
+	if (typeIt != db.typeIndices.end())
+		db.wr->Int32(typeIt->second);
+	else {
+		const Uint32 typeIndex = db.typeIndices.size();
+		db.typeIndices[typeName] = typeIndex;
+		db.wr->Int32(typeIndex);
+		db.wr->String(typeName);
+	}
 	db.wr->String(m_name.c_str());
     db.wr->Int32(m_nodeMask);
     db.wr->Int32(m_nodeFlags);
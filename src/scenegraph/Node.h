@@ -63,6 +63,8 @@ struct NodeDatabase {
 	Model *model;
 	std::vector<std::pair<std::string, RefCountedPtr<Graphics::Material> > > *materials;
 	BaseLoader *loader;
+	//node type names written so far, later nodes of a type only write the index
+	std::map<std::string, Uint32> typeIndices;
 };
 
 class Node : public RefCounted
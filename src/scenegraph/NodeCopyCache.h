@@ -6,6 +6,7 @@
 
 #include "RefCounted.h"
 #include <map>
+#include <set>
 
 namespace SceneGraph {
 
@@ -13,7 +14,15 @@ class Node;
 
 class NodeCopyCache {
 public:
-	template <typename T> T *Copy(const T *origNode) {
+	NodeCopyCache() : m_copied(0) { }
+
+	//with a set, nodes not in it are shared with the original
+	//instead of copied (along with everything below them)
+	void SetCopiedNodes(const std::set<const Node*> *nodes) { m_copied = nodes; }
+
+	template <typename T> T *Copy(T *origNode) {
+		if (m_copied && !m_copied->count(origNode))
+			return origNode;
 		const bool doCache = origNode->GetRefCount() > 1;
 		if (doCache) {
 			std::map<const Node*,Node*>::const_iterator i = m_cache.find(origNode);
@@ -28,6 +37,7 @@ public:
 
 private:
 	std::map<const Node*,Node*> m_cache;
+	const std::set<const Node*> *m_copied;
 };
 
 }
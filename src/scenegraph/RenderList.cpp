@@ -0,0 +1,216 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "RenderList.h"
+#include "Animation.h"
+#include "Group.h"
+#include "LOD.h"
+#include "MatrixTransform.h"
+#include "NodeVisitor.h"
+#include "StaticGeometry.h"
+#include "graphics/Renderer.h"
+#include <set>
+
+namespace SceneGraph {
+
+// nodemasks only use the low three bits
+static const unsigned int NODEMASK_BITS = 0x7;
+
+// the nodemasks a Group lets a child with this mask through for
+static Uint8 PassesFor(unsigned int childMask)
+{
+	Uint8 passes = 0;
+	for (unsigned int m = 0; m <= NODEMASK_BITS; m++)
+		if (childMask & m) passes |= 1 << m;
+	return passes;
+}
+
+// Walks the tree the way Render does and writes the records in the same
+// order. Group::RenderChildren checks each child's mask, LOD and the model
+// root do not, so a record is drawn for the nodemasks every checked node on
+// its path lets through
+class RenderListBuilder : public NodeVisitor {
+public:
+	RenderListBuilder(RenderList &list, const std::vector<Animation*> &animations) : m_list(list) {
+		for (std::vector<Animation*>::const_iterator anim = animations.begin(); anim != animations.end(); ++anim) {
+			const std::vector<AnimationChannel> &channels = (*anim)->GetChannels();
+			for (std::vector<AnimationChannel>::const_iterator chan = channels.begin(); chan != channels.end(); ++chan)
+				m_animated.insert(chan->node);
+		}
+
+		RenderList::Slot root;
+		root.node = 0;
+		root.parent = -1;
+		root.animated = false;
+		root.model = matrix4x4f::Identity();
+		m_list.m_slots.push_back(root);
+
+		m_state.slot = 0;
+		m_state.lod = -1;
+		m_state.level = 0;
+		m_state.passes = 0xff;
+		m_state.checked = false;
+	}
+
+	virtual void ApplyNode(Node &n) {
+		if (!Enter(n)) return;
+		RenderList::Record rec = MakeRecord();
+		rec.node = &n;
+		m_list.m_records.push_back(rec);
+	}
+
+	virtual void ApplyGroup(Group &g) {
+		const State saved = m_state;
+		if (Enter(g)) {
+			m_state.checked = true;
+			g.Traverse(*this);
+		}
+		m_state = saved;
+	}
+
+	virtual void ApplyMatrixTransform(MatrixTransform &mt) {
+		const State saved = m_state;
+		if (Enter(mt)) {
+			const RenderList::Slot &parent = m_list.m_slots[m_state.slot];
+			RenderList::Slot slot;
+			slot.node = &mt;
+			slot.parent = m_state.slot;
+			slot.animated = parent.animated || m_animated.count(&mt) > 0;
+			slot.model = parent.model * mt.GetTransform();
+			m_list.m_slots.push_back(slot);
+
+			m_state.slot = m_list.m_slots.size() - 1;
+			m_state.checked = true;
+			mt.Traverse(*this);
+		}
+		m_state = saved;
+	}
+
+	virtual void ApplyLOD(LOD &lod) {
+		const State saved = m_state;
+		if (Enter(lod)) {
+			RenderList::Switch sw;
+			sw.node = &lod;
+			sw.slot = m_state.slot;
+			sw.parent = m_state.lod;
+			sw.parentLevel = m_state.level;
+			m_list.m_switches.push_back(sw);
+
+			m_state.lod = m_list.m_switches.size() - 1;
+			m_state.checked = false;
+			for (unsigned int i = 0; i < lod.GetNumChildren(); i++) {
+				m_state.level = i;
+				lod.GetChildAt(i)->Accept(*this);
+			}
+		}
+		m_state = saved;
+	}
+
+	virtual void ApplyStaticGeometry(StaticGeometry &sg) {
+		if (!Enter(sg)) return;
+		RenderList::Record rec = MakeRecord();
+		rec.renderState = sg.GetRenderState();
+		for (unsigned int i = 0; i < sg.GetNumMeshes(); i++) {
+			StaticGeometry::Mesh &mesh = sg.GetMeshAt(i);
+			rec.vertexBuffer = mesh.vertexBuffer.Get();
+			rec.indexBuffer = mesh.indexBuffer.Get();
+			rec.material = mesh.material.Get();
+			m_list.m_records.push_back(rec);
+		}
+	}
+
+	virtual void ApplyCollisionGeometry(CollisionGeometry &) {
+		//not drawn
+	}
+
+private:
+	struct State {
+		int slot;
+		int lod;
+		int level;
+		Uint8 passes;
+		bool checked; // the parent is a Group that checks masks
+	};
+
+	// false if the node is never drawn
+	bool Enter(const Node &n) {
+		if (m_state.checked)
+			m_state.passes &= PassesFor(n.GetNodeMask());
+		return m_state.passes != 0;
+	}
+
+	RenderList::Record MakeRecord() const {
+		RenderList::Record rec;
+		rec.slot = m_state.slot;
+		rec.lod = m_state.lod;
+		rec.level = m_state.level;
+		rec.passes = m_state.passes;
+		rec.node = 0;
+		rec.vertexBuffer = 0;
+		rec.indexBuffer = 0;
+		rec.renderState = 0;
+		rec.material = 0;
+		return rec;
+	}
+
+	RenderList &m_list;
+	std::set<const MatrixTransform*> m_animated;
+	State m_state;
+};
+
+RenderList::RenderList(Group *root, const std::vector<Animation*> &animations)
+{
+	PROFILE_SCOPED()
+	RenderListBuilder builder(*this, animations);
+	// the root is drawn with Render, not through a parent's RenderChildren
+	root->Accept(builder);
+
+	m_view.resize(m_slots.size());
+	m_levels.resize(m_switches.size(), -1);
+}
+
+void RenderList::Update(const matrix4x4f &trans, const RenderData *rd)
+{
+	PROFILE_SCOPED()
+	// parents come before their children
+	for (unsigned int i = 0; i < m_slots.size(); i++) {
+		Slot &slot = m_slots[i];
+		if (slot.animated)
+			slot.model = m_slots[slot.parent].model * slot.node->GetTransform();
+		m_view[i] = trans * slot.model;
+	}
+
+	for (unsigned int i = 0; i < m_switches.size(); i++) {
+		const Switch &sw = m_switches[i];
+		if (sw.parent >= 0 && m_levels[sw.parent] != sw.parentLevel)
+			m_levels[i] = -1;
+		else
+			m_levels[i] = sw.node->GetLevel(m_view[sw.slot], rd->boundingRadius);
+	}
+}
+
+void RenderList::Draw(Graphics::Renderer *r, const RenderData *rd)
+{
+	PROFILE_SCOPED()
+	const Uint8 pass = 1 << (rd->nodemask & NODEMASK_BITS);
+	int curSlot = -1;
+	for (std::vector<Record>::const_iterator rec = m_records.begin(); rec != m_records.end(); ++rec) {
+		if (!(rec->passes & pass)) continue;
+		if (rec->lod >= 0 && m_levels[rec->lod] != rec->level) continue;
+
+		if (rec->node) {
+			rec->node->Render(m_view[rec->slot], rd);
+			// the node may have set its own transform
+			curSlot = -1;
+			continue;
+		}
+
+		if (rec->slot != curSlot) {
+			r->SetTransform(m_view[rec->slot]);
+			curSlot = rec->slot;
+		}
+		r->DrawBufferIndexed(rec->vertexBuffer, rec->indexBuffer, rec->renderState, rec->material);
+	}
+}
+
+}
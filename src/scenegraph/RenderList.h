@@ -0,0 +1,91 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _SCENEGRAPH_RENDERLIST_H
+#define _SCENEGRAPH_RENDERLIST_H
+/*
+ * A model's node tree compiled into flat arrays, drawn with a loop instead
+ * of a recursive walk through virtual Render calls.
+ *
+ * Every MatrixTransform gets a transform slot. Slots above no animated
+ * transform are multiplied out once when the list is built, the others are
+ * redone from their parent slot each frame. The meshes of StaticGeometry
+ * nodes become draw records; other drawable nodes (billboards, labels,
+ * thrusters, submodels) are records that call the node's own Render.
+ * LOD nodes pick their level each frame and records of the other levels
+ * are skipped.
+ *
+ * The list keeps pointers into the tree, so it has to be built again when
+ * the tree or a non-animated transform changes.
+ */
+#include "libs.h"
+#include "Node.h"
+
+namespace Graphics {
+	class IndexBuffer;
+	class Material;
+	class RenderState;
+	class Renderer;
+	class VertexBuffer;
+}
+
+namespace SceneGraph {
+
+class Animation;
+class Group;
+class LOD;
+class MatrixTransform;
+class RenderListBuilder;
+
+class RenderList {
+public:
+	RenderList(Group *root, const std::vector<Animation*> &animations);
+
+	// animated transforms and LOD levels for this frame
+	void Update(const matrix4x4f &trans, const RenderData *rd);
+	// the records rd->nodemask selects, as the tree would draw them
+	void Draw(Graphics::Renderer *r, const RenderData *rd);
+
+	unsigned int GetNumRecords() const { return m_records.size(); }
+
+private:
+	friend class RenderListBuilder;
+
+	struct Slot {
+		const MatrixTransform *node; // 0 for the model root
+		int parent;                  // earlier slot, -1 for the model root
+		bool animated;               // recomputed each frame
+		matrix4x4f model;            // relative to the model root
+	};
+
+	struct Switch {
+		const LOD *node;
+		int slot;
+		int parent;           // enclosing switch, -1 if none
+		int parentLevel;
+	};
+
+	struct Record {
+		int slot;
+		int lod;              // innermost switch, -1 if none
+		int level;            // drawn when that switch picks this level
+		Uint8 passes;         // bit n set: drawn when the nodemask is n
+		Node *node;           // drawn with its own Render, 0 for a mesh
+		Graphics::VertexBuffer *vertexBuffer;
+		Graphics::IndexBuffer *indexBuffer;
+		Graphics::RenderState *renderState;
+		Graphics::Material *material;
+	};
+
+	std::vector<Slot> m_slots;
+	std::vector<Switch> m_switches;
+	std::vector<Record> m_records;
+
+	// per frame
+	std::vector<matrix4x4f> m_view;
+	std::vector<int> m_levels;
+};
+
+}
+
+#endif
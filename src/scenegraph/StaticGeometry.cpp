@@ -9,6 +9,9 @@
 #include "graphics/Renderer.h"
 #include "graphics/Material.h"
 
+//vertex and index data in binary models starts on this boundary
+static const size_t BUFFER_ALIGNMENT = 16;
+
 namespace SceneGraph {
 
 StaticGeometry::StaticGeometry(Graphics::Renderer *r)
@@ -75,27 +78,22 @@ void StaticGeometry::Save(NodeDatabase &db)
 			attribCombo |= vbDesc.attrib[i].semantic;
 		db.wr->Int32(attribCombo);
 
-		//save positions, normals and uvs interleaved (only known format now)
-		const Uint32 posOffset = vbDesc.GetOffset(Graphics::ATTRIB_POSITION);
-		const Uint32 nrmOffset = vbDesc.GetOffset(Graphics::ATTRIB_NORMAL);
-		const Uint32 uv0Offset = vbDesc.GetOffset(Graphics::ATTRIB_UV0);
-		const Uint32 stride    = vbDesc.stride;
+		//save the buffer contents as they are, with the layout, so
+		//loading hands them straight to the renderer
 		db.wr->Int32(vbDesc.numVertices);
-		Uint8 *vtxPtr = mesh.vertexBuffer->Map<Uint8>(Graphics::BUFFER_MAP_READ);
-		for (Uint32 i = 0; i < vbDesc.numVertices; i++) {
-            db.wr->Vector3f(*reinterpret_cast<vector3f*>(vtxPtr + i * stride + posOffset));
-            db.wr->Vector3f(*reinterpret_cast<vector3f*>(vtxPtr + i * stride + nrmOffset));
-            db.wr->Float(reinterpret_cast<vector2f*>(vtxPtr + i * stride + uv0Offset)->x);
-            db.wr->Float(reinterpret_cast<vector2f*>(vtxPtr + i * stride + uv0Offset)->y);
-		}
+		db.wr->Int32(vbDesc.stride);
+		db.wr->Int32(vbDesc.GetOffset(Graphics::ATTRIB_POSITION));
+		db.wr->Int32(vbDesc.GetOffset(Graphics::ATTRIB_NORMAL));
+		db.wr->Int32(vbDesc.GetOffset(Graphics::ATTRIB_UV0));
+		const Uint8 *vtxPtr = mesh.vertexBuffer->Map<Uint8>(Graphics::BUFFER_MAP_READ);
+		db.wr->AlignedBlob(vtxPtr, vbDesc.numVertices * vbDesc.stride, BUFFER_ALIGNMENT);
 		mesh.vertexBuffer->Unmap();
 
 		//indices
 		const Uint16 *indexPtr = mesh.indexBuffer->Map(Graphics::BUFFER_MAP_READ);
 		const Uint32 numIndices = mesh.indexBuffer->GetSize();
 		db.wr->Int32(numIndices);
-		for (Uint32 i = 0; i < numIndices; i++)
-			db.wr->Int16(indexPtr[i]);
+		db.wr->AlignedBlob(indexPtr, numIndices * sizeof(Uint16), BUFFER_ALIGNMENT);
 		mesh.indexBuffer->Unmap();
     }
 }
@@ -143,6 +141,32 @@ StaticGeometry *StaticGeometry::Load(NodeDatabase &db)
 		vbDesc.usage = Graphics::BUFFER_USAGE_STATIC;
 		vbDesc.numVertices = db.rd->Int32();
 
+		//version 4 on: the buffer contents as saved, no copy or conversion
+		if (rd.StreamVersion() >= 4) {
+			vbDesc.stride = rd.Int32();
+			vbDesc.attrib[0].offset = rd.Int32();
+			vbDesc.attrib[1].offset = rd.Int32();
+			vbDesc.attrib[2].offset = rd.Int32();
+			for (Uint32 i = 0; i < 3; i++) {
+				if (vbDesc.attrib[i].offset + VertexBufferDesc::GetAttribSize(vbDesc.attrib[i].format) > vbDesc.stride)
+					throw LoadingError("Bad vertex layout");
+			}
+			const ByteRange vtxData = rd.AlignedBlob(BUFFER_ALIGNMENT);
+			if (vbDesc.numVertices == 0 || vtxData.Size() != vbDesc.numVertices * vbDesc.stride)
+				throw LoadingError("Vertex data size mismatch");
+
+			const Uint32 numIndices = rd.Int32();
+			const ByteRange idxData = rd.AlignedBlob(BUFFER_ALIGNMENT);
+			if (numIndices == 0 || idxData.Size() != numIndices * sizeof(Uint16))
+				throw LoadingError("Index data size mismatch");
+
+			RefCountedPtr<Graphics::VertexBuffer> vtxBuffer(db.loader->GetRenderer()->CreateVertexBuffer(vbDesc, vtxData.begin));
+			RefCountedPtr<Graphics::IndexBuffer> idxBuffer(db.loader->GetRenderer()->CreateIndexBuffer(numIndices, Graphics::BUFFER_USAGE_STATIC,
+				reinterpret_cast<const Uint16*>(idxData.begin)));
+			sg->AddMesh(vtxBuffer, idxBuffer, material);
+			continue;
+		}
+
 		RefCountedPtr<Graphics::VertexBuffer> vtxBuffer(db.loader->GetRenderer()->CreateVertexBuffer(vbDesc));
 		const Uint32 posOffset = vtxBuffer->GetDesc().GetOffset(Graphics::ATTRIB_POSITION);
 		const Uint32 nrmOffset = vtxBuffer->GetDesc().GetOffset(Graphics::ATTRIB_NORMAL);
@@ -0,0 +1,165 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "TextMesh.h"
+
+namespace Text {
+
+#pragma pack(push, 4)
+struct TextVertex {
+	vector3f pos;
+	Color4ub col;
+	vector2f uv;
+};
+#pragma pack(pop)
+
+static const Graphics::AttributeSet TEXT_ATTRIBS = Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE | Graphics::ATTRIB_UV0;
+
+TextMesh::TextMesh() :
+	m_color(Color::WHITE),
+	m_vertices(TEXT_ATTRIBS),
+	m_geometryValid(false),
+	m_bufferValid(false),
+	m_rebuilt(false)
+{
+}
+
+TextMesh::TextMesh(const RefCountedPtr<TextureFont> &font) :
+	m_font(font),
+	m_color(Color::WHITE),
+	m_vertices(TEXT_ATTRIBS),
+	m_geometryValid(false),
+	m_bufferValid(false),
+	m_rebuilt(false)
+{
+}
+
+void TextMesh::SetFont(const RefCountedPtr<TextureFont> &font)
+{
+	if (font == m_font) return;
+	m_font = font;
+	// the buffer came from the old font's renderer
+	m_buffer.Reset();
+	m_geometryValid = false;
+	m_bufferValid = false;
+}
+
+void TextMesh::SetText(const std::string &text)
+{
+	if (text == m_text) return;
+	m_text = text;
+	m_geometryValid = false;
+	m_bufferValid = false;
+}
+
+void TextMesh::SetColor(const Color &color)
+{
+	if (color == m_color) return;
+	m_color = color;
+	m_geometryValid = false;
+	m_bufferValid = false;
+}
+
+const Graphics::VertexArray &TextMesh::GetGeometry()
+{
+	if (!m_geometryValid) {
+		assert(m_font);
+		m_rebuilt = m_rebuilt || m_vertices.GetNumVerts() > 0;
+		m_vertices.Clear();
+		m_font->CreateGeometry(m_vertices, m_text.c_str(), 0.0f, 0.0f, m_color);
+		m_geometryValid = true;
+	}
+	return m_vertices;
+}
+
+void TextMesh::UpdateBuffer()
+{
+	const Graphics::VertexArray &va = GetGeometry();
+	const Uint32 numVertices = va.GetNumVerts();
+
+	// text without glyphs, like a lone newline. Buffers can't be empty,
+	// so keep any old one but draw nothing from it
+	if (numVertices == 0) {
+		if (m_buffer)
+			m_buffer->SetVertexCount(0);
+		m_bufferValid = true;
+		return;
+	}
+
+	if (!m_buffer || m_buffer->GetDesc().numVertices < numVertices) {
+		// text that keeps changing, like a speed readout, gets a dynamic
+		// buffer with some room to grow
+		const Graphics::BufferUsage usage = m_rebuilt ? Graphics::BUFFER_USAGE_DYNAMIC : Graphics::BUFFER_USAGE_STATIC;
+		const Uint32 size = m_rebuilt ? numVertices + numVertices / 2 : numVertices;
+		m_buffer.Reset(m_font->CreateVertexBuffer(size, usage));
+	}
+
+	TextVertex *vtx = m_buffer->Map<TextVertex>(Graphics::BUFFER_MAP_WRITE);
+	for (Uint32 i = 0; i < numVertices; i++) {
+		vtx[i].pos = va.position[i];
+		vtx[i].col = va.diffuse[i];
+		vtx[i].uv = va.uv0[i];
+	}
+	m_buffer->Unmap();
+	m_buffer->SetVertexCount(numVertices);
+
+	m_bufferValid = true;
+}
+
+void TextMesh::Draw()
+{
+	if (m_text.empty()) return;
+	if (!m_bufferValid)
+		UpdateBuffer();
+	if (!m_buffer || m_buffer->GetVertexCount() == 0) return;
+	m_font->RenderBuffer(m_buffer.Get());
+}
+
+TextBatch::TextBatch(const RefCountedPtr<TextureFont> &font) :
+	m_font(font),
+	m_vertices(TEXT_ATTRIBS),
+	m_frame(0)
+{
+}
+
+void TextBatch::Clear()
+{
+	m_vertices.Clear();
+}
+
+void TextBatch::Add(const std::string &text, float x, float y, const Color &color)
+{
+	std::map<std::string, CachedMesh>::iterator it = m_meshes.find(text);
+	if (it == m_meshes.end()) {
+		it = m_meshes.insert(std::make_pair(text, CachedMesh(m_font))).first;
+		it->second.mesh.SetText(text);
+	}
+	it->second.mesh.SetColor(color);
+	it->second.lastUsed = m_frame;
+	Add(it->second.mesh, x, y);
+}
+
+void TextBatch::Add(TextMesh &mesh, float x, float y)
+{
+	assert(mesh.GetFont() == m_font.Get());
+	const Graphics::VertexArray &va = mesh.GetGeometry();
+	const vector3f offset(x, y, 0.0f);
+	for (Uint32 i = 0; i < va.GetNumVerts(); i++)
+		m_vertices.Add(va.position[i] + offset, va.diffuse[i], va.uv0[i]);
+}
+
+void TextBatch::Draw()
+{
+	PROFILE_SCOPED()
+	m_font->RenderGeometry(m_vertices);
+
+	for (std::map<std::string, CachedMesh>::iterator it = m_meshes.begin(); it != m_meshes.end();) {
+		if (it->second.lastUsed != m_frame)
+			m_meshes.erase(it++);
+		else
+			++it;
+	}
+	m_frame++;
+}
+
+}
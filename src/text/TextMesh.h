@@ -0,0 +1,93 @@
+// Copyright © 2008-2014 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _TEXT_TEXTMESH_H
+#define _TEXT_TEXTMESH_H
+
+#include "libs.h"
+#include "RefCounted.h"
+#include "TextureFont.h"
+#include "graphics/VertexArray.h"
+#include "graphics/VertexBuffer.h"
+#include <map>
+#include <string>
+
+namespace Text {
+
+// A string laid out once and kept for drawing. TextureFont::RenderString
+// looks up every glyph and builds new geometry on each call; a TextMesh only
+// does that again when its font, text or colour actually changes, and draws
+// from a vertex buffer in between. Positions are in font units with the
+// origin at the top left, as for RenderString.
+class TextMesh {
+public:
+	TextMesh();
+	explicit TextMesh(const RefCountedPtr<TextureFont> &font);
+
+	// setting the current value again keeps the mesh
+	void SetFont(const RefCountedPtr<TextureFont> &font);
+	void SetText(const std::string &text);
+	void SetColor(const Color &color);
+
+	TextureFont *GetFont() const { return m_font.Get(); }
+	const std::string &GetText() const { return m_text; }
+	const Color &GetColor() const { return m_color; }
+
+	// the laid out glyphs, built if needed
+	const Graphics::VertexArray &GetGeometry();
+
+	// at the current transform
+	void Draw();
+
+private:
+	void UpdateBuffer();
+
+	RefCountedPtr<TextureFont> m_font;
+	std::string m_text;
+	Color m_color;
+
+	Graphics::VertexArray m_vertices;
+	bool m_geometryValid;
+
+	RefCountedPtr<Graphics::VertexBuffer> m_buffer;
+	bool m_bufferValid;
+	bool m_rebuilt; // changed after its first build, so the buffer is made dynamic
+};
+
+// Draws many labels in one font with a single draw call. Labels are added
+// each frame with their position; the layout of each string is kept in a
+// TextMesh between frames, so only the copy into the batch is redone. Meshes
+// for strings not added since the previous Draw are dropped.
+class TextBatch {
+public:
+	explicit TextBatch(const RefCountedPtr<TextureFont> &font);
+
+	TextureFont *GetFont() const { return m_font.Get(); }
+
+	// forget the labels added so far, the kept layouts stay
+	void Clear();
+	void Add(const std::string &text, float x, float y, const Color &color = Color::WHITE);
+	// the mesh must use the batch's font
+	void Add(TextMesh &mesh, float x, float y);
+
+	bool IsEmpty() const { return m_vertices.GetNumVerts() == 0; }
+
+	// everything added since Clear, at the current transform
+	void Draw();
+
+private:
+	RefCountedPtr<TextureFont> m_font;
+	Graphics::VertexArray m_vertices;
+
+	struct CachedMesh {
+		CachedMesh(const RefCountedPtr<TextureFont> &font) : mesh(font), lastUsed(0) {}
+		TextMesh mesh;
+		Uint32 lastUsed;
+	};
+	std::map<std::string, CachedMesh> m_meshes;
+	Uint32 m_frame;
+};
+
+}
+
+#endif
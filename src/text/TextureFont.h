@@ -17,6 +17,7 @@
 #include FT_STROKER_H
 
 namespace FileSystem { class FileData; }
+namespace Graphics { class VertexBuffer; }
 
 namespace Text {
 
@@ -52,8 +53,14 @@ public:
 	static int GetGlyphCount() { return s_glyphCount; }
 	static void ClearGlyphCount() { s_glyphCount = 0; }
 
-	// fill a vertex array with single-colored text
+	// fill a vertex array with single-colored text, laid out as RenderString does.
+	// the array needs position, diffuse and uv0
 	void CreateGeometry(Graphics::VertexArray &, const char *str, float x, float y, const Color &color = Color::WHITE);
+	// draw geometry from CreateGeometry with the font texture and state
+	void RenderGeometry(const Graphics::VertexArray &);
+	// a buffer for text geometry (position, diffuse, uv0), see TextMesh
+	Graphics::VertexBuffer *CreateVertexBuffer(Uint32 numVertices, Graphics::BufferUsage usage);
+	void RenderBuffer(Graphics::VertexBuffer *);
 	RefCountedPtr<Graphics::Texture> GetTexture() { return m_texture; }
 
 private:
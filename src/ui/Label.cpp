@@ -32,7 +32,11 @@ void Label::Layout()
 void Label::Draw()
 {
 	static const Color disabledColor(204, 204, 204, 255);
-	GetContext()->GetFont(GetFont())->RenderString(m_text.c_str(), 0.0f, 0.0f, IsDisabled() ? disabledColor : m_color);
+	// laid out again only when one of these changes
+	m_mesh.SetFont(GetContext()->GetFont(GetFont()));
+	m_mesh.SetText(m_text);
+	m_mesh.SetColor(IsDisabled() ? disabledColor : m_color);
+	m_mesh.Draw();
 }
 
 Label *Label::SetText(const std::string &text)
@@ -6,6 +6,7 @@
 
 #include "Widget.h"
 #include "SmartPtr.h"
+#include "text/TextMesh.h"
 
 // single line of text
 
@@ -32,6 +33,7 @@ private:
 	std::string m_text;
 	Color m_color;
 	Point m_preferredSize;
+	Text::TextMesh m_mesh;
 };
 
 }
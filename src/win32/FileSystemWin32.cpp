@@ -79,7 +79,7 @@ namespace FileSystem {
 	}
 
 	FileSourceFS::FileSourceFS(const std::string &root, bool trusted):
-		FileSource((root == "/") ? "" : absolute_path(root), trusted) {}
+		FileSource((root == "/") ? "" : absolute_path(root), trusted), m_mapThreshold(0) {}
 
 	FileSourceFS::~FileSourceFS() {}
 
@@ -241,4 +241,11 @@ namespace FileSystem {
 		const std::string fullpath = JoinPathBelow(GetRoot(), path);
 		return open_file_raw(fullpath, (flags & WRITE_TEXT) ? L"w" : L"wb");
 	}
+
+	bool FileSourceFS::RenameFile(const std::string &from, const std::string &to)
+	{
+		const std::wstring wfullfrom = transcode_utf8_to_utf16(JoinPathBelow(GetRoot(), from));
+		const std::wstring wfullto = transcode_utf8_to_utf16(JoinPathBelow(GetRoot(), to));
+		return MoveFileExW(wfullfrom.c_str(), wfullto.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+	}
 }